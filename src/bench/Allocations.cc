@@ -0,0 +1,51 @@
+#include "Allocations.hh"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace screenspace {
+namespace bench {
+
+static std::atomic<std::size_t> s_allocations(0);
+
+std::size_t allocationCount()
+{
+  return s_allocations.load(std::memory_order_relaxed);
+}
+
+}
+}
+
+void* operator new(std::size_t size)
+{
+  screenspace::bench::s_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+  return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
@@ -0,0 +1,31 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_BENCH_ALLOCATIONS_HH
+#define SCREENSPACE_BENCH_ALLOCATIONS_HH
+
+#include <cstddef>
+
+namespace screenspace {
+namespace bench {
+
+/// Number of heap allocations made so far by this process. Counted by
+/// replacing the global operator new, so only linked into tools.
+/// \return The allocation count.
+std::size_t allocationCount();
+
+}
+}
+
+#endif // SCREENSPACE_BENCH_ALLOCATIONS_HH
@@ -0,0 +1,309 @@
+// Replays a synthetic scene through the plugin's prepare stages with
+// stand-ins for the Maya viewport objects, reporting time and heap
+// allocations per frame.
+//
+//   screenspaceHarness [--pickables N] [--cameras M] [--frames K]
+//                      [--edit-rate R] [--static-cameras] [--per-frame]
+//                      [--stats] [--trace FILE] [--check-allocations]
+//                      [--circle-tolerance PX] [--parametric]
+
+#include "Allocations.hh"
+#include "Scene.hh"
+#include "StandIns.hh"
+
+#include "ss/core/Prepare.hh"
+#include "ss/core/Stats.hh"
+#include "ss/core/Trace.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace screenspace;
+using namespace screenspace::bench;
+
+namespace {
+
+/// Command line options.
+struct Options {
+  std::size_t pickables = 1000;  // Pickables in the scene
+  std::size_t cameras = 4;       // Cameras, one viewport each
+  std::size_t frames = 240;      // Frames to replay
+  float editRate = 0.01f;        // Fraction of pickables edited per frame
+  bool moveCameras = true;       // Orbit cameras every frame
+  bool perFrame = false;         // Print every frame, not just the summary
+  bool stats = false;            // Collect and print stage statistics
+  const char* trace = nullptr;   // Chrome trace file to write
+  bool checkAllocations = false; // Fail if a frame after the first allocates
+  float circleTolerance = 0.25f; // Largest circle outline error in pixels
+  bool parametric = false;       // Mix parametric shapes into the scene
+};
+
+/// Stand-in for PickableUserData, kept between draws.
+struct UserData {
+  explicit UserData(const GeometryTable& geometry)
+      : data(geometry.unitGeometry(Shape::Circle, kDefaultCircleLod)),
+        vertices(),
+        attached(false)
+  {
+    // Culled pickables skip their vertices, so size for the largest
+    // shape up front rather than when they first come into view.
+    vertices.reserve(geometry.maxPoints() * 3);
+  }
+
+  PickableData data;
+  std::vector<float> vertices;  // Geometry in pickable space
+  bool attached;
+};
+
+/// Like PickableDrawOverride::prepareForDraw, reusing oldData when
+/// given. The stages are the plugin's own, run through NodeSource.
+UserData* prepareForDraw(const PickableNode& node,
+                         const FrameContext& frameContext,
+                         GeometryTable& geometry,
+                         float circleTolerance,
+                         UserData* oldData)
+{
+  ScopedTrace trace;
+  if (Tracer::enabled())
+    trace.begin("prepareForDraw", nullptr, frameContext.camera + 1);
+
+  UserData* data = oldData;
+  if (!data)
+    data = new UserData(geometry);
+  {
+    ScopedTimer timer(Stage::Attach);
+    data->attached = node.camera() == frameContext.camera;
+  }
+  if (!data->attached)
+  {
+    countPickable(frameContext.camera, Outcome::Detached);
+    return data;
+  }
+
+  NodeSource source(node, frameContext, geometry, circleTolerance);
+  const PrepareResult result = prepareStages(source, data->data, &data->vertices);
+  if (result.culled)
+    countPickable(frameContext.camera, Outcome::Culled);
+  else
+    countPickable(frameContext.camera, result.style || result.matrix ? Outcome::Drawn : Outcome::CacheHit);
+  return data;
+}
+
+/// Like PickableDrawOverride::addUIDrawables.
+void addUIDrawables(const UserData& data, RecordingDrawManager& drawManager)
+{
+  if (!data.attached || !data.data.visible())
+    return;
+
+  ScopedTrace trace("addUIDrawables");
+
+  ScopedTimer timer(Stage::Draw);
+  const Geometry& geometry = data.data.geometry();
+  drawManager.beginDrawable();
+  drawManager.setColor(data.data.m_attributes.color);
+  drawManager.mesh(data.vertices, geometry.indices.data(), geometry.indices.size());
+  drawManager.endDrawable();
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--pickables") == 0 && hasValue)
+      options.pickables = std::strtoul(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--cameras") == 0 && hasValue)
+      options.cameras = std::strtoul(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+      options.frames = std::strtoul(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--edit-rate") == 0 && hasValue)
+      options.editRate = float(std::atof(argv[++i]));
+    else if (std::strcmp(argv[i], "--static-cameras") == 0)
+      options.moveCameras = false;
+    else if (std::strcmp(argv[i], "--per-frame") == 0)
+      options.perFrame = true;
+    else if (std::strcmp(argv[i], "--stats") == 0)
+      options.stats = true;
+    else if (std::strcmp(argv[i], "--trace") == 0 && hasValue)
+      options.trace = argv[++i];
+    else if (std::strcmp(argv[i], "--check-allocations") == 0)
+      options.checkAllocations = true;
+    else if (std::strcmp(argv[i], "--parametric") == 0)
+      options.parametric = true;
+    else if (std::strcmp(argv[i], "--circle-tolerance") == 0 && hasValue)
+      options.circleTolerance = std::max(0.01f, float(std::atof(argv[++i])));
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--pickables N] [--cameras M] [--frames K] "
+                   "[--edit-rate R] [--static-cameras] [--per-frame] [--stats] "
+                   "[--trace FILE] [--check-allocations] [--circle-tolerance PX] [--parametric]\n", argv[0]);
+      return false;
+    }
+  }
+  return options.cameras > 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+    return 1;
+
+  // Scene
+  std::vector<PickableNode> nodes;
+  const std::vector<LayoutAttributes> attributes = makeAttributes(options.pickables, 1);
+  const std::size_t numShapes = options.parametric ? 7 : 3;
+  for (std::size_t i = 0; i < options.pickables; ++i)
+    nodes.push_back(PickableNode(attributes[i], static_cast<Shape>(i % numShapes), i % options.cameras));
+
+  std::vector<CameraBasis> cameras(options.cameras);
+  std::vector<std::unique_ptr<UserData>> userData(options.pickables);
+  GeometryTable geometry;
+  RecordingDrawManager drawManager;
+  std::mt19937 generator(2);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+  Stats::instance().setEnabled(options.stats);
+  Tracer::instance().setEnabled(options.trace != nullptr);
+
+  using Clock = std::chrono::steady_clock;
+  double totalMs = 0.0;
+  std::size_t totalAllocations = 0;
+  std::size_t allocatingFrames = 0;
+  std::size_t tessellatingFrames = 0;
+  std::size_t plugReadsBefore = 0;
+  for (std::size_t frame = 0; frame < options.frames; ++frame)
+  {
+    // Scene changes happen outside the draw
+    for (PickableNode& node : nodes)
+    {
+      if (unit(generator) < options.editRate)
+        node.editLayout(unit(generator) * 100.0f - 50.0f);
+    }
+    for (std::size_t c = 0; c < options.cameras; ++c)
+    {
+      const std::size_t step = options.moveCameras ? frame : 0;
+      const float angle = 0.01f * float(step) + float(c);
+      cameras[c] = makeCamera(1920, 1080, Vec3{std::sin(angle), std::cos(angle), 10.0f});
+    }
+
+    const std::size_t allocationsBefore = allocationCount();
+    const std::size_t tessellationsBefore = geometry.tessellations();
+    const Clock::time_point start = Clock::now();
+    drawManager.clear();
+    for (std::size_t c = 0; c < options.cameras; ++c)
+    {
+      ScopedTrace cameraTrace("viewport");
+      const std::size_t step = options.moveCameras ? frame : 0;
+      const FrameContext frameContext = {c, std::hash<std::size_t>()(step * options.cameras + c), &cameras[c]};
+      for (std::size_t i = 0; i < nodes.size(); ++i)
+      {
+        UserData* data = prepareForDraw(nodes[i], frameContext, geometry,
+                                        options.circleTolerance, userData[i].get());
+        if (data != userData[i].get())
+          userData[i].reset(data);
+        addUIDrawables(*data, drawManager);
+      }
+    }
+    const double frameMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    const std::size_t allocations = allocationCount() - allocationsBefore;
+    const bool tessellated = geometry.tessellations() != tessellationsBefore;
+
+    std::size_t plugReads = 0;
+    for (const PickableNode& node : nodes)
+      plugReads += node.plugReads();
+
+    // The first frame creates every user data and is reported but
+    // kept out of the steady state totals. Edits that size a parametric
+    // shape to a new key tessellate it, which allocates, so those
+    // frames are counted but not checked.
+    if (frame > 0)
+    {
+      totalMs += frameMs;
+      totalAllocations += allocations;
+      if (tessellated)
+        ++tessellatingFrames;
+      else if (allocations > 0)
+      {
+        ++allocatingFrames;
+        if (options.checkAllocations)
+          std::fprintf(stderr, "frame %zu allocated %zu times\n", frame, allocations);
+      }
+    }
+    if (options.perFrame)
+    {
+      std::printf("{\"frame\": %zu, \"ms\": %.4f, \"allocations\": %zu, \"drawables\": %zu, "
+                  "\"vertices\": %zu, \"plug_reads\": %zu, \"tessellated\": %s}\n",
+                  frame, frameMs, allocations, drawManager.drawables(),
+                  drawManager.vertices(), plugReads - plugReadsBefore,
+                  tessellated ? "true" : "false");
+    }
+    plugReadsBefore = plugReads;
+  }
+
+  const double steadyFrames = options.frames > 1 ? double(options.frames - 1) : 1.0;
+  std::printf("{\"summary\": true, \"pickables\": %zu, \"cameras\": %zu, \"frames\": %zu, "
+              "\"edit_rate\": %.4f, \"moving_cameras\": %s, \"ms_per_frame\": %.4f, "
+              "\"ns_per_pickable\": %.3f, \"allocations_per_frame\": %.3f, "
+              "\"tessellating_frames\": %zu}\n",
+              options.pickables, options.cameras, options.frames, options.editRate,
+              options.moveCameras ? "true" : "false",
+              totalMs / steadyFrames,
+              totalMs * 1.0e6 / (steadyFrames * double(options.pickables) * double(options.cameras)),
+              double(totalAllocations) / steadyFrames, tessellatingFrames);
+
+  if (options.trace)
+  {
+    std::ofstream stream(options.trace);
+    Tracer::instance().setEnabled(false);
+    Tracer::instance().write(stream, [](std::uint64_t key) {
+      return "camera" + std::to_string(key - 1);
+    });
+  }
+
+  if (options.stats)
+  {
+    const StatsSnapshot snapshot = Stats::instance().snapshot();
+    for (std::size_t i = 0; i < kNumStages; ++i)
+    {
+      const Histogram& histogram = snapshot.stages[i];
+      if (histogram.count == 0)
+        continue;
+      std::printf("{\"stage\": \"%s\", \"count\": %llu, \"mean_ns\": %.1f, "
+                  "\"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu}\n",
+                  stageName(Stage(i)), (unsigned long long) histogram.count,
+                  double(histogram.totalNs) / double(histogram.count),
+                  (unsigned long long) histogram.percentileNs(0.5),
+                  (unsigned long long) histogram.percentileNs(0.99),
+                  (unsigned long long) histogram.maxNs);
+    }
+    for (const CameraCounters& counters : snapshot.cameras)
+    {
+      std::printf("{\"camera\": %llu, \"drawn\": %llu, \"culled\": %llu, \"cache_hits\": %llu, "
+                  "\"detached\": %llu}\n",
+                  (unsigned long long) counters.camera, (unsigned long long) counters.drawn,
+                  (unsigned long long) counters.culled, (unsigned long long) counters.cacheHits,
+                  (unsigned long long) counters.detached);
+    }
+  }
+  if (options.checkAllocations && allocatingFrames > 0)
+  {
+    std::fprintf(stderr, "%zu of %zu steady state frames allocated\n",
+                 allocatingFrames, options.frames - 1 - tessellatingFrames);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,233 @@
+// Microbenchmarks for the per-pickable layout and geometry hot paths.
+// Prints one JSON object per line so results can be diffed between
+// releases.
+//
+//   screenspaceBench [--min-time-ms N] [--filter NAME]
+
+#include "Allocations.hh"
+#include "Scene.hh"
+
+#include "ss/core/Layout.hh"
+#include "ss/core/ScreenIndex.hh"
+#include "ss/core/Shapes.hh"
+#include "ss/core/Transform.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace screenspace;
+using namespace screenspace::bench;
+
+namespace {
+
+/// Pickable counts every benchmark runs with.
+const std::size_t kCounts[] = {1, 100, 10000, 100000};
+
+/// Command line options.
+struct Options {
+  double minTimeMs = 100.0;  // Minimum time per benchmark
+  std::string filter;        // Only run benchmarks containing this
+};
+
+/// Keeps results observable so the compiler can't drop the work.
+volatile float g_sink = 0.0f;
+
+/// Time a benchmark body until it has run for the minimum time, then
+/// print a result line.
+/// \param options Command line options.
+/// \param name Benchmark name.
+/// \param count Number of pickables processed per call of body.
+/// \param body The work.
+void run(const Options& options, const std::string& name, std::size_t count,
+         const std::function<void()>& body)
+{
+  if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+    return;
+
+  // Warm up caches and any lazy statics
+  body();
+
+  using Clock = std::chrono::steady_clock;
+  std::size_t iterations = 0;
+  const std::size_t allocationsBefore = allocationCount();
+  const Clock::time_point start = Clock::now();
+  double elapsedMs = 0.0;
+  do
+  {
+    body();
+    ++iterations;
+    elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  } while (elapsedMs < options.minTimeMs);
+  const std::size_t allocations = allocationCount() - allocationsBefore;
+
+  const double pickables = double(iterations) * double(count);
+  std::printf("{\"name\": \"%s\", \"pickables\": %zu, \"iterations\": %zu, "
+              "\"ns_per_pickable\": %.3f, \"allocs_per_pickable\": %.3f, "
+              "\"transform_path\": \"%s\"}\n",
+              name.c_str(), count, iterations,
+              elapsedMs * 1.0e6 / pickables,
+              double(allocations) / pickables,
+              transformPath() == TransformPath::AVX ? "avx" :
+              transformPath() == TransformPath::SSE ? "sse" : "scalar");
+  std::fflush(stdout);
+}
+
+/// Unit shape as separate x and y arrays.
+struct UnitPoints {
+  std::vector<float> x;
+  std::vector<float> y;
+};
+
+UnitPoints unitPoints(Shape shape)
+{
+  const UnitShape& unit = unitShape(shape);
+  UnitPoints points;
+  for (std::size_t i = 0; i < unit.numPoints; ++i)
+  {
+    points.x.push_back(unit.points[i][0]);
+    points.y.push_back(unit.points[i][1]);
+  }
+  return points;
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc)
+    {
+      options.minTimeMs = std::atof(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+    {
+      options.filter = argv[++i];
+    }
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--min-time-ms N] [--filter NAME]\n", argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+    return 1;
+
+  const CameraBasis camera = makeCamera(1920, 1080, Vec3{0.0f, 0.0f, 10.0f});
+  const struct {
+    Shape shape;
+    const char* name;
+  } shapes[] = {
+    {Shape::Circle, "circle"},
+    {Shape::Rectangle, "rectangle"},
+    {Shape::Triangle, "triangle"},
+  };
+  const struct {
+    TransformPath path;
+    const char* name;
+  } paths[] = {
+    {TransformPath::Scalar, "scalar"},
+    {TransformPath::SSE, "sse"},
+    {TransformPath::AVX, "avx"},
+  };
+
+  for (std::size_t count : kCounts)
+  {
+    const std::vector<LayoutAttributes> attributes = makeAttributes(count, 1);
+
+    // Placements are inputs to the geometry benchmarks
+    std::vector<Placement> placements(count);
+    Viewport viewport;
+    for (std::size_t i = 0; i < count; ++i)
+      placements[i] = solvePlacement(camera, attributes[i], viewport);
+
+    run(options, "unproject", count, [&]() {
+      float sum = 0.0f;
+      for (const LayoutAttributes& pickable : attributes)
+        sum += viewportToWorld(camera, int(pickable.offsetX), int(pickable.offsetY), pickable.depth).x;
+      g_sink = sum;
+    });
+
+    run(options, "placement", count, [&]() {
+      Viewport viewport;
+      float sum = 0.0f;
+      for (const LayoutAttributes& pickable : attributes)
+        sum += solvePlacement(camera, pickable, viewport).origin[0];
+      g_sink = sum;
+    });
+
+    run(options, "matrix", count, [&]() {
+      float sum = 0.0f;
+      for (const Placement& placement : placements)
+        sum += placementMatrix(placement).m[3][0];
+      g_sink = sum;
+    });
+
+    for (const auto& shape : shapes)
+    {
+      const UnitPoints points = unitPoints(shape.shape);
+      std::vector<float> positions(count * points.x.size() * 3);
+      run(options, std::string("geometry/") + shape.name, count, [&]() {
+        for (std::size_t i = 0; i < count; ++i)
+          transformPoints(placements[i], points.x.data(), points.y.data(),
+                          points.x.size(), &positions[i * points.x.size() * 3]);
+        g_sink = positions[0];
+      });
+    }
+
+    const UnitPoints circle = unitPoints(Shape::Circle);
+    std::vector<float> positions(count * circle.x.size() * 3);
+    for (const auto& path : paths)
+    {
+      run(options, std::string("transform/") + path.name, count, [&]() {
+        for (std::size_t i = 0; i < count; ++i)
+          transformPoints(path.path, placements[i], circle.x.data(), circle.y.data(),
+                          circle.x.size(), &positions[i * circle.x.size() * 3]);
+        g_sink = positions[0];
+      });
+    }
+
+    // Hit testing, one click per pickable so the figure is per click
+    std::vector<ScreenEntry> entries(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      entries[i].id = i;
+      entries[i].placement = screenPlacement(attributes[i], camera.width, camera.height);
+      entries[i].shape = shapes[i % 3].shape;
+      entries[i].parameters = ShapeParameters{0.25f, 0.5f, 360.0f, 6};
+      entries[i].outline = 0;
+      entries[i].depth = attributes[i].depth;
+    }
+    ScreenIndex index;
+    run(options, "pick/build", count, [&]() {
+      index.reset(camera.width, camera.height);
+      for (const ScreenEntry& entry : entries)
+        index.add(entry);
+      index.build();
+      g_sink = float(index.size());
+    });
+
+    std::vector<std::uint64_t> hits;
+    run(options, "pick/click", count, [&]() {
+      std::size_t found = 0;
+      for (const ScreenEntry& entry : entries)
+      {
+        index.findAt(entry.placement.center[0], entry.placement.center[1], hits);
+        found += hits.size();
+      }
+      g_sink = float(found);
+    });
+  }
+  return 0;
+}
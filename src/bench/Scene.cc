@@ -0,0 +1,66 @@
+#include "Scene.hh"
+
+#include <cmath>
+#include <random>
+
+namespace screenspace {
+namespace bench {
+
+/// Horizontal field of view of a 35mm lens on Maya's default film back.
+static const float kHorizontalFov = 0.9500215f;
+static const float kNearClipPlane = 0.1f;
+static const float kFarClipPlane = 10000.0f;
+
+CameraBasis makeCamera(int width, int height, const Vec3& eye)
+{
+  CameraBasis camera;
+  setViewportSize(camera, width, height);
+  camera.nearClipPlane = kNearClipPlane;
+  camera.eye = eye;
+  camera.right = Vec3{1.0f, 0.0f, 0.0f};
+  camera.up = Vec3{0.0f, 1.0f, 0.0f};
+  camera.back = Vec3{0.0f, 0.0f, 1.0f};
+  camera.normal = camera.back;
+
+  // Half extents of each clip plane
+  const float aspect = float(height) / float(width);
+  const float nearHalfWidth = kNearClipPlane * std::tan(kHorizontalFov / 2.0f);
+  const float farHalfWidth = kFarClipPlane * std::tan(kHorizontalFov / 2.0f);
+
+  camera.nearOrigin = eye + Vec3{-nearHalfWidth, -nearHalfWidth * aspect, -kNearClipPlane};
+  camera.nearX = Vec3{2.0f * nearHalfWidth / width, 0.0f, 0.0f};
+  camera.nearY = Vec3{0.0f, 2.0f * nearHalfWidth * aspect / height, 0.0f};
+  camera.farOrigin = eye + Vec3{-farHalfWidth, -farHalfWidth * aspect, -kFarClipPlane};
+  camera.farX = Vec3{2.0f * farHalfWidth / width, 0.0f, 0.0f};
+  camera.farY = Vec3{0.0f, 2.0f * farHalfWidth * aspect / height, 0.0f};
+  return camera;
+}
+
+std::vector<LayoutAttributes> makeAttributes(std::size_t count, unsigned int seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> offset(0.0f, 100.0f);
+  std::uniform_real_distribution<float> extent(1.0f, 10.0f);
+  std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+  std::uniform_int_distribution<int> depth(0, 10);
+  std::uniform_int_distribution<int> choice(0, 2);
+
+  std::vector<LayoutAttributes> attributes(count);
+  for (LayoutAttributes& pickable : attributes)
+  {
+    pickable.size = 1.0f;
+    pickable.width = extent(generator);
+    pickable.height = extent(generator);
+    pickable.depth = depth(generator);
+    pickable.position = Position::Relative;
+    pickable.horizontalAlign = static_cast<HorizontalAlign>(choice(generator));
+    pickable.verticalAlign = static_cast<VerticalAlign>(choice(generator));
+    pickable.rotate = angle(generator);
+    pickable.offsetX = offset(generator) - 50.0f;
+    pickable.offsetY = offset(generator) - 50.0f;
+  }
+  return attributes;
+}
+
+}
+}
@@ -0,0 +1,44 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_BENCH_SCENE_HH
+#define SCREENSPACE_BENCH_SCENE_HH
+
+#include "ss/core/Camera.hh"
+#include "ss/core/Layout.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace screenspace {
+namespace bench {
+
+/// Perspective camera looking down -z, like Maya's default persp.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \param eye Camera position.
+/// \return The camera.
+CameraBasis makeCamera(int width, int height, const Vec3& eye);
+
+/// Pickable attributes spread over the viewport, repeatable for a
+/// given seed.
+/// \param count Number of pickables.
+/// \param seed Random seed.
+/// \return One set of attributes per pickable.
+std::vector<LayoutAttributes> makeAttributes(std::size_t count, unsigned int seed);
+
+}
+}
+
+#endif // SCREENSPACE_BENCH_SCENE_HH
@@ -0,0 +1,181 @@
+#include "StandIns.hh"
+
+#include "ss/core/Shapes.hh"
+#include "ss/core/Transform.hh"
+
+#include <algorithm>
+
+namespace screenspace {
+namespace bench {
+
+/// Plugs read by PickableShape::readAttributes for shapes other than
+/// custom ones: three color channels, opacity, show, group, shape,
+/// four shape parameters and ten placement plugs.
+static const std::size_t kPlugsPerRead = 21;
+
+PickableNode::PickableNode(const LayoutAttributes& layout, Shape shape, std::size_t camera)
+    : m_attributes(),
+      m_camera(camera),
+      m_layoutVersion(1),
+      m_styleVersion(1),
+      m_plugReads(0)
+{
+  static_cast<LayoutAttributes&>(m_attributes) = layout;
+  m_attributes.shape = shape;
+  m_attributes.parameters = {0.25f, 0.5f, 360.0f, 6};
+  m_attributes.color = {1.0f, 1.0f, 0.0f, 1.0f};
+  m_attributes.show = true;
+  m_attributes.group = 0;
+  m_attributes.outline = 0;
+}
+
+void PickableNode::readAttributes(PickableAttributes& attributes) const
+{
+  attributes = m_attributes;
+  m_plugReads += kPlugsPerRead;
+}
+
+void PickableNode::editLayout(float offsetX)
+{
+  m_attributes.offsetX = offsetX;
+  ++m_layoutVersion;
+}
+
+void PickableNode::editStyle(float red)
+{
+  m_attributes.color.r = red;
+  ++m_styleVersion;
+}
+
+/// Build geometry from unit points and triangles.
+/// \param points x, y per point.
+/// \param numPoints Number of points.
+/// \param indices Triangle indices.
+/// \param numIndices Number of indices.
+/// \param key Key of the shape.
+/// \return The geometry.
+static Geometry buildGeometry(const float* points, std::size_t numPoints,
+                              const unsigned int* indices, std::size_t numIndices,
+                              const ShapeKey& key)
+{
+  Geometry geometry;
+  geometry.key = key;
+  for (std::size_t i = 0; i < numPoints; ++i)
+  {
+    geometry.pointsX.push_back(points[i * 2]);
+    geometry.pointsY.push_back(points[i * 2 + 1]);
+  }
+  geometry.indices.assign(indices, indices + numIndices);
+  return geometry;
+}
+
+GeometryTable::GeometryTable()
+    : m_unit(),
+      m_parametric(),
+      m_maxPoints(0),
+      m_tessellations(0)
+{
+  // Circle levels of detail, then rectangle and triangle, like the
+  // plugin's unit geometry table
+  for (std::size_t i = 0; i < kNumCircleLods + 2; ++i)
+  {
+    const Shape shape = i < kNumCircleLods ? Shape::Circle : static_cast<Shape>(i - kNumCircleLods + 1);
+    const UnitShape& unit = unitShape(shape, i < kNumCircleLods ? i : kDefaultCircleLod);
+    const ShapeKey key = {shape, 0, 0, 0, 0, 0, 0};
+    m_unit.push_back(buildGeometry(&unit.points[0][0], unit.numPoints, unit.indices, unit.numIndices, key));
+    m_maxPoints = std::max(m_maxPoints, unit.numPoints);
+  }
+
+  // Full rings have the most points, two per segment
+  m_maxPoints = std::max(m_maxPoints, 2 * circleSegments(kNumCircleLods - 1) + 2);
+}
+
+const Geometry* GeometryTable::unitGeometry(Shape shape, std::size_t lod) const
+{
+  switch (shape)
+  {
+    case Shape::Circle:
+      return &m_unit[lod < kNumCircleLods ? lod : kNumCircleLods - 1];
+    case Shape::Triangle:
+      return &m_unit[kNumCircleLods + 1];
+    default:
+      break;
+  }
+  return &m_unit[kNumCircleLods];
+}
+
+const Geometry* GeometryTable::parametricGeometry(const ShapeKey& key)
+{
+  std::unique_ptr<Geometry>& geometry = m_parametric[key];
+  if (!geometry)
+  {
+    ShapeMesh mesh;
+    tessellate(key, mesh);
+    ++m_tessellations;
+    geometry.reset(new Geometry(buildGeometry(mesh.points.data(), mesh.points.size() / 2,
+                                              mesh.indices.data(), mesh.indices.size(), key)));
+  }
+  return geometry.get();
+}
+
+PickableData::PickableData(const Geometry* geometry)
+    : m_attributes(),
+      m_placement(),
+      m_geometry(geometry),
+      m_inputs{0, 0, 0, 0, 0, 0},
+      m_visibility(Visibility::Visible),
+      m_prepared(false),
+      m_pending(false)
+{
+}
+
+NodeSource::NodeSource(const PickableNode& node, const FrameContext& frameContext,
+                       GeometryTable& geometry, float circleTolerance)
+    : m_node(node),
+      m_frameContext(frameContext),
+      m_geometry(geometry),
+      m_circleTolerance(circleTolerance)
+{
+}
+
+void NodeSource::prepareVertices(const PickableData& data, std::vector<float>& vertices) const
+{
+  const Geometry& geometry = data.geometry();
+  vertices.resize(geometry.pointsX.size() * 3);
+  transformPoints(data.m_placement, geometry.pointsX.data(), geometry.pointsY.data(),
+                  geometry.pointsX.size(), vertices.data());
+}
+
+void RecordingDrawManager::beginDrawable()
+{
+  ++m_drawables;
+}
+
+void RecordingDrawManager::setColor(const Color& color)
+{
+  m_checksum += color.r;
+}
+
+void RecordingDrawManager::mesh(const std::vector<float>& positions,
+                                const unsigned int* indices,
+                                std::size_t indexCount)
+{
+  m_vertices += positions.size() / 3;
+  m_triangles += indexCount / 3;
+  if (!positions.empty())
+    m_checksum += positions[0] + float(indices[0]);
+}
+
+void RecordingDrawManager::endDrawable()
+{
+}
+
+void RecordingDrawManager::clear()
+{
+  m_drawables = 0;
+  m_vertices = 0;
+  m_triangles = 0;
+}
+
+}
+}
@@ -0,0 +1,203 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_BENCH_STANDINS_HH
+#define SCREENSPACE_BENCH_STANDINS_HH
+
+#include "ss/Types.hh"
+#include "ss/core/Camera.hh"
+#include "ss/core/Layout.hh"
+#include "ss/core/Outlines.hh"
+#include "ss/core/Stages.hh"
+#include "ss/core/Tessellate.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace screenspace {
+namespace bench {
+
+/// Stand-in for MFrameContext, the camera of the viewport being drawn.
+struct FrameContext {
+  std::size_t camera;        // Camera index, stands in for the camera path
+  std::size_t cameraKey;     // Stands in for hashCamera
+  const CameraBasis* basis;  // Stands in for findCameraContext
+};
+
+/// Stand-in for MColor.
+struct Color {
+  float r, g, b, a;
+};
+
+/// Stand-in for PickableAttributes.
+struct PickableAttributes : LayoutAttributes {
+  Shape shape;                 // Draw shape
+  ShapeParameters parameters;  // Parametric shape parameters
+  Color color;                 // Shape color, alpha is opacity
+  bool show;                   // Whether the pickable is drawn at all
+  std::uint64_t group;         // Key of the pickable's group, zero for none
+  std::uint64_t outline;       // Key of the custom outline, zero for none
+};
+
+/// Stand-in for a pickable node. Attribute reads are counted the way
+/// PickableShape::readAttributes reads plugs.
+class PickableNode {
+public:
+  PickableNode(const LayoutAttributes& layout, Shape shape, std::size_t camera);
+
+  /// Read every drawable attribute, like PickableShape::readAttributes.
+  void readAttributes(PickableAttributes& attributes) const;
+
+  /// Change a placement attribute, like setting offsetX in Maya.
+  void editLayout(float offsetX);
+
+  /// Change a style attribute, like setting color in Maya.
+  void editStyle(float red);
+
+  inline std::size_t camera() const { return m_camera; }
+  inline unsigned int layoutVersion() const { return m_layoutVersion; }
+  inline unsigned int styleVersion() const { return m_styleVersion; }
+  inline std::size_t plugReads() const { return m_plugReads; }
+
+private:
+  PickableAttributes m_attributes;
+  std::size_t m_camera;
+  unsigned int m_layoutVersion;
+  unsigned int m_styleVersion;
+  mutable std::size_t m_plugReads;
+};
+
+/// Stand-in for Geometry, unit points as separate x and y arrays.
+struct Geometry {
+  std::vector<float> pointsX;         // Unit x per point
+  std::vector<float> pointsY;         // Unit y per point
+  std::vector<unsigned int> indices;  // Triangle indices
+  ShapeKey key;                       // Parametric key, only the shape for constant shapes
+};
+
+/// Stand-in for the unit geometry table and parametric cache of
+/// UnitGeometry.cc.
+class GeometryTable {
+public:
+  GeometryTable();
+
+  /// Like unitGeometry.
+  const Geometry* unitGeometry(Shape shape, std::size_t lod) const;
+
+  /// Like parametricGeometry, entries are kept for the whole run.
+  const Geometry* parametricGeometry(const ShapeKey& key);
+
+  /// Most points of any shape, so vertices can be sized up front.
+  inline std::size_t maxPoints() const { return m_maxPoints; }
+
+  /// Number of parametric keys tessellated so far.
+  inline std::size_t tessellations() const { return m_tessellations; }
+
+private:
+  std::vector<Geometry> m_unit;
+  std::unordered_map<ShapeKey, std::unique_ptr<Geometry>, ShapeKeyHash> m_parametric;
+  std::size_t m_maxPoints;
+  std::size_t m_tessellations;
+};
+
+/// Stand-in for PickableData, the state prepareStages keeps.
+struct PickableData {
+  explicit PickableData(const Geometry* geometry);
+
+  inline const Geometry& geometry() const { return *m_geometry; }
+  inline bool visible() const { return m_visibility == Visibility::Visible; }
+
+  PickableAttributes m_attributes;
+  Placement m_placement;
+  const Geometry* m_geometry;
+  StageInputs m_inputs;
+  Visibility m_visibility;
+  bool m_prepared;
+  bool m_pending;
+};
+
+/// Stand-in for PickableSource, feeding prepareStages from a node.
+class NodeSource {
+public:
+  using GeometryRef = const Geometry*;
+  using Vertices = std::vector<float>;
+
+  NodeSource(const PickableNode& node, const FrameContext& frameContext,
+             GeometryTable& geometry, float circleTolerance);
+
+  inline unsigned int layoutVersion() const { return m_node.layoutVersion(); }
+  inline unsigned int styleVersion() const { return m_node.styleVersion(); }
+  inline std::size_t cameraKey() const { return m_frameContext.cameraKey; }
+  inline std::size_t transformKey() const { return 0; }
+  inline const CameraBasis& camera() const { return *m_frameContext.basis; }
+  inline float circleTolerance() const { return m_circleTolerance; }
+  inline void readAttributes(PickableAttributes& attributes) const { m_node.readAttributes(attributes); }
+
+  inline const Geometry* unitGeometry(Shape shape, std::size_t lod) const
+  {
+    return m_geometry.unitGeometry(shape, lod);
+  }
+
+  inline const Geometry* parametricGeometry(const ShapeKey& key) const
+  {
+    return m_geometry.parametricGeometry(key);
+  }
+
+  /// The scene has no custom shapes, they draw a rectangle.
+  inline OutlineState outlineGeometry(std::uint64_t, const Geometry**) const
+  {
+    return OutlineState::Failed;
+  }
+
+  inline void verifyPlacement(const PickableData&, const Viewport&) const {}
+
+  /// Like PickableSource::prepareVertices, with the node at the origin.
+  void prepareVertices(const PickableData& data, std::vector<float>& vertices) const;
+
+private:
+  const PickableNode& m_node;
+  const FrameContext& m_frameContext;
+  GeometryTable& m_geometry;
+  float m_circleTolerance;
+};
+
+/// Stand-in for MUIDrawManager that records what was drawn.
+class RecordingDrawManager {
+public:
+  void beginDrawable();
+  void setColor(const Color& color);
+  void mesh(const std::vector<float>& positions, const unsigned int* indices, std::size_t indexCount);
+  void endDrawable();
+
+  /// Forget what was recorded, keeping storage.
+  void clear();
+
+  inline std::size_t drawables() const { return m_drawables; }
+  inline std::size_t vertices() const { return m_vertices; }
+  inline std::size_t triangles() const { return m_triangles; }
+
+private:
+  std::size_t m_drawables = 0;
+  std::size_t m_vertices = 0;
+  std::size_t m_triangles = 0;
+  float m_checksum = 0.0f;
+};
+
+}
+}
+
+#endif // SCREENSPACE_BENCH_STANDINS_HH
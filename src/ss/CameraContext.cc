@@ -0,0 +1,277 @@
+#include "CameraContext.hh"
+
+#include "ss/Hash.hh"
+#include "ss/Platform.hh"
+
+#include <maya/MFloatMatrix.h>
+#include <maya/MFnCamera.h>
+#include <maya/MObject.h>
+#include <maya/MTransformationMatrix.h>
+
+#include <mutex>
+#include <vector>
+
+namespace screenspace {
+
+/// A viewport a camera was drawn in, in camera space.
+struct CameraView {
+  NodeKey camera;          // Camera shape node
+  std::size_t projection;  // Hash of the camera's projection
+  CameraBasis local;       // Basis relative to the camera
+};
+
+/// Copy of the context a thread last looked up, reused for the rest of
+/// its draw pass. It is a copy because the ring entry it came from may
+/// be overwritten by another thread at any time.
+struct LastContext {
+  MObject camera;            // Camera shape node
+  unsigned long long frame;  // Frame stamp of the pass
+  int width;                 // Width of viewport in pixels
+  int height;                // Height of viewport in pixels
+  bool valid;                // False until the first lookup
+  CameraContext context;     // The context
+};
+
+static std::mutex s_mutex;
+static std::vector<CameraContext> s_contexts;  // Reserved up front, entries never move
+static std::size_t s_next = 0;
+static std::vector<CameraView> s_views;
+static std::size_t s_nextView = 0;
+static thread_local LastContext s_last = {MObject(), 0, 0, 0, false, CameraContext()};
+
+static inline Vec3 toVec3(const MVector& v) { return Vec3{float(v.x), float(v.y), float(v.z)}; }
+
+static inline Vec3 transformPoint(const Vec3& p, const MMatrix& m)
+{
+  return toVec3(MPoint(p.x, p.y, p.z) * m);
+}
+
+static inline Vec3 transformVector(const Vec3& v, const MMatrix& m)
+{
+  return toVec3(MVector(v.x, v.y, v.z) * m);
+}
+
+/// Move a basis into another space.
+/// \param basis The basis.
+/// \param matrix Transform into the other space.
+/// \return The transformed basis.
+static CameraBasis transformBasis(const CameraBasis& basis, const MMatrix& matrix)
+{
+  CameraBasis result = basis;
+  result.nearOrigin = transformPoint(basis.nearOrigin, matrix);
+  result.nearX = transformVector(basis.nearX, matrix);
+  result.nearY = transformVector(basis.nearY, matrix);
+  result.farOrigin = transformPoint(basis.farOrigin, matrix);
+  result.farX = transformVector(basis.farX, matrix);
+  result.farY = transformVector(basis.farY, matrix);
+  result.eye = transformPoint(basis.eye, matrix);
+  result.normal = transformVector(basis.normal, matrix);
+  result.right = transformVector(basis.right, matrix);
+  result.up = transformVector(basis.up, matrix);
+  result.back = transformVector(basis.back, matrix);
+  return result;
+}
+
+/// Hash the camera's own projection, which changes with focal length,
+/// film back and orthographic width but not with its transform.
+/// \param cameraPath Path to camera.
+/// \return The hash.
+static std::size_t hashProjection(const MDagPath& cameraPath)
+{
+  const MFnCamera camera(cameraPath);
+  const MFloatMatrix projection = camera.projectionMatrix();
+  const std::hash<float> hasher;
+  std::size_t hash = 0;
+  for (unsigned int row = 0; row < 4; ++row)
+    for (unsigned int column = 0; column < 4; ++column)
+      hash = hashCombine(hash, hasher(projection(row, column)));
+  return hash;
+}
+
+/// Remember the viewport a context was computed for. Must be called
+/// with s_mutex held.
+/// \param cameraPath Path to camera.
+/// \param context The context.
+static void recordCameraView(const MDagPath& cameraPath, const CameraContext& context)
+{
+  CameraView view;
+  view.camera = NodeKey(cameraPath.node());
+  view.projection = hashProjection(cameraPath);
+  view.local = transformBasis(context.basis, cameraPath.inclusiveMatrixInverse());
+
+  // Replace the same viewport, seen with an older transform
+  for (CameraView& existing : s_views)
+  {
+    if (existing.camera == view.camera &&
+        existing.local.width == view.local.width &&
+        existing.local.height == view.local.height)
+    {
+      existing = view;
+      return;
+    }
+  }
+
+  if (s_views.size() < kMaxCameraContexts)
+  {
+    s_views.push_back(view);
+  }
+  else
+  {
+    s_views[s_nextView] = view;
+    s_nextView = (s_nextView + 1) % kMaxCameraContexts;
+  }
+}
+
+/// Compute a context from scratch.
+/// \param cameraPath Path to camera.
+/// \param frameContext Viewport frame context.
+/// \param key Hash from hashCamera.
+/// \return The context.
+static CameraContext computeCameraContext(const MDagPath& cameraPath,
+                                          const MHWRender::MFrameContext& frameContext,
+                                          std::size_t key)
+{
+  CameraContext context;
+  context.key = key;
+
+  int _;
+  frameContext.getViewportDimensions(_, _, context.width, context.height);
+
+  const MFnCamera camera(frameContext.getCurrentCameraPath());
+  context.nearClipPlane = float(camera.nearClippingPlane());
+
+  float theta = atanf(float(context.height) / float(context.width));
+  context.diagonalCos = cosf(theta);
+  context.diagonalSin = sinf(theta);
+
+  // Viewport to world is affine across the near and far planes,
+  // so three unprojections give the whole basis.
+  MPoint nearX, farX, nearY, farY;
+  frameContext.viewportToWorld(0, 0, context.nearOrigin, context.farOrigin);
+  frameContext.viewportToWorld(context.width, 0, nearX, farX);
+  frameContext.viewportToWorld(0, context.height, nearY, farY);
+  context.nearX = (nearX - context.nearOrigin) / double(context.width);
+  context.nearY = (nearY - context.nearOrigin) / double(context.height);
+  context.farX = (farX - context.farOrigin) / double(context.width);
+  context.farY = (farY - context.farOrigin) / double(context.height);
+
+  const MMatrix viewMatrix = cameraPath.inclusiveMatrix();
+  const MTransformationMatrix viewXform(viewMatrix);
+  context.eye = viewXform.getTranslation(MSpace::kWorld);
+  context.normal = MVector(viewMatrix(2, 0), viewMatrix(2, 1), viewMatrix(2, 2));
+  context.rotation = viewXform.asRotateMatrix();
+
+  CameraBasis& basis = context.basis;
+  setViewportSize(basis, context.width, context.height);
+  basis.nearClipPlane = context.nearClipPlane;
+  basis.nearOrigin = toVec3(context.nearOrigin);
+  basis.nearX = toVec3(context.nearX);
+  basis.nearY = toVec3(context.nearY);
+  basis.farOrigin = toVec3(context.farOrigin);
+  basis.farX = toVec3(context.farX);
+  basis.farY = toVec3(context.farY);
+  basis.eye = toVec3(context.eye);
+  basis.normal = toVec3(context.normal);
+  basis.right = Vec3{float(context.rotation(0, 0)), float(context.rotation(0, 1)), float(context.rotation(0, 2))};
+  basis.up = Vec3{float(context.rotation(1, 0)), float(context.rotation(1, 1)), float(context.rotation(1, 2))};
+  basis.back = Vec3{float(context.rotation(2, 0)), float(context.rotation(2, 1)), float(context.rotation(2, 2))};
+  return context;
+}
+
+MPoint CameraContext::viewportToWorld(int x, int y, int depth) const
+{
+  const MPoint near = nearOrigin + nearX * x + nearY * y;
+  const MPoint far = farOrigin + farX * x + farY * y;
+
+  MVector direction = (far - near);
+  direction.normalize();
+
+  float scalar = nearClipPlane + 0.001f * (depth + 1);
+  return near + (direction * scalar);
+}
+
+std::size_t hashCamera(const MDagPath& cameraPath,
+                       const MHWRender::MFrameContext& frameContext)
+{
+  int _, viewportWidth, viewportHeight;
+  frameContext.getViewportDimensions(_, _, viewportWidth, viewportHeight);
+
+  std::size_t hash = hashMatrix(0, cameraPath.inclusiveMatrix());
+  hash = hashMatrix(hash, frameContext.getMatrix(MHWRender::MFrameContext::kProjectionMtx));
+  hash = hashCombine(hash, std::hash<int>()(viewportWidth));
+  hash = hashCombine(hash, std::hash<int>()(viewportHeight));
+  return hash;
+}
+
+const CameraContext& findCameraContext(const MDagPath& cameraPath,
+                                       const MHWRender::MFrameContext& frameContext)
+{
+  // Every pickable of a pass asks for the same camera and viewport
+  const MObject camera = cameraPath.node();
+  const unsigned long long frame = frameContext.getFrameStamp();
+  int _, width, height;
+  frameContext.getViewportDimensions(_, _, width, height);
+  if (s_last.valid && s_last.frame == frame && s_last.width == width &&
+      s_last.height == height && s_last.camera == camera)
+    return s_last.context;
+
+  const std::size_t key = hashCamera(cameraPath, frameContext);
+  std::lock_guard<std::mutex> lock(s_mutex);
+  if (s_contexts.capacity() < kMaxCameraContexts)
+  {
+    s_contexts.reserve(kMaxCameraContexts);
+    s_views.reserve(kMaxCameraContexts);
+  }
+
+  const CameraContext* found = nullptr;
+  for (const CameraContext& context : s_contexts)
+  {
+    if (context.key == key)
+    {
+      found = &context;
+      break;
+    }
+  }
+
+  if (!found)
+  {
+    const CameraContext context = computeCameraContext(cameraPath, frameContext, key);
+    if (s_contexts.size() < kMaxCameraContexts)
+    {
+      s_contexts.push_back(context);
+      found = &s_contexts.back();
+    }
+    else
+    {
+      s_contexts[s_next] = context;
+      found = &s_contexts[s_next];
+      s_next = (s_next + 1) % kMaxCameraContexts;
+    }
+    recordCameraView(cameraPath, context);
+  }
+
+  // Copied under the lock, the ring entry is reused once
+  // kMaxCameraContexts newer ones are computed
+  s_last = LastContext{camera, frame, width, height, true, *found};
+  return s_last.context;
+}
+
+std::size_t findCameraViews(const MDagPath& cameraPath, CameraBasis* views)
+{
+  const NodeKey camera(cameraPath.node());
+  const std::size_t projection = hashProjection(cameraPath);
+  const MMatrix matrix = cameraPath.inclusiveMatrix();
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  std::size_t count = 0;
+  for (const CameraView& view : s_views)
+  {
+    if (count == kMaxCameraViews)
+      break;
+    if (view.camera == camera && view.projection == projection)
+      views[count++] = transformBasis(view.local, matrix);
+  }
+  return count;
+}
+
+}
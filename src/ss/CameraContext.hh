@@ -0,0 +1,98 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CAMERACONTEXT_HH
+#define SCREENSPACE_CAMERACONTEXT_HH
+
+#include "ss/core/Camera.hh"
+
+#include <maya/MDagPath.h>
+#include <maya/MFrameContext.h>
+#include <maya/MMatrix.h>
+#include <maya/MPoint.h>
+#include <maya/MVector.h>
+
+#include <cstddef>
+
+namespace screenspace {
+
+/// Everything needed to place pickables for one camera and viewport.
+/// Identical for every pickable drawn with that camera, so it's
+/// computed once and shared.
+struct CameraContext {
+  std::size_t key;      // Hash of camera, projection and viewport
+  int width;            // Width of viewport in pixels
+  int height;           // Height of viewport in pixels
+  float nearClipPlane;  // Near clip plane of camera
+  float diagonalCos;    // Cosine of the viewport diagonal angle
+  float diagonalSin;    // Sine of the viewport diagonal angle
+  MPoint nearOrigin;    // Near plane point of the bottom left pixel
+  MVector nearX;        // Near plane step per horizontal pixel
+  MVector nearY;        // Near plane step per vertical pixel
+  MPoint farOrigin;     // Far plane point of the bottom left pixel
+  MVector farX;         // Far plane step per horizontal pixel
+  MVector farY;         // Far plane step per vertical pixel
+  MPoint eye;           // Camera position in worldspace
+  MVector normal;       // Camera facing axis
+  MMatrix rotation;     // Camera rotation
+  CameraBasis basis;    // Float copy for the layout core
+
+  /// Compute a worldspace point for (x, y) coordinates in pixels
+  /// from bottom left of viewport.
+  /// \param x Viewport position in pixels.
+  /// \param y Viewport position in pixels.
+  /// \param depth Depth of shape.
+  /// \return The point.
+  MPoint viewportToWorld(int x, int y, int depth) const;
+};
+
+/// Number of contexts kept around. Only a handful of cameras are
+/// drawn at once, so older entries are simply overwritten.
+static const std::size_t kMaxCameraContexts = 16;
+
+/// Most viewports of one camera findCameraViews reports.
+static const std::size_t kMaxCameraViews = 4;
+
+/// Hash the camera inputs that placement depends on.
+/// \param cameraPath Path to camera.
+/// \param frameContext Viewport frame context.
+/// \return The hash.
+std::size_t hashCamera(const MDagPath& cameraPath,
+                       const MHWRender::MFrameContext& frameContext);
+
+/// Fetch the context for a camera and viewport. The first call of a
+/// draw pass hashes the camera inputs and computes the context unless
+/// an earlier pass already did so for the same inputs. Later calls of
+/// the pass on the same thread reuse it without hashing or locking.
+/// \param cameraPath Path to camera.
+/// \param frameContext Viewport frame context.
+/// \return The calling thread's copy of the context. It stays valid
+/// until the thread fetches the context of another camera, viewport
+/// or frame.
+const CameraContext& findCameraContext(const MDagPath& cameraPath,
+                                       const MHWRender::MFrameContext& frameContext);
+
+/// Fetch the viewports a camera was recently drawn in, outside of a
+/// draw. Viewports are kept in camera space and rebuilt for the
+/// camera's current transform, so they follow it as it moves.
+/// Viewports drawn before the camera's projection last changed are
+/// skipped, they're only known again once the camera is redrawn.
+/// \param cameraPath Path to camera.
+/// \param views Will be populated with up to kMaxCameraViews bases.
+/// \return The number of viewports found.
+std::size_t findCameraViews(const MDagPath& cameraPath, CameraBasis* views);
+
+}
+
+#endif // SCREENSPACE_CAMERACONTEXT_HH
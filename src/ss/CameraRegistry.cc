@@ -0,0 +1,266 @@
+#include "CameraRegistry.hh"
+
+#include "ss/Log.hh"
+#include "ss/PickableShape.hh"
+
+#include <maya/MDGMessage.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MItDependencyNodes.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+#include <maya/MSceneMessage.h>
+
+#include <algorithm>
+
+namespace screenspace {
+
+/// Find the camera a pickable is connected to.
+/// \param pickable The pickable node.
+/// \return The camera shape node, or a null object.
+static MObject findConnectedCamera(const MObject& pickable) {
+  const MPlug cameraPlug(pickable, PickableShape::m_camera);
+  MPlugArray srcPlugArray;
+  cameraPlug.connectedTo(srcPlugArray, true, false);
+  if (srcPlugArray.length() == 1)
+  {
+    const MObject srcNode(srcPlugArray[0].node());
+    if (srcNode.hasFn(MFn::kCamera))
+      return srcNode;
+  }
+  return MObject::kNullObj;
+}
+
+static void onConnection(MPlug& srcPlug, MPlug& destPlug, bool made, void*) {
+  if (destPlug.attribute() != PickableShape::m_camera)
+    return;
+
+  CameraRegistry& registry = CameraRegistry::instance();
+  const MObject camera = srcPlug.node();
+  if (made && camera.hasFn(MFn::kCamera))
+    registry.attach(destPlug.node(), camera);
+  else
+    registry.detach(destPlug.node());
+}
+
+static void onNodeAdded(MObject& node, void*) {
+  CameraRegistry::instance().attach(node, MObject::kNullObj);
+}
+
+static void onNodeRemoved(MObject& node, void*) {
+  CameraRegistry::instance().remove(node);
+}
+
+static void onBeginBatch(void*) {
+  CameraRegistry::instance().beginBatch();
+}
+
+static void onEndBatch(void*) {
+  CameraRegistry::instance().endBatch();
+}
+
+CameraRegistry& CameraRegistry::instance() {
+  static CameraRegistry registry;
+  return registry;
+}
+
+CameraRegistry::CameraRegistry()
+    : m_snapshot(std::make_shared<Snapshot>()),
+      m_pending(),
+      m_mutex(),
+      m_batchDepth(0),
+      m_callbacks(),
+      m_version(1)
+{}
+
+MStatus CameraRegistry::initialize() {
+  MStatus status;
+
+  m_callbacks.append(MDGMessage::addConnectionCallback(onConnection, nullptr, &status));
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  m_callbacks.append(MDGMessage::addNodeAddedCallback(onNodeAdded, PickableShape::typeName, nullptr, &status));
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  m_callbacks.append(MDGMessage::addNodeRemovedCallback(onNodeRemoved, PickableShape::typeName, nullptr, &status));
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+
+  const std::pair<MSceneMessage::Message, MSceneMessage::Message> batches[] = {
+      {MSceneMessage::kBeforeOpen, MSceneMessage::kAfterOpen},
+      {MSceneMessage::kBeforeImport, MSceneMessage::kAfterImport},
+      {MSceneMessage::kBeforeCreateReference, MSceneMessage::kAfterCreateReference},
+      {MSceneMessage::kBeforeLoadReference, MSceneMessage::kAfterLoadReference},
+  };
+  for (const auto& batch : batches)
+  {
+    m_callbacks.append(MSceneMessage::addCallback(batch.first, onBeginBatch, nullptr, &status));
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    m_callbacks.append(MSceneMessage::addCallback(batch.second, onEndBatch, nullptr, &status));
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+  }
+
+  // Index existing pickables
+  beginBatch();
+  for (MItDependencyNodes iter(MFn::kPluginShape); !iter.isDone(); iter.next())
+  {
+    const MObject node = iter.thisNode();
+    if (MFnDependencyNode(node).typeId() == PickableShape::id)
+      attach(node, findConnectedCamera(node));
+  }
+  endBatch();
+
+  return MStatus::kSuccess;
+}
+
+void CameraRegistry::uninitialize() {
+  MMessage::removeCallbacks(m_callbacks);
+  m_callbacks.clear();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_pending.reset();
+  m_batchDepth = 0;
+  std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::make_shared<Snapshot>()));
+  ++m_version;
+}
+
+bool CameraRegistry::isAttached(const MObject& pickable,
+                                const MObject& camera) const {
+  const std::shared_ptr<const Snapshot> current = snapshot();
+  const auto iter = current->pickables.find(NodeKey(pickable));
+  if (iter == current->pickables.end())
+    return false;
+  const Entry& entry = iter->second;
+  return entry.camera.handle.isAlive() && entry.camera.handle.objectRef() == camera;
+}
+
+MObject CameraRegistry::camera(const MObject& pickable) const {
+  const std::shared_ptr<const Snapshot> current = snapshot();
+  const auto iter = current->pickables.find(NodeKey(pickable));
+  if (iter == current->pickables.end() || !iter->second.camera.handle.isAlive())
+    return MObject::kNullObj;
+  return iter->second.camera.handle.object();
+}
+
+MObjectArray CameraRegistry::pickables(const MObject& camera) const {
+  MObjectArray pickables;
+  forEachPickable(camera, [&pickables](const MObject& pickable) {
+    pickables.append(pickable);
+  });
+  return pickables;
+}
+
+MObjectArray CameraRegistry::pickables() const {
+  MObjectArray pickables;
+  const std::shared_ptr<const Snapshot> current = snapshot();
+  for (const auto& item : current->pickables)
+    if (item.second.pickable.handle.isAlive())
+      pickables.append(item.second.pickable.handle.object());
+  return pickables;
+}
+
+void CameraRegistry::attach(const MObject& pickable, const MObject& camera) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Snapshot& pending = writable();
+
+  const NodeKey key(pickable);
+  const auto iter = pending.pickables.find(key);
+  if (iter != pending.pickables.end())
+    unlink(pending, iter->second);
+
+  Entry entry;
+  entry.pickable = key;
+  if (!camera.isNull())
+  {
+    entry.camera = NodeKey(camera);
+    pending.cameras[entry.camera].push_back(key.handle);
+  }
+  pending.pickables[key] = entry;
+
+  publish();
+}
+
+void CameraRegistry::detach(const MObject& pickable) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Snapshot& pending = writable();
+
+  const auto iter = pending.pickables.find(NodeKey(pickable));
+  if (iter != pending.pickables.end())
+  {
+    unlink(pending, iter->second);
+    iter->second.camera = NodeKey();
+  }
+
+  publish();
+}
+
+void CameraRegistry::remove(const MObject& pickable) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Snapshot& pending = writable();
+
+  const auto iter = pending.pickables.find(NodeKey(pickable));
+  if (iter != pending.pickables.end())
+  {
+    unlink(pending, iter->second);
+    pending.pickables.erase(iter);
+  }
+
+  publish();
+}
+
+void CameraRegistry::beginBatch() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_batchDepth;
+}
+
+void CameraRegistry::endBatch() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_batchDepth > 0)
+    --m_batchDepth;
+  publish();
+}
+
+std::shared_ptr<const CameraRegistry::Snapshot> CameraRegistry::snapshot() const {
+  return std::atomic_load(&m_snapshot);
+}
+
+CameraRegistry::Snapshot& CameraRegistry::writable() {
+  if (!m_pending)
+    m_pending = std::make_shared<Snapshot>(*snapshot());
+  return *m_pending;
+}
+
+void CameraRegistry::publish() {
+  if (m_batchDepth > 0 || !m_pending)
+    return;
+  std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(m_pending));
+  m_pending.reset();
+  ++m_version;
+}
+
+void CameraRegistry::unlink(Snapshot& snapshot, const Entry& entry) {
+  // Keys were taken while the nodes were alive, so this also finds
+  // cameras and pickables that have since been deleted
+  const auto iter = snapshot.cameras.find(entry.camera);
+  if (iter == snapshot.cameras.end())
+    return;
+
+  std::vector<MObjectHandle>& pickables = iter->second;
+  const MObjectHandle& pickable = entry.pickable.handle;
+  pickables.erase(std::remove_if(pickables.begin(), pickables.end(),
+                                 [&pickable](const MObjectHandle& handle) {
+                                   return handle == pickable;
+                                 }),
+                  pickables.end());
+  if (pickables.empty())
+    snapshot.cameras.erase(iter);
+}
+
+MString cameraName(std::uint64_t key)
+{
+  for (MItDependencyNodes iter(MFn::kCamera); !iter.isDone(); iter.next())
+  {
+    const MObject camera = iter.thisNode();
+    if (MObjectHandle(camera).hashCode() == key)
+      return MFnDependencyNode(camera).name();
+  }
+  return MString();
+}
+
+}
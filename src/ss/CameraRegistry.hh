@@ -0,0 +1,149 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SCREENSPACE_CAMERAREGISTRY_HH
+#define SCREENSPACE_CAMERAREGISTRY_HH
+
+#include "ss/Hash.hh"
+
+#include <maya/MCallbackIdArray.h>
+#include <maya/MObject.h>
+#include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace screenspace {
+
+/// Plugin-wide index of which camera each pickable is attached to.
+///
+/// Kept up to date from DG callbacks so drawing never has to walk
+/// connections. Readers work on an immutable snapshot and never
+/// block, writers copy the snapshot and publish a new one.
+class CameraRegistry {
+public:
+  static CameraRegistry& instance();
+
+public:
+  /// Install callbacks and index pickables already in the scene.
+  /// \return Success if all callbacks were installed.
+  MStatus initialize();
+
+  /// Remove callbacks and forget all pickables.
+  void uninitialize();
+
+  /// Check if a pickable is attached to a camera.
+  /// \param pickable The pickable node.
+  /// \param camera The camera shape node.
+  /// \return True if attached, else false.
+  bool isAttached(const MObject& pickable, const MObject& camera) const;
+
+  /// Find the camera a pickable is attached to.
+  /// \param pickable The pickable node.
+  /// \return The camera shape node, or a null object.
+  MObject camera(const MObject& pickable) const;
+
+  /// Find all pickables attached to a camera.
+  /// \param camera The camera shape node.
+  /// \return The pickables.
+  MObjectArray pickables(const MObject& camera) const;
+
+  /// Visit the pickables attached to a camera without copying them,
+  /// for draw code that runs every frame.
+  /// \param camera The camera shape node.
+  /// \param visit Called with each pickable node.
+  template <typename Visitor>
+  void forEachPickable(const MObject& camera, Visitor visit) const;
+
+  /// Find all pickables.
+  /// \return The pickables.
+  MObjectArray pickables() const;
+
+  /// Record a pickable, optionally attached to a camera.
+  /// \param pickable The pickable node.
+  /// \param camera The camera shape node, or a null object.
+  void attach(const MObject& pickable, const MObject& camera);
+
+  /// Forget the camera a pickable is attached to.
+  /// \param pickable The pickable node.
+  void detach(const MObject& pickable);
+
+  /// Forget a pickable entirely.
+  /// \param pickable The pickable node.
+  void remove(const MObject& pickable);
+
+  /// Change counter, bumped whenever attachments change.
+  unsigned int version() const {return m_version.load(std::memory_order_acquire);}
+
+  /// Collect changes until endBatch rather than publishing each one,
+  /// used while whole scenes are loaded.
+  void beginBatch();
+  void endBatch();
+
+private:
+  struct Entry {
+    NodeKey pickable;
+    NodeKey camera;  // Default key if detached
+  };
+
+  struct Snapshot {
+    std::unordered_map<NodeKey, Entry, NodeKeyHash> pickables;
+    std::unordered_map<NodeKey, std::vector<MObjectHandle>, NodeKeyHash> cameras;
+  };
+
+private:
+  CameraRegistry();
+  CameraRegistry(const CameraRegistry&) = delete;
+  CameraRegistry& operator=(const CameraRegistry&) = delete;
+
+  std::shared_ptr<const Snapshot> snapshot() const;
+  Snapshot& writable();
+  void publish();
+  static void unlink(Snapshot& snapshot, const Entry& entry);
+
+private:
+  std::shared_ptr<const Snapshot> m_snapshot;
+  std::shared_ptr<Snapshot> m_pending;
+  std::mutex m_mutex;
+  int m_batchDepth;
+  MCallbackIdArray m_callbacks;
+  std::atomic<unsigned int> m_version;
+};
+
+template <typename Visitor>
+void CameraRegistry::forEachPickable(const MObject& camera, Visitor visit) const {
+  const std::shared_ptr<const Snapshot> current = snapshot();
+  const auto iter = current->cameras.find(NodeKey(camera));
+  if (iter == current->cameras.end())
+    return;
+  for (const MObjectHandle& handle : iter->second)
+    if (handle.isAlive())
+      visit(handle.object());
+}
+
+/// Find the name of a camera from the hash of its handle, the key
+/// statistics and trace events are recorded under.
+/// \param key Camera handle hash.
+/// \return The camera shape name, or an empty string.
+MString cameraName(std::uint64_t key);
+
+}
+
+#endif // SCREENSPACE_CAMERAREGISTRY_HH
@@ -0,0 +1,64 @@
+#include "GeometryBuffers.hh"
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace screenspace {
+
+static std::mutex s_buffersMutex;
+static std::unordered_map<std::size_t, std::weak_ptr<const GeometryBuffers>> s_buffers;  // By geometry index
+
+/// Upload unit geometry.
+/// \param geometry The geometry.
+/// \return The buffers.
+static GeometryBuffers* uploadGeometry(const Geometry& geometry)
+{
+  const unsigned int vertexCount = geometry.points.length();
+  const unsigned int indexCount = geometry.indices.length();
+
+  const MHWRender::MVertexBufferDescriptor positionDesc("", MHWRender::MGeometry::kPosition, MHWRender::MGeometry::kFloat, 3);
+  std::unique_ptr<GeometryBuffers> buffers(new GeometryBuffers());
+  buffers->positionBuffer.reset(new MHWRender::MVertexBuffer(positionDesc));
+  buffers->indexBuffer.reset(new MHWRender::MIndexBuffer(MHWRender::MGeometry::kUnsignedInt32));
+
+  float* positions = static_cast<float*>(buffers->positionBuffer->acquire(vertexCount, true));
+  for (unsigned int i = 0; i < vertexCount; ++i)
+  {
+    positions[i * 3] = float(geometry.points[i].x);
+    positions[i * 3 + 1] = float(geometry.points[i].y);
+    positions[i * 3 + 2] = float(geometry.points[i].z);
+  }
+  buffers->positionBuffer->commit(positions);
+
+  unsigned int* indices = static_cast<unsigned int*>(buffers->indexBuffer->acquire(indexCount, true));
+  for (unsigned int i = 0; i < indexCount; ++i)
+    indices[i] = geometry.indices[i];
+  buffers->indexBuffer->commit(indices);
+  return buffers.release();
+}
+
+std::shared_ptr<const GeometryBuffers> geometryBuffers(const Geometry& geometry)
+{
+  std::lock_guard<std::mutex> lock(s_buffersMutex);
+  std::weak_ptr<const GeometryBuffers>& entry = s_buffers[geometry.index];
+  std::shared_ptr<const GeometryBuffers> buffers = entry.lock();
+  if (buffers)
+    return buffers;
+
+  const std::size_t index = geometry.index;
+  buffers.reset(uploadGeometry(geometry), [index](const GeometryBuffers* released) {
+    {
+      // Unless the geometry was uploaded again in the meantime
+      std::lock_guard<std::mutex> lock(s_buffersMutex);
+      const auto iter = s_buffers.find(index);
+      if (iter != s_buffers.end() && iter->second.expired())
+        s_buffers.erase(iter);
+    }
+    delete released;
+  });
+  entry = buffers;
+  return buffers;
+}
+
+}
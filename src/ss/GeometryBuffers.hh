@@ -0,0 +1,42 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_GEOMETRYBUFFERS_HH
+#define SCREENSPACE_GEOMETRYBUFFERS_HH
+
+#include "ss/UnitGeometry.hh"
+
+#include <maya/MHWGeometry.h>
+
+#include <memory>
+
+namespace screenspace {
+
+/// Unit geometry on the GPU, shared by the render items of every
+/// subscene override drawing it.
+struct GeometryBuffers {
+  std::unique_ptr<MHWRender::MVertexBuffer> positionBuffer;
+  std::unique_ptr<MHWRender::MIndexBuffer> indexBuffer;
+};
+
+/// Find the buffers of a geometry, uploading them if nothing draws it
+/// yet. They are released along with the last reference, so holders
+/// must keep theirs until their render item stops using the buffers.
+/// \param geometry The geometry.
+/// \return The buffers.
+std::shared_ptr<const GeometryBuffers> geometryBuffers(const Geometry& geometry);
+
+}
+
+#endif // SCREENSPACE_GEOMETRYBUFFERS_HH
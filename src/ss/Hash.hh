@@ -0,0 +1,69 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_HASH_HH
+#define SCREENSPACE_HASH_HH
+
+#include <maya/MMatrix.h>
+#include <maya/MObject.h>
+#include <maya/MObjectHandle.h>
+
+#include <cstddef>
+#include <functional>
+
+namespace screenspace {
+
+/// Combine a hash into a seed.
+/// \param seed Hash to combine with.
+/// \param value Hash to combine.
+/// \return The combined hash.
+inline std::size_t hashCombine(std::size_t seed, std::size_t value) {
+  return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+/// Hash a matrix into a seed.
+/// \param seed Hash to combine with.
+/// \param matrix The matrix.
+/// \return The combined hash.
+inline std::size_t hashMatrix(std::size_t seed, const MMatrix& matrix) {
+  const std::hash<double> hasher;
+  for (unsigned int row = 0; row < 4; ++row)
+    for (unsigned int column = 0; column < 4; ++column)
+      seed = hashCombine(seed, hasher(matrix(row, column)));
+  return seed;
+}
+
+/// Identity of a node, for keying unordered containers. The handle
+/// hash is taken once while the node is alive and kept, so entries of
+/// deleted nodes can still be found and erased. Nodes whose hashes
+/// collide stay apart, equality compares the nodes themselves.
+struct NodeKey {
+  NodeKey() : hash(0), handle() {}
+  explicit NodeKey(const MObject& node) : hash(MObjectHandle(node).hashCode()), handle(node) {}
+
+  bool operator==(const NodeKey& other) const {return hash == other.hash && handle == other.handle;}
+  bool operator!=(const NodeKey& other) const {return !(*this == other);}
+
+  unsigned int hash;     // Handle hash, taken while the node was alive
+  MObjectHandle handle;  // The node
+};
+
+/// Hash of a node key, for unordered containers.
+struct NodeKeyHash {
+  std::size_t operator()(const NodeKey& key) const {return key.hash;}
+};
+
+}
+
+#endif // SCREENSPACE_HASH_HH
@@ -1,48 +1,243 @@
 #include "Log.hh"
 
 #include "ss/Platform.hh"
+#include "ss/core/RingBuffer.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace technic {
 
-Log::Log(std::ostream* stream, Level level)
-    : m_stream(stream),
-      m_level(level),
-      m_mutex() {
+using screenspace::RingBuffer;
+
+/// Records each thread can hold before the sink catches up.
+static const std::size_t kRecordsPerThread = 1024;
+
+/// How often the sink wakes to write records out.
+static const std::chrono::milliseconds kSinkInterval(20);
+
+namespace {
+
+struct Sink;
+void stop( Sink& s );
+
+/// Background writer and the buffers it drains.
+struct Sink {
+    ~Sink() { stop( *this ); }
+
+    std::mutex mutex;  // Guards buffers, running and wake
+    std::condition_variable wake;
+    std::vector< std::unique_ptr< RingBuffer< Record > > > buffers;
+    bool running = false;
+    std::thread thread;
+
+    std::mutex drainMutex;  // Single consumer of the buffers
+    std::atomic< std::uint64_t > sequence{ 0 };
+    std::atomic< std::size_t > dropped{ 0 };
+};
+
 }
 
-Stream::Stream(Log& log, const std::string& prefix)
-    : m_log(log) {
-  m_log.m_mutex.lock();
-  *( m_log.m_stream ) << "[" << prefix << "]: ";
+static Sink& sink() {
+  static Sink sink;
+  return sink;
+}
+
+/// Buffer of the calling thread, made on first use.
+static RingBuffer< Record >& threadBuffer() {
+  thread_local RingBuffer< Record >* buffer = nullptr;
+  if ( !buffer ) {
+    Sink& s = sink();
+    std::lock_guard< std::mutex > lock( s.mutex );
+    s.buffers.emplace_back( new RingBuffer< Record >( kRecordsPerThread ) );
+    buffer = s.buffers.back().get();
+  }
+  return *buffer;
+}
+
+/// Write out every pending record, oldest first.
+static void drain( Sink& s ) {
+  std::lock_guard< std::mutex > drainLock( s.drainMutex );
+
+  std::vector< RingBuffer< Record >* > buffers;
+  {
+    std::lock_guard< std::mutex > lock( s.mutex );
+    for ( const std::unique_ptr< RingBuffer< Record > >& buffer : s.buffers )
+      buffers.push_back( buffer.get() );
+  }
+
+  std::vector< Record > records;
+  Record record;
+  for ( RingBuffer< Record >* buffer : buffers )
+    while ( buffer->pop( record ) )
+      records.push_back( record );
+  if ( records.empty() )
+    return;
+
+  std::sort( records.begin(), records.end(), []( const Record& a, const Record& b ) {
+    return a.sequence < b.sequence;
+  } );
+
+  bool out = false;
+  bool err = false;
+  for ( const Record& entry : records ) {
+    std::ostream& stream = entry.level >= Level::Warning ? std::cerr : std::cout;
+    stream.write( entry.text, entry.length );
+    out = out || &stream == &std::cout;
+    err = err || &stream == &std::cerr;
+  }
+  if ( out )
+    std::cout.flush();
+  if ( err )
+    std::cerr.flush();
+}
+
+Stream::Stream( Level level, const char* prefix ) {
+  m_record.sequence = 0;
+  m_record.level = level;
+  m_record.length = 0;
+  append( "[%s]: ", prefix );
 }
 
 Stream::~Stream() {
-  m_log.m_mutex.unlock();
-  *( m_log.m_stream ) << std::endl;
+  // Always end with a newline, even if the text was truncated
+  const unsigned int last = sizeof( m_record.text ) - 1;
+  if ( m_record.length > last )
+    m_record.length = last;
+  m_record.text[ m_record.length++ ] = '\n';
+
+  Sink& s = sink();
+  m_record.sequence = s.sequence.fetch_add( 1, std::memory_order_relaxed );
+  if ( !threadBuffer().push( m_record ) )
+    s.dropped.fetch_add( 1, std::memory_order_relaxed );
 }
 
-NullStream::NullStream(Log& log, const std::string& prefix)
-    : m_log(log) {
+void Stream::append( const char* format, ... ) {
+  // Leave room for the newline added on submit
+  const unsigned int capacity = sizeof( m_record.text ) - 1;
+  if ( m_record.length >= capacity )
+    return;
+
+  va_list args;
+  va_start( args, format );
+  const int written = std::vsnprintf( m_record.text + m_record.length,
+                                      capacity - m_record.length + 1, format, args );
+  va_end( args );
+  if ( written > 0 )
+    m_record.length = std::min( capacity, m_record.length + unsigned( written ) );
 }
 
-Log& debug_log() {
-  static Log log(&std::cout, Level::Debug);
-  return log;
+Stream& Stream::operator<<( const char* value ) {
+  append( "%s", value ? value : "(null)" );
+  return *this;
 }
 
-Log& info_log() {
-  static Log log(&std::cout, Level::Info);
-  return log;
+Stream& Stream::operator<<( const std::string& value ) {
+  append( "%s", value.c_str() );
+  return *this;
 }
 
-Log& warn_log() {
-  static Log log(&std::cerr, Level::Warning);
-  return log;
+Stream& Stream::operator<<( char value ) {
+  append( "%c", value );
+  return *this;
 }
 
-Log& error_log() {
-  static Log log(&std::cerr, Level::Error);
-  return log;
-};
+Stream& Stream::operator<<( bool value ) {
+  append( "%s", value ? "true" : "false" );
+  return *this;
+}
+
+Stream& Stream::operator<<( int value ) {
+  append( "%d", value );
+  return *this;
+}
+
+Stream& Stream::operator<<( long value ) {
+  append( "%ld", value );
+  return *this;
+}
+
+Stream& Stream::operator<<( long long value ) {
+  append( "%lld", value );
+  return *this;
+}
+
+Stream& Stream::operator<<( unsigned int value ) {
+  append( "%u", value );
+  return *this;
+}
+
+Stream& Stream::operator<<( unsigned long value ) {
+  append( "%lu", value );
+  return *this;
+}
+
+Stream& Stream::operator<<( unsigned long long value ) {
+  append( "%llu", value );
+  return *this;
+}
+
+Stream& Stream::operator<<( double value ) {
+  append( "%g", value );
+  return *this;
+}
+
+Stream& Stream::operator<<( const void* value ) {
+  append( "%p", value );
+  return *this;
+}
+
+void startLog() {
+  Sink& s = sink();
+  std::lock_guard< std::mutex > lock( s.mutex );
+  if ( s.running )
+    return;
+
+  s.running = true;
+  s.thread = std::thread( [&s]() {
+    std::unique_lock< std::mutex > lock( s.mutex );
+    while ( s.running ) {
+      s.wake.wait_for( lock, kSinkInterval );
+      lock.unlock();
+      drain( s );
+      lock.lock();
+    }
+  } );
+}
+
+namespace {
+
+/// Stop the sink thread and write out what's left.
+void stop( Sink& s ) {
+  {
+    std::lock_guard< std::mutex > lock( s.mutex );
+    s.running = false;
+  }
+  s.wake.notify_one();
+  if ( s.thread.joinable() )
+    s.thread.join();
+  drain( s );
+}
+
+}
+
+void stopLog() {
+  stop( sink() );
+}
+
+void flushLog() {
+  drain( sink() );
+}
+
+std::size_t droppedRecords() {
+  return sink().dropped.load( std::memory_order_relaxed );
+}
 
-} // namspace technic
\ No newline at end of file
+} // namespace technic
@@ -17,6 +17,9 @@
 
 #include "ss/Platform.hh"
 
+#include <cstddef>
+#include <cstdint>
+
 namespace technic {
 
 enum class Level {
@@ -26,87 +29,106 @@ enum class Level {
     Error,
 };
 
-class Stream;
-class NullStream;
-
-class Log {
-public:
-    Log( std::ostream* stream, Level level );
-private:
-    std::mutex m_mutex;
-    std::ostream* m_stream;
-    Level m_level;
-
-    friend Stream;
-    friend NullStream;
+/// One log line, formatted in place so it's written out in one piece.
+struct Record {
+    std::uint64_t sequence;  // Order records were made in, across threads
+    Level level;
+    unsigned int length;
+    char text[240];
 };
 
+/// Formats a record and hands it to the sink when destroyed. Records
+/// go into a lock-free buffer of the calling thread, a background
+/// thread writes them out. Records are dropped rather than block if
+/// the buffer is full.
 class Stream {
 public:
-    explicit Stream( Log& log, const std::string& prefix  );
+    Stream( Level level, const char* prefix );
     ~Stream();
 
-    template< typename T >
-    Stream& operator<<( T value );
+    Stream& operator<<( const char* value );
+    Stream& operator<<( const std::string& value );
+    Stream& operator<<( char value );
+    Stream& operator<<( bool value );
+    Stream& operator<<( int value );
+    Stream& operator<<( long value );
+    Stream& operator<<( long long value );
+    Stream& operator<<( unsigned int value );
+    Stream& operator<<( unsigned long value );
+    Stream& operator<<( unsigned long long value );
+    Stream& operator<<( double value );
+    Stream& operator<<( const void* value );
 
 private:
     Stream( Stream& ) = delete;
     Stream& operator=( Stream& ) = delete;
     Stream& operator=( Stream&& ) = delete;
 
-    Log& m_log;
-};
+    void append( const char* format, ... );
 
-template< typename T >
-Stream& Stream::operator<<( T value ) {
-    *( m_log.m_stream ) << value;
-    return *this;
-}
+    Record m_record;
+};
 
+/// Stands in for Stream when a level is compiled out.
 class NullStream {
 public:
-    explicit NullStream( Log& log, const std::string& prefix );
-    ~NullStream() = default;
+    NullStream() = default;
 
     template< typename T >
-    NullStream& operator<<( T value );
+    NullStream& operator<<( const T& ) { return *this; }
+};
 
-private:
-    NullStream( NullStream& ) = delete;
-    NullStream& operator=( Stream& ) = delete;
-    NullStream& operator=( NullStream&& ) = delete;
+/// Start the background thread writing records out.
+void startLog();
 
-    Log& m_log;
-};
+/// Write out pending records and stop the background thread.
+void stopLog();
 
-template< typename T >
-NullStream& NullStream::operator<<( T value ) {
-    return *this;
-}
+/// Write out pending records from the calling thread.
+void flushLog();
 
-Log& debug_log();
-Log& info_log();
-Log& warn_log();
-Log& error_log();
+/// Records dropped because a thread's buffer was full.
+std::size_t droppedRecords();
 
 } // namespace technic
 
-#define SS_INITIALISE_LOG() \
-    ::technic::debug_log();     \
-    ::technic::info_log();      \
-    ::technic::warn_log();      \
-    ::technic::error_log();
+// Lowest level compiled in, 0 for debug up to 3 for errors only
+#ifndef SS_LOG_LEVEL
+#define SS_LOG_LEVEL 0
+#endif
 
 #ifdef SS_LOGGING_ENABLED
-#define SS_DEBUG ::technic::Stream( ::technic::debug_log(), "DBG" ) << "[" << __FUNCTION__ << "]: "
-#define SS_INFO ::technic::Stream( ::technic::info_log(), "NFO" ) << "[" << __FUNCTION__ << "]: "
-#define SS_WARN ::technic::Stream( ::technic::warn_log(), "WRN" ) << "[" << __FUNCTION__ << "]: "
-#define SS_ERROR ::technic::Stream( ::technic::error_log(), "ERR" ) << "[" << __FUNCTION__ << "]: "
+#define SS_INITIALISE_LOG() ::technic::startLog()
+#define SS_SHUTDOWN_LOG() ::technic::stopLog()
+#else
+#define SS_INITIALISE_LOG() ((void) 0)
+#define SS_SHUTDOWN_LOG() ((void) 0)
+#endif
+
+#define SS_LOG_STREAM( level, prefix ) ::technic::Stream( level, prefix ) << "[" << __FUNCTION__ << "]: "
+
+#if defined( SS_LOGGING_ENABLED ) && SS_LOG_LEVEL <= 0
+#define SS_DEBUG SS_LOG_STREAM( ::technic::Level::Debug, "DBG" )
+#else
+#define SS_DEBUG ::technic::NullStream()
+#endif
+
+#if defined( SS_LOGGING_ENABLED ) && SS_LOG_LEVEL <= 1
+#define SS_INFO SS_LOG_STREAM( ::technic::Level::Info, "NFO" )
+#else
+#define SS_INFO ::technic::NullStream()
+#endif
+
+#if defined( SS_LOGGING_ENABLED ) && SS_LOG_LEVEL <= 2
+#define SS_WARN SS_LOG_STREAM( ::technic::Level::Warning, "WRN" )
+#else
+#define SS_WARN ::technic::NullStream()
+#endif
+
+#if defined( SS_LOGGING_ENABLED ) && SS_LOG_LEVEL <= 3
+#define SS_ERROR SS_LOG_STREAM( ::technic::Level::Error, "ERR" )
 #else
-#define SS_DEBUG ::technic::NullStream( ::technic::debug_log(), "DBG" )
-#define SS_INFO ::technic::NullStream( ::technic::info_log(), "NFO" )
-#define SS_WARN ::technic::NullStream( ::technic::warn_log(), "WRN" )
-#define SS_ERROR ::technic::NullStream( ::technic::error_log(), "ERR" )
+#define SS_ERROR ::technic::NullStream()
 #endif
 
-#endif // TECHNIC_LOG_HH
+#endif // SCREENSPACE_LOG_HH
@@ -0,0 +1,55 @@
+#include "PickableBatch.hh"
+
+#include "ss/PickableShape.hh"
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MItDependencyNodes.h>
+
+namespace screenspace {
+
+MString PickableBatch::typeName = "pickableBatch";
+MTypeId PickableBatch::id(0x87020);
+
+void* PickableBatch::creator() {
+  return new PickableBatch();
+}
+
+MStatus PickableBatch::initialize() {
+  return MStatus::kSuccess;
+}
+
+/// Check if the scene has a node of a plugin type.
+/// \param type Function set type of the plugin node.
+/// \param id Plugin node type.
+/// \return True if one exists.
+static bool hasNode(MFn::Type type, const MTypeId& id)
+{
+  for (MItDependencyNodes iter(type); !iter.isDone(); iter.next())
+  {
+    if (MFnDependencyNode(iter.thisNode()).typeId() == id)
+      return true;
+  }
+  return false;
+}
+
+MStatus addPickableBatch(MDagModifier& modifier)
+{
+  if (hasNode(MFn::kPluginLocatorNode, PickableBatch::id))
+    return MS::kSuccess;
+
+  MStatus status;
+  modifier.createNode(PickableBatch::id, MObject::kNullObj, &status);
+  return status;
+}
+
+void ensurePickableBatch()
+{
+  if (!hasNode(MFn::kPluginShape, PickableShape::id))
+    return;
+
+  MDagModifier modifier;
+  CHECK_MSTATUS(addPickableBatch(modifier));
+  CHECK_MSTATUS(modifier.doIt());
+}
+
+}
@@ -0,0 +1,49 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_PICKABLEBATCH_HH
+#define SCREENSPACE_PICKABLEBATCH_HH
+
+#include <maya/MDagModifier.h>
+#include <maya/MPxLocatorNode.h>
+
+namespace screenspace {
+
+/// Locator that draws every pickable in the scene through a single
+/// PickableBatchOverride or PickableInstanceOverride when the batched
+/// or instanced draw mode is enabled.
+class PickableBatch : public MPxLocatorNode {
+public:
+  static MTypeId id;
+  static MString typeName;
+  static void* creator();
+  static MStatus initialize();
+
+public:
+  bool isBounded() const override { return false; }
+};
+
+/// Queue a pickableBatch node unless the scene already has one.
+/// \param modifier Modifier the node is created with.
+/// \return Success unless the node couldn't be queued.
+MStatus addPickableBatch(MDagModifier& modifier);
+
+/// Create a pickableBatch node if the scene has pickables but no batch
+/// node, as nothing else draws them in the batched and instanced draw
+/// modes. Not undoable, meant for plugin load and scene open.
+void ensurePickableBatch();
+
+}
+
+#endif // SCREENSPACE_PICKABLEBATCH_HH
@@ -0,0 +1,327 @@
+#include "PickableBatchOverride.hh"
+
+#include "ss/CameraContext.hh"
+#include "ss/CameraRegistry.hh"
+#include "ss/Log.hh"
+#include "ss/core/Stats.hh"
+#include "ss/core/Transform.hh"
+
+#include <maya/MDagPath.h>
+#include <maya/MViewport2Renderer.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace screenspace {
+
+MString PickableBatchOverride::classification = "drawdb/subscene/ss/pickableBatch";
+MString PickableBatchOverride::id = "pickableBatch";
+
+/// Write a pickable's worldspace vertices and colors into batch arrays.
+/// \param data The pickable data.
+/// \param vertexOffset First vertex to write.
+/// \param positions Batch positions.
+/// \param colors Batch colors.
+static void writeVertices(const PickableData& data,
+                          unsigned int vertexOffset,
+                          std::vector<float>& positions,
+                          std::vector<float>& colors)
+{
+  const Geometry& geometry = data.geometry();
+  transformPoints(data.placement(),
+                  geometry.pointsX.data(),
+                  geometry.pointsY.data(),
+                  geometry.pointsX.size(),
+                  &positions[vertexOffset * 3]);
+
+  const MColor& color = data.color();
+  for (unsigned int i = 0; i < geometry.points.length(); ++i)
+  {
+    float* rgba = &colors[(vertexOffset + i) * 4];
+    rgba[0] = color.r;
+    rgba[1] = color.g;
+    rgba[2] = color.b;
+    rgba[3] = color.a;
+  }
+}
+
+/// Bound worldspace batch positions.
+/// \param positions Batch positions.
+/// \return The bounds.
+static MBoundingBox positionBounds(const std::vector<float>& positions)
+{
+  MBoundingBox bounds;
+  for (std::size_t i = 0; i + 2 < positions.size(); i += 3)
+    bounds.expand(MPoint(positions[i], positions[i + 1], positions[i + 2]));
+  return bounds;
+}
+
+MHWRender::MPxSubSceneOverride* PickableBatchOverride::creator(const MObject& obj)
+{
+  return new PickableBatchOverride(obj);
+}
+
+PickableBatchOverride::PickableBatchOverride(const MObject& obj)
+    : MPxSubSceneOverride(obj),
+      m_pickables(),
+      m_batches(),
+      m_opaqueShader(nullptr),
+      m_transparentShader(nullptr)
+{
+  MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer();
+  const MHWRender::MShaderManager* shaderManager = renderer ? renderer->getShaderManager() : nullptr;
+  if (!shaderManager)
+    return;
+
+  m_opaqueShader = shaderManager->getStockShader(MHWRender::MShaderManager::k3dCPVSolidShader);
+  m_transparentShader = shaderManager->getStockShader(MHWRender::MShaderManager::k3dCPVSolidShader);
+  if (m_transparentShader)
+    m_transparentShader->setIsTransparent(true);
+}
+
+PickableBatchOverride::~PickableBatchOverride()
+{
+  MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer(false);
+  const MHWRender::MShaderManager* shaderManager = renderer ? renderer->getShaderManager() : nullptr;
+  if (!shaderManager)
+    return;
+
+  if (m_opaqueShader)
+    shaderManager->releaseShader(m_opaqueShader);
+  if (m_transparentShader)
+    shaderManager->releaseShader(m_transparentShader);
+}
+
+MHWRender::DrawAPI PickableBatchOverride::supportedDrawAPIs() const {
+  return MHWRender::kAllDevices;
+}
+
+bool PickableBatchOverride::requiresUpdate(const MHWRender::MSubSceneContainer& container,
+                                           const MHWRender::MFrameContext& frameContext) const
+{
+  // Placement depends on the camera, unchanged pickables are skipped
+  // cheaply in update.
+  return true;
+}
+
+void PickableBatchOverride::update(MHWRender::MSubSceneContainer& container,
+                                   const MHWRender::MFrameContext& frameContext)
+{
+  const MDagPath cameraPath = frameContext.getCurrentCameraPath();
+  const NodeKey cameraNode(cameraPath.node());
+  const unsigned int cameraKey = cameraNode.hash;
+  const CameraContext& camera = findCameraContext(cameraPath, frameContext);
+
+  // Forget deleted pickables before a new node can take their key,
+  // their data points at the deleted node
+  for (auto iter = m_pickables.begin(); iter != m_pickables.end();)
+  {
+    if (iter->first.handle.isAlive())
+      ++iter;
+    else
+      iter = m_pickables.erase(iter);
+  }
+
+  // Prepare pickables of this camera
+  m_opaque.clear();
+  m_transparent.clear();
+  CameraRegistry::instance().forEachPickable(cameraPath.node(), [&](const MObject& node) {
+    MDagPath pickablePath;
+    if (!MDagPath::getAPathTo(node, pickablePath) || !pickablePath.isVisible())
+    {
+      countPickable(cameraKey, Outcome::Culled);
+      return;
+    }
+
+    const NodeKey key(node);
+    PickableData& data = m_pickables[key];
+
+    const PrepareResult result = preparePickable(pickablePath, camera, data);
+    if (result.culled)
+    {
+      countPickable(cameraKey, Outcome::Culled);
+      return;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.data = &data;
+    entry.changed = result.style || result.matrix;
+    countPickable(cameraKey, entry.changed ? Outcome::Drawn : Outcome::CacheHit);
+    if (data.color().a < 1.0f)
+      m_transparent.push_back(entry);
+    else
+      m_opaque.push_back(entry);
+  });
+
+  Batch& opaqueBatch = findBatch(container, cameraNode, false);
+  upload(opaqueBatch, fill(opaqueBatch, m_opaque));
+
+  Batch& transparentBatch = findBatch(container, cameraNode, true);
+  upload(transparentBatch, fill(transparentBatch, m_transparent));
+
+  // Only draw batches of this camera
+  for (const std::unique_ptr<Batch>& batch : m_batches)
+    batch->item->enable(batch->camera == cameraNode && !batch->indices.empty());
+}
+
+PickableBatchOverride::Batch& PickableBatchOverride::findBatch(MHWRender::MSubSceneContainer& container,
+                                                               const NodeKey& camera,
+                                                               bool transparent)
+{
+  for (const std::unique_ptr<Batch>& batch : m_batches)
+    if (batch->camera == camera && batch->transparent == transparent)
+      return *batch;
+
+  // Batches are never removed, so their count keeps names unique
+  MString name = "screenspaceBatch_";
+  name += static_cast<unsigned int>(m_batches.size());
+  name += transparent ? "_transparent" : "_opaque";
+
+  MHWRender::MRenderItem* item = MHWRender::MRenderItem::Create(
+      name, MHWRender::MRenderItem::NonMaterialSceneItem, MHWRender::MGeometry::kTriangles);
+  item->setDrawMode(MHWRender::MGeometry::kAll);
+  item->castsShadows(false);
+  item->receivesShadows(false);
+  item->setShader(transparent ? m_transparentShader : m_opaqueShader);
+  container.add(item);
+
+  std::unique_ptr<Batch> batch(new Batch());
+  batch->camera = camera;
+  batch->transparent = transparent;
+  batch->item = item;
+  batch->dirtyBegin = 0;
+  batch->dirtyEnd = 0;
+  m_batches.push_back(std::move(batch));
+  return *m_batches.back();
+}
+
+bool PickableBatchOverride::fill(Batch& batch, const std::vector<Entry>& entries)
+{
+  // Same pickables with the same geometry only need their changed
+  // ranges rewritten.
+  bool sameLayout = batch.slots.size() == entries.size();
+  for (std::size_t i = 0; sameLayout && i < entries.size(); ++i)
+    sameLayout = batch.slots[i].key == entries[i].key &&
+                 batch.slots[i].geometry == entries[i].data->geometry().index;
+
+  if (sameLayout)
+  {
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+      if (!entries[i].changed)
+        continue;
+      const Slot& slot = batch.slots[i];
+      writeVertices(*entries[i].data, slot.vertexOffset, batch.positions, batch.colors);
+      if (batch.dirtyBegin == batch.dirtyEnd)
+      {
+        batch.dirtyBegin = slot.vertexOffset;
+        batch.dirtyEnd = slot.vertexOffset + slot.vertexCount;
+      }
+      else
+      {
+        batch.dirtyBegin = std::min(batch.dirtyBegin, slot.vertexOffset);
+        batch.dirtyEnd = std::max(batch.dirtyEnd, slot.vertexOffset + slot.vertexCount);
+      }
+    }
+    return false;
+  }
+
+  // Rebuild
+  unsigned int vertexCount = 0;
+  unsigned int indexCount = 0;
+  for (const Entry& entry : entries)
+  {
+    vertexCount += entry.data->geometry().points.length();
+    indexCount += entry.data->geometry().indices.length();
+  }
+
+  batch.slots.resize(entries.size());
+  batch.positions.resize(vertexCount * 3);
+  batch.colors.resize(vertexCount * 4);
+  batch.indices.resize(indexCount);
+
+  unsigned int vertexOffset = 0;
+  unsigned int indexOffset = 0;
+  for (std::size_t i = 0; i < entries.size(); ++i)
+  {
+    const Geometry& geometry = entries[i].data->geometry();
+
+    Slot& slot = batch.slots[i];
+    slot.key = entries[i].key;
+    slot.vertexOffset = vertexOffset;
+    slot.vertexCount = geometry.points.length();
+    slot.geometry = geometry.index;
+
+    writeVertices(*entries[i].data, vertexOffset, batch.positions, batch.colors);
+    for (unsigned int j = 0; j < geometry.indices.length(); ++j)
+      batch.indices[indexOffset + j] = vertexOffset + geometry.indices[j];
+
+    vertexOffset += slot.vertexCount;
+    indexOffset += geometry.indices.length();
+  }
+
+  batch.dirtyBegin = 0;
+  batch.dirtyEnd = vertexCount;
+  return true;
+}
+
+void PickableBatchOverride::upload(Batch& batch, bool reallocate)
+{
+  if (batch.indices.empty())
+    return;
+
+  const unsigned int vertexCount = static_cast<unsigned int>(batch.positions.size() / 3);
+  const unsigned int indexCount = static_cast<unsigned int>(batch.indices.size());
+
+  if (reallocate)
+  {
+    const MHWRender::MVertexBufferDescriptor positionDesc("", MHWRender::MGeometry::kPosition, MHWRender::MGeometry::kFloat, 3);
+    const MHWRender::MVertexBufferDescriptor colorDesc("", MHWRender::MGeometry::kColor, MHWRender::MGeometry::kFloat, 4);
+
+    std::unique_ptr<MHWRender::MVertexBuffer> positionBuffer(new MHWRender::MVertexBuffer(positionDesc));
+    std::unique_ptr<MHWRender::MVertexBuffer> colorBuffer(new MHWRender::MVertexBuffer(colorDesc));
+    std::unique_ptr<MHWRender::MIndexBuffer> indexBuffer(new MHWRender::MIndexBuffer(MHWRender::MGeometry::kUnsignedInt32));
+
+    void* positions = positionBuffer->acquire(vertexCount, true);
+    std::memcpy(positions, batch.positions.data(), batch.positions.size() * sizeof(float));
+    positionBuffer->commit(positions);
+
+    void* colors = colorBuffer->acquire(vertexCount, true);
+    std::memcpy(colors, batch.colors.data(), batch.colors.size() * sizeof(float));
+    colorBuffer->commit(colors);
+
+    void* indices = indexBuffer->acquire(indexCount, true);
+    std::memcpy(indices, batch.indices.data(), batch.indices.size() * sizeof(unsigned int));
+    indexBuffer->commit(indices);
+
+    const MBoundingBox bounds = positionBounds(batch.positions);
+    MHWRender::MVertexBufferArray buffers;
+    buffers.addBuffer("positions", positionBuffer.get());
+    buffers.addBuffer("colors", colorBuffer.get());
+    CHECK_MSTATUS(setGeometryForRenderItem(*batch.item, buffers, *indexBuffer, &bounds));
+
+    batch.positionBuffer = std::move(positionBuffer);
+    batch.colorBuffer = std::move(colorBuffer);
+    batch.indexBuffer = std::move(indexBuffer);
+  }
+  else if (batch.dirtyBegin < batch.dirtyEnd)
+  {
+    const unsigned int count = batch.dirtyEnd - batch.dirtyBegin;
+    CHECK_MSTATUS(batch.positionBuffer->update(&batch.positions[batch.dirtyBegin * 3], batch.dirtyBegin, count, false));
+    CHECK_MSTATUS(batch.colorBuffer->update(&batch.colors[batch.dirtyBegin * 4], batch.dirtyBegin, count, false));
+
+    // Vertices follow the camera, so the bounds Maya culls the batch
+    // with have to be set again along with them.
+    const MBoundingBox bounds = positionBounds(batch.positions);
+    MHWRender::MVertexBufferArray buffers;
+    buffers.addBuffer("positions", batch.positionBuffer.get());
+    buffers.addBuffer("colors", batch.colorBuffer.get());
+    CHECK_MSTATUS(setGeometryForRenderItem(*batch.item, buffers, *batch.indexBuffer, &bounds));
+  }
+
+  batch.dirtyBegin = 0;
+  batch.dirtyEnd = 0;
+}
+
+}
@@ -0,0 +1,108 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_PICKABLEBATCHOVERRIDE_HH
+#define SCREENSPACE_PICKABLEBATCHOVERRIDE_HH
+
+#include "ss/Hash.hh"
+#include "ss/PickableData.hh"
+
+#include <maya/MHWGeometry.h>
+#include <maya/MPxSubSceneOverride.h>
+#include <maya/MShaderManager.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace screenspace {
+
+/// Draws all pickables attached to a camera from a few shared vertex
+/// and index buffers, one render item per camera and material state.
+/// Only the vertex ranges of pickables that changed are re-uploaded.
+class PickableBatchOverride : public MHWRender::MPxSubSceneOverride
+{
+public:
+  static MString classification;
+  static MString id;
+  static MPxSubSceneOverride* creator(const MObject& obj);
+
+public:
+  ~PickableBatchOverride() override;
+
+public:
+  MHWRender::DrawAPI supportedDrawAPIs() const override;
+  bool requiresUpdate(const MHWRender::MSubSceneContainer& container,
+                      const MHWRender::MFrameContext& frameContext) const override;
+  void update(MHWRender::MSubSceneContainer& container,
+              const MHWRender::MFrameContext& frameContext) override;
+
+private:
+  /// Range of a pickable within a batch.
+  struct Slot {
+    NodeKey key;                // Pickable node
+    unsigned int vertexOffset;  // First vertex
+    unsigned int vertexCount;   // Number of vertices
+    std::size_t geometry;       // Index of the geometry the indices were written from
+  };
+
+  /// Shared buffers for the pickables of one camera and material state.
+  struct Batch {
+    NodeKey camera;                       // Camera node
+    bool transparent;                     // Material state
+    MHWRender::MRenderItem* item;         // Owned by the container
+    std::vector<Slot> slots;              // Pickable ranges
+    std::vector<float> positions;         // Worldspace xyz per vertex
+    std::vector<float> colors;            // rgba per vertex
+    std::vector<unsigned int> indices;    // Triangle indices
+    unsigned int dirtyBegin;              // First vertex to upload
+    unsigned int dirtyEnd;                // One past last vertex to upload
+    std::unique_ptr<MHWRender::MVertexBuffer> positionBuffer;
+    std::unique_ptr<MHWRender::MVertexBuffer> colorBuffer;
+    std::unique_ptr<MHWRender::MIndexBuffer> indexBuffer;
+  };
+
+  /// A pickable to be written into a batch this update.
+  struct Entry {
+    NodeKey key;
+    const PickableData* data;
+    bool changed;
+  };
+
+private:
+  PickableBatchOverride(const MObject& obj);
+
+  /// Find or create the batch for a camera and material state.
+  Batch& findBatch(MHWRender::MSubSceneContainer& container,
+                   const NodeKey& camera, bool transparent);
+
+  /// Write pickables into a batch, rebuilding it if its layout changed.
+  /// \return True if the buffers need to be reallocated.
+  bool fill(Batch& batch, const std::vector<Entry>& entries);
+
+  /// Upload a batch to the GPU.
+  void upload(Batch& batch, bool reallocate);
+
+private:
+  std::unordered_map<NodeKey, PickableData, NodeKeyHash> m_pickables;
+  std::vector<std::unique_ptr<Batch>> m_batches;
+  std::vector<Entry> m_opaque;       // Reused by update
+  std::vector<Entry> m_transparent;  // Reused by update
+  MHWRender::MShaderInstance* m_opaqueShader;
+  MHWRender::MShaderInstance* m_transparentShader;
+};
+
+}
+
+#endif // SCREENSPACE_PICKABLEBATCHOVERRIDE_HH
@@ -0,0 +1,281 @@
+#include "PickableData.hh"
+
+#include "ss/CameraContext.hh"
+#include "ss/Hash.hh"
+#include "ss/Log.hh"
+#include "ss/Platform.hh"
+#include "ss/Settings.hh"
+#include "ss/core/Layout.hh"
+#include "ss/core/Prepare.hh"
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MTransformationMatrix.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace screenspace {
+
+#ifdef SS_VERIFY_LAYOUT
+/// Find intersection point on a plane.
+/// \param ray The normalized ray direction.
+/// \param origin The origin of the ray.
+/// \param normal The normal of the plane.
+/// \param coord Some point on the plane
+/// \param contact The intersection point in worldspace.
+/// \return If an intersection occurred.
+static bool linePlaneIntersection(const MVector& ray, const MVector& origin,
+                                  const MVector& normal, const MPoint& coord,
+                                  MPoint& contact) {
+  if (normal * ray == 0)
+    return false;
+  const float dot = normal * coord;
+  const float scalar = (dot - (normal * origin)) / (normal * ray);
+  contact = origin + ray * scalar;
+  return true;
+}
+
+/// Original unit-to-world matrix chain, kept to cross-check
+/// solvePlacement.
+/// \param camera Shared camera context.
+/// \param attributes Pickable attribute snapshot.
+/// \return The unit-to-world matrix.
+static MMatrix legacyWorldMatrix(const CameraContext& camera,
+                                 const PickableAttributes& attributes)
+{
+  // Draw depth
+  const int depth = attributes.depth;
+
+  // Compute viewport data
+  const MPoint nearBL = camera.viewportToWorld(0, 0, depth);
+  const MPoint nearTR = camera.viewportToWorld(camera.width, camera.height, depth);
+  float hyp = float((nearTR - nearBL).length());
+  float worldspaceWidth = camera.diagonalCos * hyp;
+  float worldspaceHeight = camera.diagonalSin * hyp;
+
+  // Populate viewport
+  Viewport viewport;
+  viewport.width = camera.width;
+  viewport.height = camera.height;
+  viewport.worldspaceWidth = worldspaceWidth;
+  viewport.worldspaceHeight = worldspaceHeight;
+
+  // Viewport scale factor
+  float worldspaceUnitX, worldspaceUnitY;
+  float viewportUnitX, viewportUnitY;
+  switch (attributes.position)
+  {
+    case Position::Relative:
+      worldspaceUnitX = viewport.worldspaceWidth / 100.0f;
+      worldspaceUnitY = viewport.worldspaceHeight / 100.0f;
+      viewportUnitX = viewport.width / 100.0f;
+      viewportUnitY = viewport.height / 100.0f;
+      break;
+    case Position::Absolute:
+    default:
+      worldspaceUnitX = viewport.worldspaceWidth / viewport.width;
+      worldspaceUnitY = viewport.worldspaceHeight / viewport.height;
+      viewportUnitX = 1.0f;
+      viewportUnitY = 1.0f;
+      break;
+  }
+
+  float alignOffsetX;
+  switch (attributes.horizontalAlign)
+  {
+    case HorizontalAlign::Left:
+    default:
+      alignOffsetX = 0.0f;
+      break;
+    case HorizontalAlign::Middle:
+      alignOffsetX = viewport.width / 2.0f;
+      break;
+    case HorizontalAlign::Right:
+      alignOffsetX = viewport.width;
+      break;
+  }
+
+  float alignOffsetY;
+  switch (attributes.verticalAlign)
+  {
+    case VerticalAlign::Bottom:
+    default:
+      alignOffsetY = 0.0f;
+      break;
+    case VerticalAlign::Middle:
+      alignOffsetY = viewport.height / 2.0f;
+      break;
+    case VerticalAlign::Top:
+      alignOffsetY = viewport.height;
+      break;
+  }
+
+  // Fetch geometry
+  const float size = attributes.size;
+  const float width = attributes.width;
+  const float height = attributes.height;
+
+  // Fetch offset
+  const float viewportOffsetX = attributes.offsetX;
+  const float viewportOffsetY = attributes.offsetY;
+  MPoint viewportOffset = camera.viewportToWorld((alignOffsetX + viewportOffsetX) * viewportUnitX,
+                                                 (alignOffsetY + viewportOffsetY) * viewportUnitY,
+                                                 depth);
+
+  // Compute offset
+  const MPoint& rayOrigin = camera.eye;
+  MVector ray = viewportOffset - rayOrigin;
+  ray.normalize();
+  MPoint origin;
+  linePlaneIntersection(ray, rayOrigin, camera.normal, nearBL, origin);
+
+  // Offset rotation
+  MTransformationMatrix xformOffsetRotate;
+  xformOffsetRotate.setToRotationAxis(MVector(0,0,1), attributes.rotate);
+
+  // Prepare matrices
+  MMatrix pivotMatrix;
+  MMatrix screenspaceTranslateMatrix;
+  MMatrix screenspaceRotateMatrix;
+  MMatrix screenspaceScaleMatrix;
+
+  // Pivot
+  {
+    MTransformationMatrix xform(MMatrix::identity);
+    xform.setTranslation(MPoint(0.5, 0.5, 0.0, 1.0), MSpace::kWorld);
+    pivotMatrix = xform.asMatrix();
+  }
+  // Translate
+  {
+    MTransformationMatrix xform(MMatrix::identity);
+    xform.setTranslation(origin, MSpace::kWorld);
+    screenspaceTranslateMatrix = xform.asMatrix();
+  }
+
+  // Rotate
+  screenspaceRotateMatrix = xformOffsetRotate.asMatrix() * camera.rotation;
+
+  // Scale
+  {
+    MTransformationMatrix xform(MMatrix::identity);
+    const double scale[3] = {size * width * worldspaceUnitX,
+                             size * height * worldspaceUnitY, 1.0};
+    xform.setScale(scale, MSpace::kWorld);
+    screenspaceScaleMatrix = xform.asMatrix();
+  }
+
+  return pivotMatrix * screenspaceScaleMatrix * screenspaceRotateMatrix * screenspaceTranslateMatrix;
+}
+#endif
+
+MMatrix PickableData::worldMatrix() const
+{
+  const Mat4 world = placementMatrix(m_placement);
+  MMatrix matrix;
+  for (unsigned int row = 0; row < 4; ++row)
+    for (unsigned int column = 0; column < 4; ++column)
+      matrix(row, column) = world.m[row][column];
+  return matrix;
+}
+
+/// Inputs of a pickable node in the Maya scene, drawn with a camera.
+class PickableSource {
+public:
+  using GeometryRef = screenspace::GeometryRef;
+  using Vertices = MPointArray;
+
+  PickableSource(const MDagPath& pickablePath, const CameraContext& camera,
+                 const PickableShape& pickable)
+      : m_path(pickablePath),
+        m_camera(camera),
+        m_versions(pickable.versions()) {}
+
+  inline unsigned int layoutVersion() const {return m_versions.layout;}
+  inline unsigned int styleVersion() const {return m_versions.style;}
+  inline std::size_t cameraKey() const {return m_camera.key;}
+  inline std::size_t transformKey() const {return hashMatrix(0, m_path.inclusiveMatrix());}
+  inline const CameraBasis& camera() const {return m_camera.basis;}
+  inline float circleTolerance() const {return settings().circleTolerance;}
+
+  inline void readAttributes(PickableAttributes& attributes) const
+  {
+    CHECK_MSTATUS(PickableShape::readAttributes(m_path.node(), attributes));
+  }
+
+  inline GeometryRef unitGeometry(Shape shape, std::size_t lod) const
+  {
+    return screenspace::unitGeometry(shape, lod);
+  }
+
+  inline GeometryRef parametricGeometry(const ShapeKey& key) const
+  {
+    return screenspace::parametricGeometry(key);
+  }
+
+  inline OutlineState outlineGeometry(std::uint64_t key, GeometryRef* geometry) const
+  {
+    return screenspace::outlineGeometry(key, geometry);
+  }
+
+  /// Cross-check a solved placement against the original matrix chain
+  /// when built with SS_VERIFY_LAYOUT.
+  /// \param data Pickable data with its placement solved.
+  /// \param viewport Viewport the placement was solved for.
+  void verifyPlacement(const PickableData& data, const Viewport& viewport) const
+  {
+#ifdef SS_VERIFY_LAYOUT
+    // Tolerance is relative to the size of the viewport on the near plane
+    const MMatrix legacy = legacyWorldMatrix(m_camera, data.m_attributes);
+    const double tolerance = 1e-4 * std::max(1.0f, viewport.worldspaceWidth);
+    if (!data.worldMatrix().isEquivalent(legacy, tolerance))
+    {
+      SS_WARN << "Layout mismatch for " << m_path.fullPathName().asChar();
+    }
+#endif
+  }
+
+  /// Place unit geometry in pickable space.
+  /// \param data Prepared pickable data.
+  /// \param vertices Will be grown if needed and have its first points
+  /// set to the geometry vertices.
+  void prepareVertices(const PickableData& data, MPointArray& vertices) const
+  {
+    // Bring the placement into pickable space
+    const Placement& placement = data.placement();
+    const MMatrix inverse = m_path.inclusiveMatrixInverse();
+    const MPoint origin = MPoint(placement.origin[0], placement.origin[1], placement.origin[2]) * inverse;
+    const MVector axisX = MVector(placement.axisX[0], placement.axisX[1], placement.axisX[2]) * inverse;
+    const MVector axisY = MVector(placement.axisY[0], placement.axisY[1], placement.axisY[2]) * inverse;
+
+    // Only grown, a smaller level of detail leaves stale points past
+    // the ones its indices reach instead of reallocating
+    const Geometry& geometry = data.geometry();
+    const unsigned int count = geometry.points.length();
+    if (vertices.length() < count)
+      vertices.setLength(count);
+    for (unsigned int i = 0; i < count; ++i)
+      vertices[i] = origin + axisX * geometry.pointsX[i] + axisY * geometry.pointsY[i];
+  }
+
+private:
+  const MDagPath& m_path;
+  const CameraContext& m_camera;
+  PickableVersions m_versions;
+};
+
+PrepareResult preparePickable(const MDagPath& pickablePath,
+                              const CameraContext& camera,
+                              PickableData& data,
+                              MPointArray* vertices)
+{
+  // Function sets allocate, so the node is only looked up once
+  if (!data.m_node)
+  {
+    const MFnDependencyNode pickableDep(pickablePath.node());
+    data.m_node = static_cast<const PickableShape*>(pickableDep.userNode());
+  }
+  PickableSource source(pickablePath, camera, *data.m_node);
+  return prepareStages(source, data, vertices);
+}
+
+}
@@ -0,0 +1,95 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SCREENSPACE_PICKABLEDATA_HH
+#define SCREENSPACE_PICKABLEDATA_HH
+
+#include "ss/CameraContext.hh"
+#include "ss/core/Layout.hh"
+#include "ss/core/Prepare.hh"
+#include "ss/core/Stages.hh"
+#include "ss/PickableShape.hh"
+#include "ss/Types.hh"
+#include "ss/UnitGeometry.hh"
+
+#include <maya/MColor.h>
+#include <maya/MDagPath.h>
+#include <maya/MMatrix.h>
+#include <maya/MPointArray.h>
+
+#include <cstddef>
+
+namespace screenspace {
+
+/// Everything needed to draw one pickable, along with the inputs it
+/// was prepared from so unchanged stages can be skipped.
+///
+/// Kept small because tens of thousands stay alive per viewport. The
+/// placement is the only per-pickable geometry, matrices and vertices
+/// are derived from it and the shared unit geometry on demand. Color
+/// is uniform and normals are implicit, both come from the attributes.
+class PickableData {
+public:
+  PickableData()
+      : m_attributes(),
+        m_placement(),
+        m_geometry(unitGeometry(Shape::Circle)),
+        m_node(nullptr),
+        m_inputs{0, 0, 0, 0, 0, 0},
+        m_visibility(Visibility::Visible),
+        m_prepared(false),
+        m_pending(false) {}
+
+public:
+  inline const Placement& placement() const {return m_placement;}
+  inline const Geometry& geometry() const {return *m_geometry;}
+  inline Shape shape() const {return m_attributes.shape;}
+  inline const MColor& color() const {return m_attributes.color;}
+  inline bool visible() const {return m_visibility == Visibility::Visible;}
+
+  /// Unit shape to worldspace.
+  /// \return The matrix.
+  MMatrix worldMatrix() const;
+
+public:
+  PickableAttributes m_attributes;  // Attribute snapshot, holds shape and color
+  Placement m_placement;            // Unit shape to worldspace
+  GeometryRef m_geometry;           // Shared unit geometry
+  const PickableShape* m_node;      // Resolved on the first prepare
+  StageInputs m_inputs;             // Inputs of the previous prepare
+  Visibility m_visibility;          // Result of the cull stage
+  bool m_prepared;                  // Whether geometry and placement are current
+  bool m_pending;                   // Drawing a placeholder until the custom outline is ready
+};
+
+/// Bring cached pickable data up to date for a camera, running
+/// prepareStages with the pickable node as its source.
+/// \param pickablePath Path to pickable.
+/// \param camera Context of the camera being drawn, looked up once per
+/// draw pass.
+/// \param data Cached data to update.
+/// \param vertices If given, its first points are kept up to date with
+/// the geometry vertices in pickable space. It only ever grows, so
+/// points past the geometry are stale and must not be indexed. Render
+/// paths that place unit geometry with a matrix don't need them.
+/// \return The stages that were rerun.
+PrepareResult preparePickable(const MDagPath& pickablePath,
+                              const CameraContext& camera,
+                              PickableData& data,
+                              MPointArray* vertices = nullptr);
+
+}
+
+#endif // SCREENSPACE_PICKABLEDATA_HH
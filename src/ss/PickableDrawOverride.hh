@@ -16,6 +16,7 @@
 #define SAMPLEPLUGIN_PICKABLEDRAWOVERRIDE_HH
 
 #include <maya/MPxDrawOverride.h>
+#include <maya/MTypes.h>
 
 namespace screenspace {
 
@@ -31,6 +32,8 @@ public:
 
 public:
   MHWRender::DrawAPI supportedDrawAPIs() const override;
+  bool isBounded(const MDagPath& objPath, const MDagPath& cameraPath) const override {return true;}
+  MBoundingBox boundingBox(const MDagPath& objPath, const MDagPath& cameraPath) const override;
   MUserData* prepareForDraw(const MDagPath& pickableDag,
                             const MDagPath& cameraDag,
                             const MHWRender::MFrameContext& frameContext,
@@ -41,6 +44,17 @@ public:
                       const MHWRender::MFrameContext& frameContext,
                       const MUserData* data) override;
 
+#if MAYA_API_VERSION >= 20190000
+  /// Resolve clicks and marquee drags from the screen index rather
+  /// than by drawing every pickable into the selection buffer. Older
+  /// versions select the triangles drawn in addUIDrawables.
+  bool wantUserSelection() const override {return true;}
+  bool userSelect(MHWRender::MSelectionInfo& selectInfo,
+                  const MHWRender::MDrawContext& context,
+                  MPoint& hitPoint,
+                  const MUserData* data) override;
+#endif
+
 private:
 
   /// Check if the pickable is attached to this camera.
@@ -50,7 +64,9 @@ private:
   bool isAttachedCamera(const MDagPath& pickable, const MDagPath& camera) const;
 
 private:
-  PickableDrawOverride(const MObject& obj) : MPxDrawOverride(obj, nullptr) {}
+  PickableDrawOverride(const MObject& obj) : MPxDrawOverride(obj, nullptr), m_pickable(obj) {}
+
+  MObject m_pickable;
 };
 
 }
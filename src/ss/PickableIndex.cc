@@ -0,0 +1,154 @@
+#include "PickableIndex.hh"
+
+#include "ss/CameraRegistry.hh"
+#include "ss/PickableShape.hh"
+#include "ss/core/Groups.hh"
+#include "ss/core/Trace.hh"
+
+#include <maya/MDagPath.h>
+#include <maya/MFnDependencyNode.h>
+
+namespace screenspace {
+
+PickableIndex& PickableIndex::instance()
+{
+  static PickableIndex index;
+  return index;
+}
+
+PickableIndex::PickableIndex()
+    : m_mutex(),
+      m_cameras(),
+      m_ids(),
+      m_selectionCamera(),
+      m_selectionFrame(0),
+      m_selectionRect{0.0f, 0.0f, 0.0f, 0.0f},
+      m_selectionSingle(false),
+      m_selected()
+{}
+
+const PickableIndex::CameraIndex& PickableIndex::update(const MObject& camera, int width, int height)
+{
+  // New indices start with zero versions, which are never current
+  CameraIndex& cameraIndex = m_cameras[NodeKey(camera)];
+  const unsigned int registryVersion = CameraRegistry::instance().version();
+  const unsigned int changes = PickableShape::changes();
+  const unsigned int groupsVersion = Groups::instance().version();
+  if (cameraIndex.registryVersion == registryVersion &&
+      cameraIndex.changes == changes &&
+      cameraIndex.groupsVersion == groupsVersion &&
+      cameraIndex.index.width() == width &&
+      cameraIndex.index.height() == height)
+    return cameraIndex;
+
+  ScopedTrace trace("PickableIndex.update");
+  cameraIndex.index.reset(width, height);
+  cameraIndex.handles.clear();
+  CameraRegistry::instance().forEachPickable(camera, [&](const MObject& node) {
+    const PickableShape* pickable = static_cast<const PickableShape*>(MFnDependencyNode(node).userNode());
+    PickableAttributes attributes;
+    if (!pickable || !pickable->cachedAttributes(attributes))
+      return;
+    if (!attributes.show || attributes.color.a <= 0.0f ||
+        Groups::instance().hidden(attributes.group))
+      return;
+
+    ScreenEntry entry;
+    entry.id = cameraIndex.handles.size();
+    entry.placement = screenPlacement(attributes, width, height);
+    entry.shape = attributes.shape;
+    entry.parameters = attributes.parameters;
+    entry.outline = attributes.outline;
+    entry.depth = attributes.depth;
+    cameraIndex.handles.push_back(MObjectHandle(node));
+    cameraIndex.index.add(entry);
+  });
+  cameraIndex.index.build();
+
+  cameraIndex.registryVersion = registryVersion;
+  cameraIndex.changes = changes;
+  cameraIndex.groupsVersion = groupsVersion;
+  return cameraIndex;
+}
+
+void PickableIndex::collect(const CameraIndex& cameraIndex, const std::vector<std::uint64_t>& ids,
+                            MObjectArray& pickables, unsigned int limit) const
+{
+  // Hiding a parent transform doesn't dirty the pickable, so DAG
+  // visibility is checked on the few hits instead
+  for (std::uint64_t id : ids)
+  {
+    if (pickables.length() >= limit)
+      break;
+    const MObjectHandle& handle = cameraIndex.handles[id];
+    MDagPath pickablePath;
+    if (!handle.isAlive() || !MDagPath::getAPathTo(handle.object(), pickablePath) ||
+        !pickablePath.isVisible())
+      continue;
+    pickables.append(handle.object());
+  }
+}
+
+void PickableIndex::findAt(const MObject& camera, int width, int height,
+                           float x, float y, MObjectArray& pickables)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  pickables.clear();
+  const CameraIndex& cameraIndex = update(camera, width, height);
+  cameraIndex.index.findAt(x, y, m_ids);
+  collect(cameraIndex, m_ids, pickables, ~0u);
+}
+
+void PickableIndex::findInRect(const MObject& camera, int width, int height,
+                               const ScreenRect& rect, MObjectArray& pickables)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  pickables.clear();
+  const CameraIndex& cameraIndex = update(camera, width, height);
+  cameraIndex.index.findInRect(rect, m_ids);
+  collect(cameraIndex, m_ids, pickables, ~0u);
+}
+
+bool PickableIndex::selects(const MObject& camera, int width, int height,
+                            unsigned long long frame, const ScreenRect& rect,
+                            bool single, const MObject& pickable)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const NodeKey cameraKey(camera);
+  if (cameraKey != m_selectionCamera || frame != m_selectionFrame || single != m_selectionSingle ||
+      rect.minX != m_selectionRect.minX || rect.minY != m_selectionRect.minY ||
+      rect.maxX != m_selectionRect.maxX || rect.maxY != m_selectionRect.maxY)
+  {
+    m_selectionCamera = cameraKey;
+    m_selectionFrame = frame;
+    m_selectionRect = rect;
+    m_selectionSingle = single;
+    m_selected.clear();
+
+    const CameraIndex& cameraIndex = update(camera, width, height);
+    MObjectArray picked;
+    if (single)
+    {
+      cameraIndex.index.findAt(0.5f * (rect.minX + rect.maxX), 0.5f * (rect.minY + rect.maxY), m_ids);
+      collect(cameraIndex, m_ids, picked, 1);
+    }
+    if (picked.length() == 0)
+    {
+      cameraIndex.index.findInRect(rect, m_ids);
+      collect(cameraIndex, m_ids, picked, single ? 1 : ~0u);
+    }
+    for (unsigned int i = 0; i < picked.length(); ++i)
+      m_selected.insert(NodeKey(picked[i]));
+  }
+  return m_selected.count(NodeKey(pickable)) > 0;
+}
+
+void PickableIndex::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_cameras.clear();
+  m_selectionCamera = NodeKey();
+  m_selected.clear();
+}
+
+}
@@ -0,0 +1,125 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_PICKABLEINDEX_HH
+#define SCREENSPACE_PICKABLEINDEX_HH
+
+#include "ss/Hash.hh"
+#include "ss/core/Layout.hh"
+#include "ss/core/ScreenIndex.hh"
+
+#include <maya/MObject.h>
+#include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace screenspace {
+
+/// Where the pickables of each camera sit on screen, for resolving
+/// clicks, marquee drags and the picking commands without testing or
+/// drawing every pickable.
+///
+/// Pickables are glued to the viewport, so camera moves never touch
+/// the index. It is rebuilt lazily on the next query after any
+/// pickable, attachment or hidden group changes, from attribute
+/// snapshots the pickables already keep.
+class PickableIndex {
+public:
+  static PickableIndex& instance();
+
+public:
+  /// Find the pickables of a camera under a pixel.
+  /// \param camera The camera shape node.
+  /// \param width Width of viewport in pixels.
+  /// \param height Height of viewport in pixels.
+  /// \param x Pixels from the left of the viewport.
+  /// \param y Pixels from the bottom of the viewport.
+  /// \param pickables Will be populated with the visible pickables,
+  /// the one on top first.
+  void findAt(const MObject& camera, int width, int height,
+              float x, float y, MObjectArray& pickables);
+
+  /// Find the pickables of a camera touching a rectangle.
+  /// \param camera The camera shape node.
+  /// \param width Width of viewport in pixels.
+  /// \param height Height of viewport in pixels.
+  /// \param rect The rectangle in pixels.
+  /// \param pickables Will be populated with the visible pickables,
+  /// the one on top first.
+  void findInRect(const MObject& camera, int width, int height,
+                  const ScreenRect& rect, MObjectArray& pickables);
+
+  /// Check if a viewport selection picks a pickable. Maya asks every
+  /// pickable in turn about the same selection, so the index is only
+  /// queried for the first and the hits are remembered.
+  /// \param camera The camera shape node.
+  /// \param width Width of viewport in pixels.
+  /// \param height Height of viewport in pixels.
+  /// \param frame Frame stamp of the selection pass.
+  /// \param rect Selection rectangle in pixels.
+  /// \param single Whether a click, only picking the pickable on top
+  /// under its center, or else on top anywhere in the rectangle.
+  /// \param pickable The pickable node.
+  /// \return True if picked.
+  bool selects(const MObject& camera, int width, int height,
+               unsigned long long frame, const ScreenRect& rect,
+               bool single, const MObject& pickable);
+
+  /// Forget every index.
+  void clear();
+
+private:
+  PickableIndex();
+
+  struct CameraIndex {
+    ScreenIndex index;
+    std::vector<MObjectHandle> handles;  // Pickable of each entry id
+    unsigned int registryVersion;        // Attachments indexed
+    unsigned int changes;                // Pickable changes indexed
+    unsigned int groupsVersion;          // Hidden groups indexed
+  };
+
+  /// Bring the index of a camera up to date, m_mutex must be held.
+  /// \return The index.
+  const CameraIndex& update(const MObject& camera, int width, int height);
+
+  /// Turn hits into visible pickables.
+  /// \param cameraIndex The index the hits came from.
+  /// \param ids The hits.
+  /// \param pickables Will be appended to.
+  /// \param limit Most pickables to append.
+  void collect(const CameraIndex& cameraIndex, const std::vector<std::uint64_t>& ids,
+               MObjectArray& pickables, unsigned int limit) const;
+
+private:
+  std::mutex m_mutex;
+  std::unordered_map<NodeKey, CameraIndex, NodeKeyHash> m_cameras;  // By camera node
+  std::vector<std::uint64_t> m_ids;                         // Hits of the last query
+
+  // Last viewport selection and the pickables it picked
+  NodeKey m_selectionCamera;
+  unsigned long long m_selectionFrame;
+  ScreenRect m_selectionRect;
+  bool m_selectionSingle;
+  std::unordered_set<NodeKey, NodeKeyHash> m_selected;
+};
+
+}
+
+#endif // SCREENSPACE_PICKABLEINDEX_HH
@@ -0,0 +1,266 @@
+#include "PickableInstanceOverride.hh"
+
+#include "ss/CameraContext.hh"
+#include "ss/CameraRegistry.hh"
+#include "ss/Log.hh"
+#include "ss/core/Stats.hh"
+
+#include <maya/MDagPath.h>
+#include <maya/MViewport2Renderer.h>
+
+namespace screenspace {
+
+MString PickableInstanceOverride::classification = "drawdb/subscene/ss/pickableInstance";
+MString PickableInstanceOverride::id = "pickableInstance";
+
+MHWRender::MPxSubSceneOverride* PickableInstanceOverride::creator(const MObject& obj)
+{
+  return new PickableInstanceOverride(obj);
+}
+
+PickableInstanceOverride::PickableInstanceOverride(const MObject& obj)
+    : MPxSubSceneOverride(obj),
+      m_pickables(),
+      m_groups(),
+      m_buckets(),
+      m_opaqueShader(nullptr),
+      m_transparentShader(nullptr),
+      m_nextItem(0),
+      m_updates(0)
+{
+  MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer();
+  const MHWRender::MShaderManager* shaderManager = renderer ? renderer->getShaderManager() : nullptr;
+  if (!shaderManager)
+    return;
+
+  // Color comes from per-instance solidColor data
+  m_opaqueShader = shaderManager->getStockShader(MHWRender::MShaderManager::k3dSolidShader);
+  m_transparentShader = shaderManager->getStockShader(MHWRender::MShaderManager::k3dSolidShader);
+  if (m_transparentShader)
+    m_transparentShader->setIsTransparent(true);
+}
+
+PickableInstanceOverride::~PickableInstanceOverride()
+{
+  MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer(false);
+  const MHWRender::MShaderManager* shaderManager = renderer ? renderer->getShaderManager() : nullptr;
+  if (!shaderManager)
+    return;
+
+  if (m_opaqueShader)
+    shaderManager->releaseShader(m_opaqueShader);
+  if (m_transparentShader)
+    shaderManager->releaseShader(m_transparentShader);
+}
+
+MHWRender::DrawAPI PickableInstanceOverride::supportedDrawAPIs() const {
+  return MHWRender::kAllDevices;
+}
+
+bool PickableInstanceOverride::requiresUpdate(const MHWRender::MSubSceneContainer& container,
+                                              const MHWRender::MFrameContext& frameContext) const
+{
+  // Placement depends on the camera, unchanged pickables are skipped
+  // cheaply in update.
+  return true;
+}
+
+void PickableInstanceOverride::update(MHWRender::MSubSceneContainer& container,
+                                      const MHWRender::MFrameContext& frameContext)
+{
+  const MDagPath cameraPath = frameContext.getCurrentCameraPath();
+  const NodeKey cameraNode(cameraPath.node());
+  const unsigned int cameraKey = cameraNode.hash;
+  const CameraContext& camera = findCameraContext(cameraPath, frameContext);
+
+  ++m_updates;
+
+  // Forget deleted pickables before a new node can take their key,
+  // their data points at the deleted node
+  for (auto iter = m_pickables.begin(); iter != m_pickables.end();)
+  {
+    if (iter->first.handle.isAlive())
+      ++iter;
+    else
+      iter = m_pickables.erase(iter);
+  }
+
+  // Prepare pickables of this camera, sorted by geometry and material
+  for (Bucket& bucket : m_buckets)
+  {
+    bucket.opaque.clear();
+    bucket.transparent.clear();
+  }
+  std::size_t last = 0;
+  CameraRegistry::instance().forEachPickable(cameraPath.node(), [&](const MObject& node) {
+    MDagPath pickablePath;
+    if (!MDagPath::getAPathTo(node, pickablePath) || !pickablePath.isVisible())
+    {
+      countPickable(cameraKey, Outcome::Culled);
+      return;
+    }
+
+    const NodeKey key(node);
+    PickableData& data = m_pickables[key];
+
+    const PrepareResult result = preparePickable(pickablePath, camera, data);
+    if (result.culled)
+    {
+      countPickable(cameraKey, Outcome::Culled);
+      return;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.data = &data;
+    entry.changed = result.style || result.matrix;
+    countPickable(cameraKey, entry.changed ? Outcome::Drawn : Outcome::CacheHit);
+
+    // Neighbours mostly share geometry, and distinct geometries are few
+    const std::size_t index = data.geometry().index;
+    if (last >= m_buckets.size() || m_buckets[last].geometry != index)
+    {
+      last = 0;
+      while (last < m_buckets.size() && m_buckets[last].geometry != index)
+        ++last;
+      if (last == m_buckets.size())
+      {
+        m_buckets.emplace_back();
+        m_buckets.back().geometry = index;
+      }
+    }
+    if (data.color().a < 1.0f)
+      m_buckets[last].transparent.push_back(entry);
+    else
+      m_buckets[last].opaque.push_back(entry);
+  });
+
+  for (const Bucket& bucket : m_buckets)
+  {
+    for (bool isTransparent : {false, true})
+    {
+      // Geometry nothing is drawn with gets no item
+      const std::vector<Entry>& entries = isTransparent ? bucket.transparent : bucket.opaque;
+      if (entries.empty())
+        continue;
+      Group& group = findGroup(container, cameraNode, entries.front().data->geometry(), isTransparent);
+      group.drawn = m_updates;
+      if (!fill(group, entries))
+        continue;
+      CHECK_MSTATUS(setInstanceTransformArray(*group.item, group.transforms));
+      CHECK_MSTATUS(setExtraInstanceData(*group.item, "solidColor", group.colors));
+    }
+  }
+
+  // Only draw groups of this camera, and remove those it no longer
+  // draws anything with or whose camera was deleted
+  for (auto iter = m_groups.begin(); iter != m_groups.end();)
+  {
+    Group& group = **iter;
+    const bool current = group.camera == cameraNode;
+    if ((current && group.drawn != m_updates) || !group.camera.handle.isAlive())
+    {
+      container.remove(group.item->name());
+      iter = m_groups.erase(iter);
+      continue;
+    }
+    group.item->enable(current);
+    ++iter;
+  }
+
+  // Forget geometry no group draws with
+  for (auto iter = m_buckets.begin(); iter != m_buckets.end();)
+  {
+    bool used = false;
+    for (const std::unique_ptr<Group>& group : m_groups)
+      used = used || group->geometry == iter->geometry;
+    if (used)
+      ++iter;
+    else
+      iter = m_buckets.erase(iter);
+  }
+}
+
+PickableInstanceOverride::Group* PickableInstanceOverride::lookupGroup(const NodeKey& camera,
+                                                                       std::size_t geometry,
+                                                                       bool transparent) const
+{
+  for (const std::unique_ptr<Group>& group : m_groups)
+    if (group->camera == camera && group->geometry == geometry && group->transparent == transparent)
+      return group.get();
+  return nullptr;
+}
+
+PickableInstanceOverride::Group& PickableInstanceOverride::findGroup(MHWRender::MSubSceneContainer& container,
+                                                                     const NodeKey& camera,
+                                                                     const Geometry& geometry,
+                                                                     bool transparent)
+{
+  if (Group* group = lookupGroup(camera, geometry.index, transparent))
+    return *group;
+
+  MString name = "screenspaceInstance_";
+  name += m_nextItem++;
+  name += "_";
+  name += static_cast<unsigned int>(geometry.index);
+  name += transparent ? "_transparent" : "_opaque";
+
+  MHWRender::MRenderItem* item = MHWRender::MRenderItem::Create(
+      name, MHWRender::MRenderItem::NonMaterialSceneItem, MHWRender::MGeometry::kTriangles);
+  item->setDrawMode(MHWRender::MGeometry::kAll);
+  item->castsShadows(false);
+  item->receivesShadows(false);
+  item->setShader(transparent ? m_transparentShader : m_opaqueShader);
+  container.add(item);
+
+  std::unique_ptr<Group> group(new Group());
+  group->camera = camera;
+  group->geometry = geometry.index;
+  group->transparent = transparent;
+  group->drawn = m_updates;
+  group->item = item;
+  group->buffers = geometryBuffers(geometry);
+
+  MHWRender::MVertexBufferArray buffers;
+  buffers.addBuffer("positions", group->buffers->positionBuffer.get());
+  CHECK_MSTATUS(setGeometryForRenderItem(*item, buffers, *group->buffers->indexBuffer, &geometry.bounds));
+  m_groups.push_back(std::move(group));
+  return *m_groups.back();
+}
+
+bool PickableInstanceOverride::fill(Group& group, const std::vector<Entry>& entries)
+{
+  // Same pickables in the same order only need their changed
+  // instances rewritten.
+  bool sameLayout = group.keys.size() == entries.size();
+  for (std::size_t i = 0; sameLayout && i < entries.size(); ++i)
+    sameLayout = group.keys[i] == entries[i].key;
+
+  if (!sameLayout)
+  {
+    const unsigned int count = static_cast<unsigned int>(entries.size());
+    group.keys.resize(entries.size());
+    group.transforms.setLength(count);
+    group.colors.setLength(count * 4);
+  }
+
+  bool changed = !sameLayout;
+  for (std::size_t i = 0; i < entries.size(); ++i)
+  {
+    if (sameLayout && !entries[i].changed)
+      continue;
+
+    const unsigned int index = static_cast<unsigned int>(i);
+    const MColor& color = entries[i].data->color();
+    group.keys[i] = entries[i].key;
+    group.transforms[index] = entries[i].data->worldMatrix();
+    group.colors[index * 4] = color.r;
+    group.colors[index * 4 + 1] = color.g;
+    group.colors[index * 4 + 2] = color.b;
+    group.colors[index * 4 + 3] = color.a;
+    changed = true;
+  }
+  return changed;
+}
+
+}
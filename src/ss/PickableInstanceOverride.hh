@@ -0,0 +1,115 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_PICKABLEINSTANCEOVERRIDE_HH
+#define SCREENSPACE_PICKABLEINSTANCEOVERRIDE_HH
+
+#include "ss/GeometryBuffers.hh"
+#include "ss/Hash.hh"
+#include "ss/PickableData.hh"
+
+#include <maya/MFloatArray.h>
+#include <maya/MHWGeometry.h>
+#include <maya/MMatrixArray.h>
+#include <maya/MPxSubSceneOverride.h>
+#include <maya/MShaderManager.h>
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace screenspace {
+
+/// Draws all pickables attached to a camera with hardware instancing.
+/// Each unit geometry is uploaded once and shared by every camera and
+/// override drawing it, pickables are instances of it with their own
+/// transform and color. One render item per camera, geometry and
+/// material state, so every circle level of detail is its own item.
+class PickableInstanceOverride : public MHWRender::MPxSubSceneOverride
+{
+public:
+  static MString classification;
+  static MString id;
+  static MPxSubSceneOverride* creator(const MObject& obj);
+
+public:
+  ~PickableInstanceOverride() override;
+
+public:
+  MHWRender::DrawAPI supportedDrawAPIs() const override;
+  bool requiresUpdate(const MHWRender::MSubSceneContainer& container,
+                      const MHWRender::MFrameContext& frameContext) const override;
+  void update(MHWRender::MSubSceneContainer& container,
+              const MHWRender::MFrameContext& frameContext) override;
+
+private:
+  /// A pickable to be written into a group this update.
+  struct Entry {
+    NodeKey key;
+    const PickableData* data;
+    bool changed;
+  };
+
+  /// Pickables drawn with one geometry this update.
+  struct Bucket {
+    std::size_t geometry;                 // Geometry index
+    std::vector<Entry> opaque;
+    std::vector<Entry> transparent;
+  };
+
+  /// Instances of one geometry for a camera and material state.
+  /// Removed along with its item once the camera draws nothing with it.
+  struct Group {
+    NodeKey camera;                       // Camera node
+    std::size_t geometry;                 // Index of the instanced unit geometry
+    bool transparent;                     // Material state
+    unsigned int drawn;                   // Last update that filled it
+    MHWRender::MRenderItem* item;         // Owned by the container
+    std::vector<NodeKey> keys;            // Pickable node per instance
+    MMatrixArray transforms;              // Unit shape to worldspace
+    MFloatArray colors;                   // rgba per instance
+    std::shared_ptr<const GeometryBuffers> buffers;  // Shared with every override drawing the geometry
+  };
+
+private:
+  PickableInstanceOverride(const MObject& obj);
+
+  /// Find the group for a camera, geometry and material state.
+  /// \return Existing group, or nullptr if none was created yet
+  Group* lookupGroup(const NodeKey& camera, std::size_t geometry, bool transparent) const;
+
+  /// Find or create the group for a camera, geometry and material
+  /// state, pointing a new group's item at the geometry's buffers.
+  Group& findGroup(MHWRender::MSubSceneContainer& container,
+                   const NodeKey& camera, const Geometry& geometry, bool transparent);
+
+  /// Write instances into a group.
+  /// \return True if the instance arrays changed.
+  bool fill(Group& group, const std::vector<Entry>& entries);
+
+private:
+  std::unordered_map<NodeKey, PickableData, NodeKeyHash> m_pickables;
+  std::vector<std::unique_ptr<Group>> m_groups;
+  // Reused by update, dropped once no group draws their geometry
+  std::vector<Bucket> m_buckets;
+  MHWRender::MShaderInstance* m_opaqueShader;
+  MHWRender::MShaderInstance* m_transparentShader;
+  unsigned int m_nextItem;  // Suffix of the next render item name
+  unsigned int m_updates;   // Number of updates so far
+};
+
+}
+
+#endif // SCREENSPACE_PICKABLEINSTANCEOVERRIDE_HH
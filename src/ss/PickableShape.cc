@@ -1,13 +1,27 @@
 #include "PickableShape.hh"
 
+#include "ss/CameraContext.hh"
+#include "ss/CameraRegistry.hh"
 #include "ss/Log.hh"
+#include "ss/Platform.hh"
 #include "ss/Types.hh"
+#include "ss/core/Groups.hh"
+#include "ss/core/Outline.hh"
+#include "ss/core/Outlines.hh"
 
+#include <maya/MAngle.h>
 #include <maya/MFnEnumAttribute.h>
 #include <maya/MFnMessageAttribute.h>
 #include <maya/MFnNumericAttribute.h>
+#include <maya/MFnPointArrayData.h>
 #include <maya/MFnTypedAttribute.h>
 #include <maya/MFnUnitAttribute.h>
+#include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
+#include <maya/MPointArray.h>
+
+#include <string>
+#include <vector>
 
 namespace screenspace {
 
@@ -16,6 +30,12 @@ MTypeId PickableShape::id(0x8701F);
 
 MObject PickableShape::m_camera;
 MObject PickableShape::m_shape;
+MObject PickableShape::m_cornerRadius;
+MObject PickableShape::m_innerRadius;
+MObject PickableShape::m_arcAngle;
+MObject PickableShape::m_sides;
+MObject PickableShape::m_path;
+MObject PickableShape::m_points;
 MObject PickableShape::m_color;
 MObject PickableShape::m_opacity;
 MObject PickableShape::m_size;
@@ -29,11 +49,47 @@ MObject PickableShape::m_rotate;
 MObject PickableShape::m_offsetX;
 MObject PickableShape::m_offsetY;
 MObject PickableShape::m_offset;
+MObject PickableShape::m_show;
+MObject PickableShape::m_group;
+
+/// Check if an attribute affects the shape, color or visibility of a
+/// pickable.
+/// \param attribute The attribute.
+/// \return True if a style attribute, else false.
+static bool isStyleAttribute(const MObject& attribute) {
+  return attribute == PickableShape::m_shape ||
+         attribute == PickableShape::m_cornerRadius ||
+         attribute == PickableShape::m_innerRadius ||
+         attribute == PickableShape::m_arcAngle ||
+         attribute == PickableShape::m_sides ||
+         attribute == PickableShape::m_path ||
+         attribute == PickableShape::m_points ||
+         attribute == PickableShape::m_color ||
+         attribute == PickableShape::m_opacity ||
+         attribute == PickableShape::m_show ||
+         attribute == PickableShape::m_group;
+}
+
+/// Counter behind PickableShape::changes.
+/// \return The counter.
+static std::atomic<unsigned int>& changeCounter() {
+  static std::atomic<unsigned int> counter(1);
+  return counter;
+}
 
 void* PickableShape::creator() {
   return new PickableShape();
 }
 
+PickableShape::PickableShape()
+    : MPxSurfaceShape(),
+      m_layoutVersion(1),
+      m_styleVersion(1),
+      m_cachedMutex(),
+      m_cachedAttributes(),
+      m_cachedVersions{0, 0}
+{}
+
 MStatus PickableShape::initialize() {
 
   MStatus status;
@@ -54,11 +110,65 @@ MStatus PickableShape::initialize() {
   CHECK_MSTATUS(eAttr.addField("Circle", static_cast<short>(Shape::Circle)));
   CHECK_MSTATUS(eAttr.addField("Rectangle", static_cast<short>(Shape::Rectangle)));
   CHECK_MSTATUS(eAttr.addField("Triangle", static_cast<short>(Shape::Triangle)));
+  CHECK_MSTATUS(eAttr.addField("Rounded Rectangle", static_cast<short>(Shape::RoundedRectangle)));
+  CHECK_MSTATUS(eAttr.addField("Ring", static_cast<short>(Shape::Ring)));
+  CHECK_MSTATUS(eAttr.addField("Polygon", static_cast<short>(Shape::Polygon)));
+  CHECK_MSTATUS(eAttr.addField("Capsule", static_cast<short>(Shape::Capsule)));
+  CHECK_MSTATUS(eAttr.addField("Custom", static_cast<short>(Shape::Custom)));
   CHECK_MSTATUS(eAttr.setKeyable(true));
   CHECK_MSTATUS(eAttr.setCached(true));
   CHECK_MSTATUS(eAttr.setStorable(true));
   CHECK_MSTATUS(eAttr.setWritable(true));
 
+  // Fraction of half the shorter side, 1 makes a capsule
+  m_cornerRadius = nAttr.create("cornerRadius", "crd", MFnNumericData::kFloat, 0.25, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(nAttr.setMin(0.0f));
+  CHECK_MSTATUS(nAttr.setMax(1.0f));
+  CHECK_MSTATUS(nAttr.setKeyable(true));
+  CHECK_MSTATUS(nAttr.setStorable(true));
+  CHECK_MSTATUS(nAttr.setWritable(true));
+  CHECK_MSTATUS(nAttr.setCached(true));
+
+  // Fraction of the outer radius, 0 makes a pie slice
+  m_innerRadius = nAttr.create("innerRadius", "inr", MFnNumericData::kFloat, 0.5, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(nAttr.setMin(0.0f));
+  CHECK_MSTATUS(nAttr.setMax(1.0f));
+  CHECK_MSTATUS(nAttr.setKeyable(true));
+  CHECK_MSTATUS(nAttr.setStorable(true));
+  CHECK_MSTATUS(nAttr.setWritable(true));
+  CHECK_MSTATUS(nAttr.setCached(true));
+
+  // Sweep of a ring, counterclockwise from the right
+  m_arcAngle = uAttr.create("arcAngle", "arca", MFnUnitAttribute::kAngle, 2.0 * M_PI, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(uAttr.setKeyable(true));
+  CHECK_MSTATUS(uAttr.setStorable(true));
+  CHECK_MSTATUS(uAttr.setWritable(true));
+  CHECK_MSTATUS(uAttr.setCached(true));
+
+  m_sides = nAttr.create("sides", "sds", MFnNumericData::kInt, 6, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(nAttr.setMin(3));
+  CHECK_MSTATUS(nAttr.setMax(64));
+  CHECK_MSTATUS(nAttr.setKeyable(true));
+  CHECK_MSTATUS(nAttr.setStorable(true));
+  CHECK_MSTATUS(nAttr.setWritable(true));
+  CHECK_MSTATUS(nAttr.setCached(true));
+
+  // Custom outline as SVG path data, takes precedence over the points
+  m_path = tAttr.create("path", "pth", MFnData::kString, MObject::kNullObj, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(tAttr.setStorable(true));
+  CHECK_MSTATUS(tAttr.setWritable(true));
+
+  // Custom outline as a closed polygon, only x and y are used
+  m_points = tAttr.create("points", "pts", MFnData::kPointArray, MObject::kNullObj, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(tAttr.setStorable(true));
+  CHECK_MSTATUS(tAttr.setWritable(true));
+
   m_color = nAttr.createColor("color", "clr", &status);
   CHECK_MSTATUS(status);
   CHECK_MSTATUS(nAttr.setDefault(1.0f, 1.0f, 1.0f));
@@ -158,8 +268,26 @@ MStatus PickableShape::initialize() {
   CHECK_MSTATUS(nAttr.setWritable(true));
   CHECK_MSTATUS(nAttr.setCached(true));
 
+  m_show = nAttr.create("show", "shw", MFnNumericData::kBoolean, true, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(nAttr.setKeyable(true));
+  CHECK_MSTATUS(nAttr.setStorable(true));
+  CHECK_MSTATUS(nAttr.setWritable(true));
+  CHECK_MSTATUS(nAttr.setCached(true));
+
+  m_group = tAttr.create("group", "grp", MFnData::kString, MObject::kNullObj, &status);
+  CHECK_MSTATUS(status);
+  CHECK_MSTATUS(tAttr.setStorable(true));
+  CHECK_MSTATUS(tAttr.setWritable(true));
+
   CHECK_MSTATUS(addAttribute(m_camera));
   CHECK_MSTATUS(addAttribute(m_shape));
+  CHECK_MSTATUS(addAttribute(m_cornerRadius));
+  CHECK_MSTATUS(addAttribute(m_innerRadius));
+  CHECK_MSTATUS(addAttribute(m_arcAngle));
+  CHECK_MSTATUS(addAttribute(m_sides));
+  CHECK_MSTATUS(addAttribute(m_path));
+  CHECK_MSTATUS(addAttribute(m_points));
   CHECK_MSTATUS(addAttribute(m_color));
   CHECK_MSTATUS(addAttribute(m_opacity));
   CHECK_MSTATUS(addAttribute(m_size));
@@ -171,10 +299,229 @@ MStatus PickableShape::initialize() {
   CHECK_MSTATUS(addAttribute(m_verticalAlign));
   CHECK_MSTATUS(addAttribute(m_rotate));
   CHECK_MSTATUS(addAttribute(m_offset));
+  CHECK_MSTATUS(addAttribute(m_show));
+  CHECK_MSTATUS(addAttribute(m_group));
+
+  return MStatus::kSuccess;
+}
+
+/// Read the custom outline of a pickable and queue it for
+/// triangulation.
+/// \param node The pickable node.
+/// \param key Will be set to the outline key, zero if it has none.
+/// \return Success if the outline was read.
+static MStatus readOutline(const MObject& node, std::uint64_t& key) {
+  MStatus status;
+
+  const MString path = MPlug(node, PickableShape::m_path).asString(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  std::vector<float> points;
+  if (path.length() == 0)
+  {
+    const MObject data = MPlug(node, PickableShape::m_points).asMObject(&status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    if (!data.isNull())
+    {
+      const MPointArray array = MFnPointArrayData(data).array();
+      points.reserve(array.length() * 2);
+      for (unsigned int i = 0; i < array.length(); ++i)
+      {
+        points.push_back(float(array[i].x));
+        points.push_back(float(array[i].y));
+      }
+    }
+  }
+
+  const std::string pathData = path.asChar();
+  key = outlineKey(pathData, points);
+  if (key != 0)
+    Outlines::instance().request(key, pathData, points);
+  return MStatus::kSuccess;
+}
+
+MStatus PickableShape::readAttributes(const MObject& node,
+                                      PickableAttributes& attributes) {
+  MStatus status;
+
+  const MPlug colorPlug(node, m_color);
+  attributes.color.r = colorPlug.child(0).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.color.g = colorPlug.child(1).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.color.b = colorPlug.child(2).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.color.a = MPlug(node, m_opacity).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+
+  attributes.show = MPlug(node, m_show).asBool(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  const MString group = MPlug(node, m_group).asString(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.group = groupKey(group.asChar());
+
+  attributes.shape = static_cast<Shape>(MPlug(node, m_shape).asShort(&status));
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.parameters.cornerRadius = MPlug(node, m_cornerRadius).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.parameters.innerRadius = MPlug(node, m_innerRadius).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.parameters.arcAngle = float(MPlug(node, m_arcAngle).asMAngle(&status).asDegrees());
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.parameters.sides = MPlug(node, m_sides).asInt(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.outline = 0;
+  if (attributes.shape == Shape::Custom)
+    CHECK_MSTATUS_AND_RETURN_IT(readOutline(node, attributes.outline));
+  attributes.size = MPlug(node, m_size).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.width = MPlug(node, m_width).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.height = MPlug(node, m_height).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.depth = MPlug(node, m_depth).asInt(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+
+  attributes.position = static_cast<Position>(MPlug(node, m_position).asShort(&status));
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.horizontalAlign = static_cast<HorizontalAlign>(MPlug(node, m_horizontalAlign).asShort(&status));
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.verticalAlign = static_cast<VerticalAlign>(MPlug(node, m_verticalAlign).asShort(&status));
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+
+  attributes.rotate = float(MPlug(node, m_rotate).asMAngle(&status).asRadians());
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.offsetX = MPlug(node, m_offsetX).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
+  attributes.offsetY = MPlug(node, m_offsetY).asFloat(&status);
+  CHECK_MSTATUS_AND_RETURN_IT(status);
 
   return MStatus::kSuccess;
 }
 
+MStatus PickableShape::setDependentsDirty(const MPlug& plug,
+                                          MPlugArray& plugArray) {
+  const MPlug attributePlug = plug.isChild() ? plug.parent() : plug;
+  const MObject attribute = attributePlug.attribute();
+  if (attribute == m_camera)
+    return MPxSurfaceShape::setDependentsDirty(plug, plugArray);
+
+  if (isStyleAttribute(attribute))
+    ++m_styleVersion;
+  else
+    ++m_layoutVersion;
+  ++changeCounter();
+
+  return MPxSurfaceShape::setDependentsDirty(plug, plugArray);
+}
+
+MStatus PickableShape::preEvaluation(const MDGContext& context,
+                                     const MEvaluationNode& evaluationNode) {
+
+  // Dirty propagation is skipped under the evaluation manager, so
+  // animated attributes are picked up here instead. Nodes under an
+  // animated transform are evaluated every frame without any of their
+  // own plugs changing, placement already follows the transform.
+  bool changed = false;
+  if (evaluationNode.dirtyPlugExists(m_shape) ||
+      evaluationNode.dirtyPlugExists(m_cornerRadius) ||
+      evaluationNode.dirtyPlugExists(m_innerRadius) ||
+      evaluationNode.dirtyPlugExists(m_arcAngle) ||
+      evaluationNode.dirtyPlugExists(m_sides) ||
+      evaluationNode.dirtyPlugExists(m_path) ||
+      evaluationNode.dirtyPlugExists(m_points) ||
+      evaluationNode.dirtyPlugExists(m_color) ||
+      evaluationNode.dirtyPlugExists(m_opacity) ||
+      evaluationNode.dirtyPlugExists(m_show) ||
+      evaluationNode.dirtyPlugExists(m_group))
+  {
+    ++m_styleVersion;
+    changed = true;
+  }
+  if (evaluationNode.dirtyPlugExists(m_size) ||
+      evaluationNode.dirtyPlugExists(m_width) ||
+      evaluationNode.dirtyPlugExists(m_height) ||
+      evaluationNode.dirtyPlugExists(m_depth) ||
+      evaluationNode.dirtyPlugExists(m_position) ||
+      evaluationNode.dirtyPlugExists(m_horizontalAlign) ||
+      evaluationNode.dirtyPlugExists(m_verticalAlign) ||
+      evaluationNode.dirtyPlugExists(m_rotate) ||
+      evaluationNode.dirtyPlugExists(m_offset) ||
+      evaluationNode.dirtyPlugExists(m_offsetX) ||
+      evaluationNode.dirtyPlugExists(m_offsetY))
+  {
+    ++m_layoutVersion;
+    changed = true;
+  }
+  if (changed)
+    ++changeCounter();
+
+  return MPxSurfaceShape::preEvaluation(context, evaluationNode);
+}
+
+PickableVersions PickableShape::versions() const {
+  PickableVersions versions;
+  versions.layout = m_layoutVersion.load();
+  versions.style = m_styleVersion.load();
+  return versions;
+}
+
+unsigned int PickableShape::changes() {
+  return changeCounter().load();
+}
+
+bool PickableShape::cachedAttributes(PickableAttributes& attributes) const {
+  std::lock_guard<std::mutex> lock(m_cachedMutex);
+  const PickableVersions current = versions();
+  if (current.layout != m_cachedVersions.layout || current.style != m_cachedVersions.style)
+  {
+    CHECK_MSTATUS_AND_RETURN(readAttributes(thisMObject(), m_cachedAttributes), false);
+    m_cachedVersions = current;
+  }
+  attributes = m_cachedAttributes;
+  return true;
+}
+
+bool PickableShape::placedBounds(const MDagPath& pickablePath, MBoundingBox& bounds) const {
+  MDagPath cameraPath;
+  const MObject camera = CameraRegistry::instance().camera(thisMObject());
+  if (camera.isNull() || !MDagPath::getAPathTo(camera, cameraPath))
+    return false;
+
+  CameraBasis views[kMaxCameraViews];
+  const std::size_t numViews = findCameraViews(cameraPath, views);
+  if (numViews == 0)
+    return false;
+
+  PickableAttributes attributes;
+  if (!cachedAttributes(attributes))
+    return false;
+
+  // The union over every viewport the camera is drawn in
+  const MMatrix inverse = pickablePath.inclusiveMatrixInverse();
+  bounds.clear();
+  for (std::size_t i = 0; i < numViews; ++i)
+  {
+    Viewport viewport;
+    const Placement placement = solvePlacement(views[i], attributes, viewport);
+    Vec3 min, max;
+    placementBounds(placement, min, max);
+    MBoundingBox world(MPoint(min.x, min.y, min.z), MPoint(max.x, max.y, max.z));
+    bounds.expand(world.transformUsing(inverse));
+  }
+  return true;
+}
+
+MBoundingBox PickableShape::boundingBox() const {
+  // Until the camera is drawn, bound the pickable by its transform so
+  // framing still finds it.
+  MDagPath pickablePath;
+  MBoundingBox bounds;
+  if (!MDagPath::getAPathTo(thisMObject(), pickablePath) ||
+      !placedBounds(pickablePath, bounds))
+    return MBoundingBox(MPoint::origin, MPoint::origin);
+  return bounds;
+}
+
 MSelectionMask PickableShape::getShapeSelectionMask() const {
   return MSelectionMask::kSelectHandles;
 }
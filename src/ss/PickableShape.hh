@@ -15,10 +15,40 @@
 #ifndef SAMPLEPLUGIN_PICKABLESHAPE_HH
 #define SAMPLEPLUGIN_PICKABLESHAPE_HH
 
+#include "ss/Types.hh"
+#include "ss/core/Layout.hh"
+#include "ss/core/Tessellate.hh"
+
+#include <maya/MBoundingBox.h>
+#include <maya/MColor.h>
+#include <maya/MDagPath.h>
+#include <maya/MDGContext.h>
+#include <maya/MEvaluationNode.h>
 #include <maya/MPxSurfaceShape.h>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
 namespace screenspace {
 
+/// Plain snapshot of every drawable attribute on a pickable. Layout
+/// attributes are shared with the Maya-free core.
+struct PickableAttributes : LayoutAttributes {
+  Shape shape;   // Draw shape
+  ShapeParameters parameters;  // Parametric shape parameters
+  MColor color;  // Shape color, alpha is opacity
+  bool show;     // Whether the pickable is drawn at all
+  std::uint64_t group;  // Key of the pickable's group, zero for none
+  std::uint64_t outline;  // Key of the custom outline, zero for none
+};
+
+/// Change counters, bumped whenever a group of attributes is dirtied.
+struct PickableVersions {
+  unsigned int layout;  // Placement attributes
+  unsigned int style;   // Shape, shape parameter, color and visibility attributes
+};
+
 class PickableShape : public MPxSurfaceShape {
 public:
   static MTypeId id;
@@ -26,12 +56,67 @@ public:
   static void* creator();
   static MStatus initialize();
 
+  /// Read all attributes of a pickable in a single pass. Custom
+  /// outlines are queued for triangulation as soon as they are read.
+  /// \param node The pickable node.
+  /// \param attributes Will be populated with the attribute values.
+  /// \return Success if all attributes were read.
+  static MStatus readAttributes(const MObject& node,
+                                PickableAttributes& attributes);
+
 public:
+  PickableShape();
+  MStatus setDependentsDirty(const MPlug& plug, MPlugArray& plugArray) override;
+  MStatus preEvaluation(const MDGContext& context,
+                        const MEvaluationNode& evaluationNode) override;
   MSelectionMask getShapeSelectionMask() const override;
+  bool isBounded() const override {return true;}
+  MBoundingBox boundingBox() const override;
+
+  /// Current change counters.
+  /// \return The layout and style versions.
+  PickableVersions versions() const;
+
+  /// Change counter shared by every pickable, bumped along with any of
+  /// their versions. Lets caches over all pickables skip checking each.
+  /// \return The counter.
+  static unsigned int changes();
+
+  /// Attribute snapshot, read again only when the versions change
+  /// since it is queried outside of drawing, every refresh.
+  /// \param attributes Will be set to the snapshot.
+  /// \return False if the attributes couldn't be read.
+  bool cachedAttributes(PickableAttributes& attributes) const;
+
+  /// Conservative bounds of the pickable where its attached camera
+  /// places it, in object space. Follows the camera as it moves.
+  /// \param pickablePath Path to this pickable.
+  /// \param bounds Will be set to the bounds.
+  /// \return False if the attached camera hasn't been drawn since its
+  /// projection last changed, so where it places pickables isn't known.
+  bool placedBounds(const MDagPath& pickablePath, MBoundingBox& bounds) const;
 
 private:
+  std::atomic<unsigned int> m_layoutVersion;
+  std::atomic<unsigned int> m_styleVersion;
+
+  // Attribute snapshot behind cachedAttributes and the versions it
+  // was read at.
+  mutable std::mutex m_cachedMutex;
+  mutable PickableAttributes m_cachedAttributes;
+  mutable PickableVersions m_cachedVersions;
+
+public:
+  /// Attributes, shared with the draw override and commands so
+  /// they never need to be looked up by name.
   static MObject m_camera;
   static MObject m_shape;
+  static MObject m_cornerRadius;
+  static MObject m_innerRadius;
+  static MObject m_arcAngle;
+  static MObject m_sides;
+  static MObject m_path;
+  static MObject m_points;
   static MObject m_color;
   static MObject m_opacity;
   static MObject m_size;
@@ -45,6 +130,8 @@ private:
   static MObject m_offsetX;
   static MObject m_offsetY;
   static MObject m_offset;
+  static MObject m_show;
+  static MObject m_group;
 };
 
 }
@@ -0,0 +1,140 @@
+#include "PickableSubSceneOverride.hh"
+
+#include "ss/CameraContext.hh"
+#include "ss/CameraRegistry.hh"
+#include "ss/GeometryBuffers.hh"
+#include "ss/Log.hh"
+#include "ss/core/Stats.hh"
+
+#include <maya/MDagPath.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MViewport2Renderer.h>
+
+namespace screenspace {
+
+MString PickableSubSceneOverride::classification = "drawdb/subscene/ss/pickable";
+MString PickableSubSceneOverride::id = "pickableSubScene";
+
+/// Name of the single render item.
+static const MString kItemName = "screenspacePickable";
+
+MHWRender::MPxSubSceneOverride* PickableSubSceneOverride::creator(const MObject& obj)
+{
+  return new PickableSubSceneOverride(obj);
+}
+
+PickableSubSceneOverride::PickableSubSceneOverride(const MObject& obj)
+    : MPxSubSceneOverride(obj),
+      m_pickable(obj),
+      m_data(),
+      m_uploadedGeometry(0),
+      m_buffers(),
+      m_shader(nullptr)
+{
+  MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer();
+  const MHWRender::MShaderManager* shaderManager = renderer ? renderer->getShaderManager() : nullptr;
+  if (shaderManager)
+    m_shader = shaderManager->getStockShader(MHWRender::MShaderManager::k3dSolidShader);
+}
+
+PickableSubSceneOverride::~PickableSubSceneOverride()
+{
+  MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer(false);
+  const MHWRender::MShaderManager* shaderManager = renderer ? renderer->getShaderManager() : nullptr;
+  if (shaderManager && m_shader)
+    shaderManager->releaseShader(m_shader);
+}
+
+MHWRender::DrawAPI PickableSubSceneOverride::supportedDrawAPIs() const {
+  return MHWRender::kAllDevices;
+}
+
+bool PickableSubSceneOverride::requiresUpdate(const MHWRender::MSubSceneContainer& container,
+                                              const MHWRender::MFrameContext& frameContext) const
+{
+  // Placement depends on the camera, unchanged inputs are skipped
+  // cheaply in update.
+  return true;
+}
+
+void PickableSubSceneOverride::update(MHWRender::MSubSceneContainer& container,
+                                      const MHWRender::MFrameContext& frameContext)
+{
+  MHWRender::MRenderItem* item = container.find(kItemName);
+  if (!item)
+  {
+    item = MHWRender::MRenderItem::Create(
+        kItemName, MHWRender::MRenderItem::NonMaterialSceneItem, MHWRender::MGeometry::kTriangles);
+    item->setDrawMode(MHWRender::MGeometry::kAll);
+    item->castsShadows(false);
+    item->receivesShadows(false);
+    item->setShader(m_shader);
+    container.add(item);
+  }
+
+  // Only drawn for the attached camera
+  MDagPath pickablePath;
+  const MDagPath cameraPath = frameContext.getCurrentCameraPath();
+  const unsigned int cameraKey = MObjectHandle(cameraPath.node()).hashCode();
+  if (!CameraRegistry::instance().isAttached(m_pickable, cameraPath.node()))
+  {
+    countPickable(cameraKey, Outcome::Detached);
+    item->enable(false);
+    return;
+  }
+  if (!MDagPath::getAPathTo(m_pickable, pickablePath) || !pickablePath.isVisible())
+  {
+    countPickable(cameraKey, Outcome::Culled);
+    item->enable(false);
+    return;
+  }
+
+  const PrepareResult result = preparePickable(pickablePath, findCameraContext(cameraPath, frameContext), m_data);
+  if (result.culled)
+  {
+    countPickable(cameraKey, Outcome::Culled);
+    item->enable(false);
+    return;
+  }
+  countPickable(cameraKey, result.style || result.matrix ? Outcome::Drawn : Outcome::CacheHit);
+
+  // Changes made while the item was disabled were never applied
+  const bool refresh = !item->isEnabled();
+
+  // Buffers only change with the shape and its level of detail
+  if (!m_buffers || m_data.geometry().index != m_uploadedGeometry)
+    setGeometry(*item);
+
+  if ((result.style || refresh) && m_shader)
+  {
+    const MColor& color = m_data.color();
+    const float solidColor[4] = {color.r, color.g, color.b, color.a};
+    CHECK_MSTATUS(m_shader->setParameter("solidColor", solidColor));
+    m_shader->setIsTransparent(color.a < 1.0f);
+  }
+
+  if (result.matrix || refresh)
+  {
+    const MMatrix world = m_data.worldMatrix();
+    item->setMatrix(&world);
+  }
+
+  item->enable(true);
+}
+
+void PickableSubSceneOverride::setGeometry(MHWRender::MRenderItem& item)
+{
+  const Geometry& geometry = m_data.geometry();
+  std::shared_ptr<const GeometryBuffers> buffers = geometryBuffers(geometry);
+
+  MHWRender::MVertexBufferArray bufferArray;
+  bufferArray.addBuffer("positions", buffers->positionBuffer.get());
+  CHECK_MSTATUS(setGeometryForRenderItem(item, bufferArray, *buffers->indexBuffer, &geometry.bounds));
+
+  // Swapped only now so buffers the item used until here are released
+  // after it stops referencing them
+  m_buffers = std::move(buffers);
+  m_uploadedGeometry = geometry.index;
+}
+
+}
@@ -0,0 +1,67 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_PICKABLESUBSCENEOVERRIDE_HH
+#define SCREENSPACE_PICKABLESUBSCENEOVERRIDE_HH
+
+#include "ss/GeometryBuffers.hh"
+#include "ss/PickableData.hh"
+
+#include <maya/MHWGeometry.h>
+#include <maya/MPxSubSceneOverride.h>
+#include <maya/MShaderManager.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace screenspace {
+
+/// Draws a single pickable from GPU-resident buffers holding its unit
+/// shape. Buffers are uploaded once per geometry and shared by every
+/// pickable drawing it, so a render item only holds its color, as a
+/// shader parameter, and camera-dependent placement, as its matrix.
+class PickableSubSceneOverride : public MHWRender::MPxSubSceneOverride
+{
+public:
+  static MString classification;
+  static MString id;
+  static MPxSubSceneOverride* creator(const MObject& obj);
+
+public:
+  ~PickableSubSceneOverride() override;
+
+public:
+  MHWRender::DrawAPI supportedDrawAPIs() const override;
+  bool requiresUpdate(const MHWRender::MSubSceneContainer& container,
+                      const MHWRender::MFrameContext& frameContext) const override;
+  void update(MHWRender::MSubSceneContainer& container,
+              const MHWRender::MFrameContext& frameContext) override;
+
+private:
+  PickableSubSceneOverride(const MObject& obj);
+
+  /// Point the render item at the shared buffers of the current shape.
+  void setGeometry(MHWRender::MRenderItem& item);
+
+private:
+  MObject m_pickable;
+  PickableData m_data;
+  std::size_t m_uploadedGeometry;  // Index of the geometry in m_buffers
+  std::shared_ptr<const GeometryBuffers> m_buffers;
+  MHWRender::MShaderInstance* m_shader;
+};
+
+}
+
+#endif // SCREENSPACE_PICKABLESUBSCENEOVERRIDE_HH
@@ -1,17 +1,63 @@
 #include "ss/commands/AddCommand.hh"
+#include "ss/commands/GroupsCommand.hh"
+#include "ss/commands/ListCommand.hh"
+#include "ss/commands/PickAtCommand.hh"
+#include "ss/commands/PickInRectCommand.hh"
 #include "ss/commands/RemoveCommand.hh"
+#include "ss/commands/StatsCommand.hh"
+#include "ss/commands/TraceCommand.hh"
+#include "ss/CameraRegistry.hh"
 #include "ss/Log.hh"
+#include "ss/PickableBatch.hh"
+#include "ss/PickableBatchOverride.hh"
 #include "ss/PickableDrawOverride.hh"
+#include "ss/PickableIndex.hh"
+#include "ss/PickableInstanceOverride.hh"
 #include "ss/PickableShape.hh"
+#include "ss/PickableSubSceneOverride.hh"
+#include "ss/Settings.hh"
+#include "ss/UnitGeometry.hh"
+#include "ss/core/Outlines.hh"
 
+#include <maya/MCallbackIdArray.h>
 #include <maya/MDrawRegistry.h>
 #include <maya/MFnPlugin.h>
 #include <maya/MGlobal.h>
+#include <maya/MSceneMessage.h>
 
 using namespace screenspace;
 
+/// Pickable classification when drawn by a pickableBatch, either
+/// batched or instanced. Nothing is
+/// registered for it so pickables are never drawn individually.
+static MString kBatchedPickableClassification = "drawdb/geometry/ss/batchedPickable";
+
+/// Callbacks creating the batch node of opened scenes, batched and
+/// instanced modes only.
+static MCallbackIdArray s_sceneCallbacks;
+
 MStatus initializePlugin(MObject obj) {
   MFnPlugin plugin(obj, "Eddie Hoyle", "1.0", "Any");
+  SS_INITIALISE_LOG();
+
+  loadSettings();
+  initializeUnitGeometry();
+
+  // Custom outlines finish off the main thread, redraw once the queue
+  // is empty so placeholders are swapped
+  Outlines::instance().setListener([] {
+    MGlobal::executeCommandOnIdle("refresh");
+  });
+  const DrawMode drawMode = settings().drawMode;
+
+  const MString* pickableClassification = &PickableDrawOverride::classification;
+  const MString* batchClassification = &PickableBatchOverride::classification;
+  if (drawMode == DrawMode::Batched || drawMode == DrawMode::Instanced)
+    pickableClassification = &kBatchedPickableClassification;
+  else if (drawMode == DrawMode::Persistent)
+    pickableClassification = &PickableSubSceneOverride::classification;
+  if (drawMode == DrawMode::Instanced)
+    batchClassification = &PickableInstanceOverride::classification;
 
   MStatus status;
   status = plugin.registerNode(PickableShape::typeName,
@@ -19,13 +65,44 @@ MStatus initializePlugin(MObject obj) {
                                &PickableShape::creator,
                                &PickableShape::initialize,
                                MPxNode::kSurfaceShape,
-                               &PickableDrawOverride::classification);
+                               pickableClassification);
   CHECK_MSTATUS(status);
 
-  status = MHWRender::MDrawRegistry::registerDrawOverrideCreator(
-      PickableDrawOverride::classification,
-      PickableDrawOverride::id,
-      PickableDrawOverride::creator);
+  status = plugin.registerNode(PickableBatch::typeName,
+                               PickableBatch::id,
+                               &PickableBatch::creator,
+                               &PickableBatch::initialize,
+                               MPxNode::kLocatorNode,
+                               batchClassification);
+  CHECK_MSTATUS(status);
+
+  switch (drawMode)
+  {
+    case DrawMode::Override:
+      status = MHWRender::MDrawRegistry::registerDrawOverrideCreator(
+          PickableDrawOverride::classification,
+          PickableDrawOverride::id,
+          PickableDrawOverride::creator);
+      break;
+    case DrawMode::Batched:
+      status = MHWRender::MDrawRegistry::registerSubSceneOverrideCreator(
+          PickableBatchOverride::classification,
+          PickableBatchOverride::id,
+          PickableBatchOverride::creator);
+      break;
+    case DrawMode::Persistent:
+      status = MHWRender::MDrawRegistry::registerSubSceneOverrideCreator(
+          PickableSubSceneOverride::classification,
+          PickableSubSceneOverride::id,
+          PickableSubSceneOverride::creator);
+      break;
+    case DrawMode::Instanced:
+      status = MHWRender::MDrawRegistry::registerSubSceneOverrideCreator(
+          PickableInstanceOverride::classification,
+          PickableInstanceOverride::id,
+          PickableInstanceOverride::creator);
+      break;
+  }
   CHECK_MSTATUS(status);
 
   status = plugin.registerCommand(AddCommand::typeName,
@@ -37,6 +114,53 @@ MStatus initializePlugin(MObject obj) {
                                   RemoveCommand::creator,
                                   RemoveCommand::syntaxCreator);
   CHECK_MSTATUS(status);
+
+  status = plugin.registerCommand(ListCommand::typeName,
+                                  ListCommand::creator,
+                                  ListCommand::syntaxCreator);
+  CHECK_MSTATUS(status);
+
+  status = plugin.registerCommand(PickAtCommand::typeName,
+                                  PickAtCommand::creator,
+                                  PickAtCommand::syntaxCreator);
+  CHECK_MSTATUS(status);
+
+  status = plugin.registerCommand(PickInRectCommand::typeName,
+                                  PickInRectCommand::creator,
+                                  PickInRectCommand::syntaxCreator);
+  CHECK_MSTATUS(status);
+
+  status = plugin.registerCommand(StatsCommand::typeName,
+                                  StatsCommand::creator,
+                                  StatsCommand::syntaxCreator);
+  CHECK_MSTATUS(status);
+
+  status = plugin.registerCommand(TraceCommand::typeName,
+                                  TraceCommand::creator,
+                                  TraceCommand::syntaxCreator);
+  CHECK_MSTATUS(status);
+
+  status = plugin.registerCommand(GroupsCommand::typeName,
+                                  GroupsCommand::creator,
+                                  GroupsCommand::syntaxCreator);
+  CHECK_MSTATUS(status);
+
+  status = CameraRegistry::instance().initialize();
+  CHECK_MSTATUS(status);
+
+  // Scenes saved in another draw mode have no batch node to draw them
+  if (drawMode == DrawMode::Batched || drawMode == DrawMode::Instanced)
+  {
+    ensurePickableBatch();
+    for (MSceneMessage::Message message : {MSceneMessage::kAfterOpen,
+                                           MSceneMessage::kAfterImport,
+                                           MSceneMessage::kAfterCreateReference})
+    {
+      s_sceneCallbacks.append(MSceneMessage::addCallback(
+          message, [](void*) { ensurePickableBatch(); }, nullptr, &status));
+      CHECK_MSTATUS(status);
+    }
+  }
   return status;
 }
 
@@ -44,6 +168,41 @@ MStatus uninitializePlugin(MObject obj) {
   MFnPlugin plugin(obj);
   MStatus status;
 
+  MMessage::removeCallbacks(s_sceneCallbacks);
+  s_sceneCallbacks.clear();
+  CameraRegistry::instance().uninitialize();
+  PickableIndex::instance().clear();
+  Outlines::instance().setListener(nullptr);
+  Outlines::instance().stop();
+
+  switch (settings().drawMode)
+  {
+    case DrawMode::Override:
+      status = MHWRender::MDrawRegistry::deregisterDrawOverrideCreator(
+          PickableDrawOverride::classification,
+          PickableDrawOverride::id);
+      break;
+    case DrawMode::Batched:
+      status = MHWRender::MDrawRegistry::deregisterSubSceneOverrideCreator(
+          PickableBatchOverride::classification,
+          PickableBatchOverride::id);
+      break;
+    case DrawMode::Persistent:
+      status = MHWRender::MDrawRegistry::deregisterSubSceneOverrideCreator(
+          PickableSubSceneOverride::classification,
+          PickableSubSceneOverride::id);
+      break;
+    case DrawMode::Instanced:
+      status = MHWRender::MDrawRegistry::deregisterSubSceneOverrideCreator(
+          PickableInstanceOverride::classification,
+          PickableInstanceOverride::id);
+      break;
+  }
+  CHECK_MSTATUS(status);
+
+  status = plugin.deregisterNode(PickableBatch::id);
+  CHECK_MSTATUS(status);
+
   status = plugin.deregisterNode(PickableShape::id);
   CHECK_MSTATUS(status);
 
@@ -53,5 +212,25 @@ MStatus uninitializePlugin(MObject obj) {
   status = plugin.deregisterCommand(RemoveCommand::typeName);
   CHECK_MSTATUS(status);
 
+  status = plugin.deregisterCommand(ListCommand::typeName);
+  CHECK_MSTATUS(status);
+
+  status = plugin.deregisterCommand(PickAtCommand::typeName);
+  CHECK_MSTATUS(status);
+
+  status = plugin.deregisterCommand(PickInRectCommand::typeName);
+  CHECK_MSTATUS(status);
+
+  status = plugin.deregisterCommand(StatsCommand::typeName);
+  CHECK_MSTATUS(status);
+
+  status = plugin.deregisterCommand(TraceCommand::typeName);
+  CHECK_MSTATUS(status);
+
+  status = plugin.deregisterCommand(GroupsCommand::typeName);
+  CHECK_MSTATUS(status);
+
+  SS_SHUTDOWN_LOG();
+
   return status;
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "Settings.hh"
+
+#include <maya/MGlobal.h>
+#include <maya/MString.h>
+
+#include <algorithm>
+
+namespace screenspace {
+
+/// Option var holding the draw mode, "override", "batched",
+/// "persistent" or "instanced".
+static const char* kDrawModeOptionVar = "screenspaceDrawMode";
+
+/// Option var holding how far in pixels a circle's outline may stray
+/// from a true circle, picking how many segments it's drawn with.
+static const char* kCircleToleranceOptionVar = "screenspaceCircleTolerance";
+static const float kDefaultCircleTolerance = 0.25f;
+
+/// Smallest tolerance accepted, finer than this always draws the most
+/// detailed circle anyway.
+static const float kMinCircleTolerance = 0.01f;
+
+Settings& settings() {
+  static Settings settings = {DrawMode::Override, kDefaultCircleTolerance};
+  return settings;
+}
+
+void loadSettings() {
+  Settings& current = settings();
+
+  bool exists = false;
+  const MString drawMode = MGlobal::optionVarStringValue(kDrawModeOptionVar, &exists);
+  if (!exists || drawMode == "override")
+  {
+    current.drawMode = DrawMode::Override;
+  }
+  else if (drawMode == "batched")
+  {
+    current.drawMode = DrawMode::Batched;
+  }
+  else if (drawMode == "persistent")
+  {
+    current.drawMode = DrawMode::Persistent;
+  }
+  else if (drawMode == "instanced")
+  {
+    current.drawMode = DrawMode::Instanced;
+  }
+  else
+  {
+    MGlobal::displayWarning("Unknown screenspace draw mode '" + drawMode + "', using 'override'.");
+    current.drawMode = DrawMode::Override;
+  }
+
+  const double tolerance = MGlobal::optionVarDoubleValue(kCircleToleranceOptionVar, &exists);
+  current.circleTolerance = exists ? std::max(float(tolerance), kMinCircleTolerance) : kDefaultCircleTolerance;
+}
+
+}
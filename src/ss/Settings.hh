@@ -0,0 +1,38 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_SETTINGS_HH
+#define SCREENSPACE_SETTINGS_HH
+
+#include "ss/Types.hh"
+
+namespace screenspace {
+
+/// Plugin-wide settings.
+struct Settings {
+  DrawMode drawMode;       // How pickables are rendered
+  float circleTolerance;   // Largest circle outline error in pixels
+};
+
+/// Current settings.
+/// \return The settings.
+Settings& settings();
+
+/// Load settings from option vars. Only read when the plugin loads,
+/// as the draw mode decides which overrides get registered.
+void loadSettings();
+
+}
+
+#endif // SCREENSPACE_SETTINGS_HH
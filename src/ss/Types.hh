@@ -21,6 +21,11 @@ enum class Shape {
   Circle,
   Rectangle,
   Triangle,
+  RoundedRectangle,
+  Ring,
+  Polygon,
+  Capsule,
+  Custom,
 };
 
 enum class Position {
@@ -40,6 +45,13 @@ enum class HorizontalAlign {
   Right,
 };
 
+enum class DrawMode {
+  Override,
+  Batched,
+  Persistent,
+  Instanced,
+};
+
 }
 
 #endif // SCREENSPACE_TYPES_HH
@@ -0,0 +1,254 @@
+#include "UnitGeometry.hh"
+
+#include "ss/Log.hh"
+#include "ss/core/Shapes.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace screenspace {
+
+/// Build geometry from unit points and triangles.
+/// \param points x, y per point.
+/// \param numPoints Number of points.
+/// \param indices Triangle indices.
+/// \param numIndices Number of indices.
+/// \param index Position in the unit geometry table.
+/// \param key Key of the shape.
+/// \return The geometry.
+static Geometry buildGeometry(const float* points, std::size_t numPoints,
+                              const unsigned int* indices, std::size_t numIndices,
+                              std::size_t index, const ShapeKey& key)
+{
+  Geometry geometry;
+  geometry.index = index;
+  geometry.key = key;
+  geometry.primitive = MHWRender::MUIDrawManager::Primitive::kTriangles;
+  geometry.points.setLength(numPoints);
+  geometry.pointsX.resize(numPoints);
+  geometry.pointsY.resize(numPoints);
+  for (std::size_t i = 0; i < numPoints; ++i)
+  {
+    const unsigned int point = static_cast<unsigned int>(i);
+    geometry.points[point] = MPoint(points[i * 2], points[i * 2 + 1], 0.0, 1.0);
+    geometry.pointsX[i] = points[i * 2];
+    geometry.pointsY[i] = points[i * 2 + 1];
+    geometry.bounds.expand(geometry.points[point]);
+  }
+  geometry.indices.setLength(numIndices);
+  for (std::size_t i = 0; i < numIndices; ++i)
+    geometry.indices[static_cast<unsigned int>(i)] = indices[i];
+  return geometry;
+}
+
+/// Build geometry from the core's constant tables.
+/// \param shape The shape.
+/// \param lod Level of detail.
+/// \param index Position in the unit geometry table.
+/// \return The geometry.
+static Geometry buildGeometry(Shape shape, std::size_t lod, std::size_t index)
+{
+  const UnitShape& unit = unitShape(shape, lod);
+  const ShapeKey key = {shape, 0, 0, 0, 0, 0, 0};
+  return buildGeometry(&unit.points[0][0], unit.numPoints, unit.indices, unit.numIndices, index, key);
+}
+
+/// Geometry of every shape, circle levels of detail first.
+/// \return The geometry table.
+static const std::vector<Geometry>& geometryTable()
+{
+  static const std::vector<Geometry> table = [] {
+    std::vector<Geometry> geometries;
+    geometries.reserve(kNumUnitGeometries);
+    for (std::size_t lod = 0; lod < kNumCircleLods; ++lod)
+      geometries.push_back(buildGeometry(Shape::Circle, lod, geometries.size()));
+    geometries.push_back(buildGeometry(Shape::Rectangle, 0, geometries.size()));
+    geometries.push_back(buildGeometry(Shape::Triangle, 0, geometries.size()));
+    return geometries;
+  }();
+  return table;
+}
+
+GeometryRef unitGeometry(Shape shape, std::size_t lod)
+{
+  // Aliasing an empty reference, the table outlives every pickable
+  std::size_t index = kNumCircleLods;
+  switch (shape)
+  {
+    case Shape::Circle:
+      index = lod < kNumCircleLods ? lod : kNumCircleLods - 1;
+      break;
+    case Shape::Triangle:
+      index = kNumCircleLods + 1;
+      break;
+    default:
+      break;
+  }
+  return GeometryRef(GeometryRef(), &geometryTable()[index]);
+}
+
+/// Next index for geometry built after the constant shapes, shared by
+/// parametric shapes and custom outlines so indices stay unique.
+/// \return The index.
+static std::size_t nextIndex()
+{
+  static std::atomic<std::size_t> next(kNumUnitGeometries);
+  return next++;
+}
+
+/// Share geometry built for a cache, erasing its entry once the last
+/// reference is released unless it was built again in the meantime.
+/// \param cache The cache holding the entry.
+/// \param key Key of the entry.
+/// \param geometry The geometry, owned by the reference.
+/// \return The reference.
+template <typename Cache, typename Key>
+static GeometryRef shareGeometry(Cache& cache, const Key& key, Geometry* geometry)
+{
+  return GeometryRef(geometry, [&cache, key](const Geometry* released) {
+    {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      const auto iter = cache.geometries.find(key);
+      if (iter != cache.geometries.end() && iter->second.expired())
+        cache.geometries.erase(iter);
+    }
+    delete released;
+  });
+}
+
+/// Number of most recently used geometries a cache keeps alive.
+static const std::size_t kKeptGeometries = 16;
+
+/// Most recently used geometries of a cache, most recent first. Keeps
+/// a pickable crossing back and forth over a level of detail from
+/// building its geometry again every time.
+struct KeptGeometries {
+  GeometryRef geometries[kKeptGeometries];
+
+  /// Move geometry to the front, evicting the least recently used.
+  /// \param geometry The geometry just used.
+  /// \return The evicted reference, to be released once the cache is
+  /// unlocked as its deleter locks the cache.
+  GeometryRef keep(const GeometryRef& geometry)
+  {
+    GeometryRef evicted;
+    GeometryRef* const last = std::end(geometries) - 1;
+    GeometryRef* found = std::find(std::begin(geometries), last, geometry);
+    if (found == last && *last != geometry)
+    {
+      evicted = std::move(*last);
+      *last = geometry;
+    }
+    std::rotate(std::begin(geometries), found, found + 1);
+    return evicted;
+  }
+};
+
+/// Tessellated parametric shapes by key, referenced by the cache only
+/// weakly so shapes no pickable has drawn lately are freed.
+struct ParametricCache {
+  std::mutex mutex;
+  std::unordered_map<ShapeKey, std::weak_ptr<const Geometry>, ShapeKeyHash> geometries;
+  KeptGeometries kept;  // Last, released at exit while the map is alive
+};
+
+/// The parametric cache.
+/// \return The cache.
+static ParametricCache& parametricCache()
+{
+  static ParametricCache cache;
+  return cache;
+}
+
+GeometryRef parametricGeometry(const ShapeKey& key)
+{
+  ParametricCache& cache = parametricCache();
+  GeometryRef evicted;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  std::weak_ptr<const Geometry>& entry = cache.geometries[key];
+  GeometryRef geometry = entry.lock();
+  if (!geometry)
+  {
+    ShapeMesh mesh;
+    tessellate(key, mesh);
+    geometry = shareGeometry(cache, key,
+                             new Geometry(buildGeometry(mesh.points.data(), mesh.points.size() / 2,
+                                                        mesh.indices.data(), mesh.indices.size(),
+                                                        nextIndex(), key)));
+    entry = geometry;
+  }
+  evicted = cache.kept.keep(geometry);
+  return geometry;
+}
+
+/// Geometry of finished custom outlines by key, referenced weakly like
+/// parametric shapes. Outlines that failed are remembered so they only
+/// warn once, pending outlines have no entry yet.
+struct OutlineCache {
+  std::mutex mutex;
+  std::unordered_map<std::uint64_t, std::weak_ptr<const Geometry>> geometries;
+  std::unordered_set<std::uint64_t> failed;
+  KeptGeometries kept;  // Last, released at exit while the map is alive
+};
+
+/// The outline cache.
+/// \return The cache.
+static OutlineCache& outlineCache()
+{
+  static OutlineCache cache;
+  return cache;
+}
+
+OutlineState outlineGeometry(std::uint64_t key, GeometryRef* geometry)
+{
+  OutlineCache& cache = outlineCache();
+  GeometryRef evicted;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.failed.count(key))
+    return OutlineState::Failed;
+  const auto found = cache.geometries.find(key);
+  if (found != cache.geometries.end())
+  {
+    *geometry = found->second.lock();
+    if (*geometry)
+    {
+      evicted = cache.kept.keep(*geometry);
+      return OutlineState::Ready;
+    }
+  }
+
+  const ShapeMesh* mesh = nullptr;
+  const OutlineState state = Outlines::instance().find(key, &mesh);
+  if (state == OutlineState::Pending)
+    return state;
+  if (state == OutlineState::Failed)
+  {
+    SS_WARN << "Custom outline " << key << " doesn't parse or has no area, drawing a rectangle";
+    cache.failed.insert(key);
+    return state;
+  }
+
+  const ShapeKey shapeKey = {Shape::Custom, 0, 0, 0, 0, 0, 0};
+  *geometry = shareGeometry(cache, key,
+                            new Geometry(buildGeometry(mesh->points.data(), mesh->points.size() / 2,
+                                                       mesh->indices.data(), mesh->indices.size(),
+                                                       nextIndex(), shapeKey)));
+  cache.geometries[key] = *geometry;
+  evicted = cache.kept.keep(*geometry);
+  return state;
+}
+
+void initializeUnitGeometry()
+{
+  geometryTable();
+}
+
+}
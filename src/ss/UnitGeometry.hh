@@ -0,0 +1,89 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_UNITGEOMETRY_HH
+#define SCREENSPACE_UNITGEOMETRY_HH
+
+#include "ss/Types.hh"
+#include "ss/core/Outlines.hh"
+#include "ss/core/Shapes.hh"
+#include "ss/core/Tessellate.hh"
+
+#include <maya/MBoundingBox.h>
+#include <maya/MPointArray.h>
+#include <maya/MUIDrawManager.h>
+#include <maya/MUintArray.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace screenspace {
+
+/// Geometry helper, a unit sized shape centered on the origin.
+struct Geometry {
+  MHWRender::MUIDrawManager::Primitive primitive;  // Render primitive
+  MPointArray points;                              // Unit shape points
+  std::vector<float> pointsX;                      // Unit x per point
+  std::vector<float> pointsY;                      // Unit y per point
+  MUintArray indices;                              // Poly indices
+  MBoundingBox bounds;                             // Bounding box
+  std::size_t index;                               // Unique, constant shapes first
+  ShapeKey key;                                    // Parametric key, only the shape for constant and custom shapes
+};
+
+/// Reference to shared unit geometry. Parametric and outline geometry
+/// is freed with its last reference once it is no longer among the
+/// most recently used, constant geometry lives as long as the plugin
+/// and its references aren't counted.
+using GeometryRef = std::shared_ptr<const Geometry>;
+
+/// Number of constant unit geometries, every circle level of detail
+/// plus the rectangle and triangle.
+static const std::size_t kNumUnitGeometries = kNumCircleLods + 2;
+
+/// Shared, immutable unit geometry of a shape. Built once from
+/// constant tables and referenced by every pickable of that shape.
+/// Parametric shapes fall back to the rectangle.
+/// \param shape The shape.
+/// \param lod Level of detail, only used by circles.
+/// \return Unit geometry of the shape.
+GeometryRef unitGeometry(Shape shape, std::size_t lod = kDefaultCircleLod);
+
+/// Shared unit geometry of a parametric shape, tessellated when no
+/// pickable references its key and shared by every pickable with the
+/// same key. The most recently used keys stay cached after the last
+/// pickable lets go. Indices continue after the constant shapes and
+/// are never reused.
+/// \param key The shape key.
+/// \return Unit geometry of the key.
+GeometryRef parametricGeometry(const ShapeKey& key);
+
+/// Shared unit geometry of a custom outline, built from its mesh when
+/// no pickable references it and shared by every pickable with the
+/// same outline. The most recently used outlines stay cached after the
+/// last pickable lets go. Indices continue after the constant shapes
+/// and are never reused.
+/// \param key Key from outlineKey.
+/// \param geometry Will be set to the geometry once ready.
+/// \return The state of the outline.
+OutlineState outlineGeometry(std::uint64_t key, GeometryRef* geometry);
+
+/// Build the geometry of every shape, called when the plugin loads so
+/// drawing never has to.
+void initializeUnitGeometry();
+
+}
+
+#endif // SCREENSPACE_UNITGEOMETRY_HH
@@ -1,11 +1,16 @@
 #include "AddCommand.hh"
 
 #include "ss/Log.hh"
+#include "ss/PickableBatch.hh"
 #include "ss/PickableShape.hh"
+#include "ss/Settings.hh"
 #include "ss/Types.hh"
+#include "ss/core/Trace.hh"
 
+#include <maya/MArgList.h>
 #include <maya/MArgParser.h>
 #include <maya/MDagPath.h>
+#include <maya/MFnPointArrayData.h>
 #include <maya/MGlobal.h>
 #include <maya/MNodeClass.h>
 #include <maya/MSelectionList.h>
@@ -28,6 +33,13 @@ static Flags kWidthFlags = {"-w", "-width"};
 static Flags kHeightFlags = {"-w", "-height"};
 static Flags kRotateFlags = {"-r", "-rotate"};
 static Flags kOffsetFlags = {"-o", "-offset"};
+static Flags kGroupFlags = {"-g", "-group"};
+static Flags kCornerRadiusFlags = {"-cr", "-cornerRadius"};
+static Flags kInnerRadiusFlags = {"-ir", "-innerRadius"};
+static Flags kArcAngleFlags = {"-arc", "-arcAngle"};
+static Flags kSidesFlags = {"-sd", "-sides"};
+static Flags kPathFlags = {"-pa", "-path"};
+static Flags kPointFlags = {"-pt", "-point"};
 
 MString AddCommand::typeName = "addPickable";
 
@@ -48,7 +60,14 @@ AddCommand::AddCommand()
       m_size(1.0),
       m_width(10.0),
       m_height(10.0),
-      m_offset(0.0, 0.0)
+      m_offset(0.0, 0.0),
+      m_group(),
+      m_cornerRadius(0.25),
+      m_innerRadius(0.5),
+      m_arcAngle(360.0, MAngle::kDegrees),
+      m_sides(6),
+      m_path(),
+      m_points()
 {}
 
 MSyntax AddCommand::syntaxCreator() {
@@ -68,11 +87,21 @@ MSyntax AddCommand::syntaxCreator() {
   syntax.addFlag(kHeightFlags.first, kHeightFlags.second, MSyntax::kDouble);
   syntax.addFlag(kRotateFlags.first, kRotateFlags.second, MSyntax::kAngle);
   syntax.addFlag(kOffsetFlags.first, kOffsetFlags.second, MSyntax::kDouble, MSyntax::kDouble);
+  syntax.addFlag(kGroupFlags.first, kGroupFlags.second, MSyntax::kString);
+  syntax.addFlag(kCornerRadiusFlags.first, kCornerRadiusFlags.second, MSyntax::kDouble);
+  syntax.addFlag(kInnerRadiusFlags.first, kInnerRadiusFlags.second, MSyntax::kDouble);
+  syntax.addFlag(kArcAngleFlags.first, kArcAngleFlags.second, MSyntax::kAngle);
+  syntax.addFlag(kSidesFlags.first, kSidesFlags.second, MSyntax::kLong);
+  syntax.addFlag(kPathFlags.first, kPathFlags.second, MSyntax::kString);
+  syntax.addFlag(kPointFlags.first, kPointFlags.second, MSyntax::kDouble, MSyntax::kDouble);
+  syntax.makeFlagMultiUse(kPointFlags.first);
   return syntax;
 }
 
 MStatus AddCommand::doIt(const MArgList& args)
 {
+  ScopedTrace trace("addPickable");
+
   MStatus status;
   MArgParser parser(syntax(), args);
 
@@ -209,6 +238,16 @@ MStatus AddCommand::doIt(const MArgList& args)
       shape = static_cast<int>(Shape::Rectangle);
     else if (_shape == "triangle")
       shape = static_cast<int>(Shape::Triangle);
+    else if (_shape == "roundedRectangle")
+      shape = static_cast<int>(Shape::RoundedRectangle);
+    else if (_shape == "ring")
+      shape = static_cast<int>(Shape::Ring);
+    else if (_shape == "polygon")
+      shape = static_cast<int>(Shape::Polygon);
+    else if (_shape == "capsule")
+      shape = static_cast<int>(Shape::Capsule);
+    else if (_shape == "custom")
+      shape = static_cast<int>(Shape::Custom);
 
     if (shape == -1)
     {
@@ -219,6 +258,33 @@ MStatus AddCommand::doIt(const MArgList& args)
     m_shape = static_cast<Shape>(shape);
   }
 
+  if (parser.isFlagSet(kCornerRadiusFlags.second))
+    CHECK_MSTATUS(parser.getFlagArgument(kCornerRadiusFlags.second, 0, m_cornerRadius));
+
+  if (parser.isFlagSet(kInnerRadiusFlags.second))
+    CHECK_MSTATUS(parser.getFlagArgument(kInnerRadiusFlags.second, 0, m_innerRadius));
+
+  if (parser.isFlagSet(kArcAngleFlags.second))
+  {
+    double arcAngle;
+    CHECK_MSTATUS(parser.getFlagArgument(kArcAngleFlags.second, 0, arcAngle));
+    m_arcAngle = MAngle(arcAngle, MAngle::kDegrees);
+  }
+
+  if (parser.isFlagSet(kSidesFlags.second))
+    CHECK_MSTATUS(parser.getFlagArgument(kSidesFlags.second, 0, m_sides));
+
+  if (parser.isFlagSet(kPathFlags.second))
+    CHECK_MSTATUS(parser.getFlagArgument(kPathFlags.second, 0, m_path));
+
+  m_points.clear();
+  for (unsigned int i = 0; i < parser.numberOfFlagUses(kPointFlags.first); ++i)
+  {
+    MArgList point;
+    CHECK_MSTATUS(parser.getFlagArgumentList(kPointFlags.first, i, point));
+    m_points.append(MPoint(point.asDouble(0), point.asDouble(1)));
+  }
+
   if (parser.isFlagSet(kColorFlags.second))
   {
     double r, g, b;
@@ -257,51 +323,76 @@ MStatus AddCommand::doIt(const MArgList& args)
     CHECK_MSTATUS(parser.getFlagArgument(kOffsetFlags.second, 1, m_offset.y));
   }
 
+  if (parser.isFlagSet(kGroupFlags.second))
+    CHECK_MSTATUS(parser.getFlagArgument(kGroupFlags.second, 0, m_group));
+
   return redoIt();
 }
 
 MStatus AddCommand::redoIt() {
+  ScopedTrace trace("addPickable.redo");
 
   // Process
   MStatus status;
   MObject pickableObj = m_dgm.createNode(PickableShape::id, m_parent, &status);
   CHECK_MSTATUS(status);
   CHECK_MSTATUS(m_dgm.connect(MPlug(m_camera, MNodeClass("camera").attribute("message")),
-                              MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("camera"))));
+                              MPlug(pickableObj, PickableShape::m_camera)));
+
+  CHECK_MSTATUS(m_dgm.newPlugValueInt(MPlug(pickableObj, PickableShape::m_depth), m_depth));
+  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, PickableShape::m_position), static_cast<short>(m_position)));
+  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, PickableShape::m_verticalAlign), static_cast<short>(m_verticalAlign)));
+  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, PickableShape::m_horizontalAlign), static_cast<short>(m_horizontalAlign)));
+  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, PickableShape::m_shape), static_cast<short>(m_shape)));
+  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, PickableShape::m_cornerRadius), float(m_cornerRadius)));
+  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, PickableShape::m_innerRadius), float(m_innerRadius)));
+  CHECK_MSTATUS(m_dgm.newPlugValueMAngle(MPlug(pickableObj, PickableShape::m_arcAngle), m_arcAngle));
+  CHECK_MSTATUS(m_dgm.newPlugValueInt(MPlug(pickableObj, PickableShape::m_sides), m_sides));
+  CHECK_MSTATUS(m_dgm.newPlugValueString(MPlug(pickableObj, PickableShape::m_path), m_path));
 
-  CHECK_MSTATUS(m_dgm.newPlugValueInt(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("depth")), m_depth));
-  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("position")), static_cast<short>(m_position)));
-  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("verticalAlign")), static_cast<short>(m_verticalAlign)));
-  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("horizontalAlign")), static_cast<short>(m_horizontalAlign)));
-  CHECK_MSTATUS(m_dgm.newPlugValueShort(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("shape")), static_cast<short>(m_shape)));
+  {
+    MFnPointArrayData pointsData;
+    MObject pointsObj = pointsData.create(m_points, &status);
+    CHECK_MSTATUS(status);
+    CHECK_MSTATUS(m_dgm.newPlugValue(MPlug(pickableObj, PickableShape::m_points), pointsObj));
+  }
 
   {
     MFnNumericData numData;
     MObject numObj = numData.create(MFnNumericData::k3Float, &status);
     CHECK_MSTATUS(status);
     CHECK_MSTATUS(numData.setData(float(m_color.r), float(m_color.g), float(m_color.b)));
-    CHECK_MSTATUS(m_dgm.newPlugValue(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("color")), numObj));
+    CHECK_MSTATUS(m_dgm.newPlugValue(MPlug(pickableObj, PickableShape::m_color), numObj));
   }
 
-  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("opacity")), m_color.a));
-  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("size")), float(m_size)));
-  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("width")), float(m_width)));
-  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("height")), float(m_height)));
-  CHECK_MSTATUS(m_dgm.newPlugValueMAngle(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("rotate")), m_rotate));
+  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, PickableShape::m_opacity), m_color.a));
+  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, PickableShape::m_size), float(m_size)));
+  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, PickableShape::m_width), float(m_width)));
+  CHECK_MSTATUS(m_dgm.newPlugValueFloat(MPlug(pickableObj, PickableShape::m_height), float(m_height)));
+  CHECK_MSTATUS(m_dgm.newPlugValueMAngle(MPlug(pickableObj, PickableShape::m_rotate), m_rotate));
 
   {
     MFnNumericData numData;
     MObject numObj = numData.create(MFnNumericData::k2Float, &status);
     CHECK_MSTATUS(status);
     CHECK_MSTATUS(numData.setData(float(m_offset.x), float(m_offset.y)));
-    CHECK_MSTATUS(m_dgm.newPlugValue(MPlug(pickableObj, MNodeClass(PickableShape::id).attribute("offset")), numObj));
+    CHECK_MSTATUS(m_dgm.newPlugValue(MPlug(pickableObj, PickableShape::m_offset), numObj));
   }
 
+  CHECK_MSTATUS(m_dgm.newPlugValueString(MPlug(pickableObj, PickableShape::m_group), m_group));
+
+  // Only the batch node draws pickables in these modes
+  const DrawMode drawMode = settings().drawMode;
+  if (drawMode == DrawMode::Batched || drawMode == DrawMode::Instanced)
+    CHECK_MSTATUS(addPickableBatch(m_dgm));
+
   CHECK_MSTATUS(m_dgm.doIt());
   return MS::kSuccess;
 }
 
 MStatus AddCommand::undoIt() {
+  ScopedTrace trace("addPickable.undo");
+
   return m_dgm.undoIt();
 }
 
@@ -22,7 +22,9 @@
 #include <maya/MDagModifier.h>
 #include <maya/MObject.h>
 #include <maya/MPoint.h>
+#include <maya/MPointArray.h>
 #include <maya/MPxCommand.h>
+#include <maya/MString.h>
 #include <maya/MSyntax.h>
 
 namespace screenspace {
@@ -55,6 +57,13 @@ private:
   double m_height;
   MAngle m_rotate;
   MPoint m_offset;
+  MString m_group;
+  double m_cornerRadius;
+  double m_innerRadius;
+  MAngle m_arcAngle;
+  int m_sides;
+  MString m_path;
+  MPointArray m_points;
 };
 
 }
@@ -0,0 +1,109 @@
+#include "GroupsCommand.hh"
+
+#include "ss/core/Groups.hh"
+#include "ss/core/Trace.hh"
+
+#include <maya/M3dView.h>
+#include <maya/MArgParser.h>
+#include <maya/MGlobal.h>
+#include <maya/MStringArray.h>
+
+namespace screenspace {
+
+using Flags = std::pair<const char*, const char*>;
+
+static Flags kHideFlags = {"-hi", "-hide"};
+static Flags kShowFlags = {"-sh", "-show"};
+static Flags kShowAllFlags = {"-sa", "-showAll"};
+
+MString GroupsCommand::typeName = "pickableGroups";
+
+void* GroupsCommand::creator() {
+  return new GroupsCommand();
+}
+
+MSyntax GroupsCommand::syntaxCreator() {
+
+  MSyntax syntax;
+  syntax.enableQuery(true);
+  syntax.addFlag(kHideFlags.first, kHideFlags.second, MSyntax::kString);
+  syntax.addFlag(kShowFlags.first, kShowFlags.second, MSyntax::kString);
+  syntax.addFlag(kShowAllFlags.first, kShowAllFlags.second);
+  return syntax;
+}
+
+MStatus GroupsCommand::doIt(const MArgList& args)
+{
+  ScopedTrace trace("pickableGroups");
+
+  MStatus status;
+  MArgParser parser(syntax(), args, &status);
+  if (status != MStatus::kSuccess)
+    return status;
+
+  if (parser.isQuery())
+  {
+    MStringArray names;
+    for (const std::string& name : Groups::instance().hiddenNames())
+      names.append(MString(name.c_str()));
+    setResult(names);
+    return MS::kSuccess;
+  }
+
+  MString name;
+  if (parser.isFlagSet(kHideFlags.second))
+  {
+    CHECK_MSTATUS(parser.getFlagArgument(kHideFlags.second, 0, name));
+    m_hide = name.asChar();
+  }
+  if (parser.isFlagSet(kShowFlags.second))
+  {
+    CHECK_MSTATUS(parser.getFlagArgument(kShowFlags.second, 0, name));
+    m_show = name.asChar();
+  }
+  m_showAll = parser.isFlagSet(kShowAllFlags.second);
+
+  if (m_hide.empty() && m_show.empty() && !m_showAll)
+  {
+    MGlobal::displayError("Error changing pickable groups! Flags 'hide', 'show' or 'showAll' are required");
+    return MS::kFailure;
+  }
+
+  m_hidden = Groups::instance().hiddenNames();
+  return redoIt();
+}
+
+MStatus GroupsCommand::redoIt()
+{
+  ScopedTrace trace("pickableGroups.redo");
+
+  Groups& groups = Groups::instance();
+  if (m_showAll)
+    groups.showAll();
+  if (!m_show.empty())
+    groups.setHidden(m_show, false);
+  if (!m_hide.empty() && !groups.setHidden(m_hide, true))
+  {
+    MGlobal::displayError("Error hiding pickable group! Too many groups are hidden");
+    return MS::kFailure;
+  }
+
+  // Nothing in the scene changed, so views won't redraw on their own
+  M3dView::scheduleRefreshAllViews();
+  return MS::kSuccess;
+}
+
+MStatus GroupsCommand::undoIt()
+{
+  ScopedTrace trace("pickableGroups.undo");
+
+  Groups& groups = Groups::instance();
+  groups.showAll();
+  for (const std::string& name : m_hidden)
+    groups.setHidden(name, true);
+
+  M3dView::scheduleRefreshAllViews();
+  return MS::kSuccess;
+}
+
+}
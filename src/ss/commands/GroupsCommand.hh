@@ -0,0 +1,55 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_GROUPSCOMMAND_HH
+#define SCREENSPACE_GROUPSCOMMAND_HH
+
+#include <maya/MPxCommand.h>
+#include <maya/MSyntax.h>
+
+#include <string>
+#include <vector>
+
+namespace screenspace {
+
+/// Hide and show groups of pickables, matched by their group
+/// attribute, so a whole character's picker is switched off at once.
+///
+/// pickableGroups -hide "bob"     Hide every pickable in group bob
+/// pickableGroups -show "bob"     Show them again
+/// pickableGroups -showAll        Show every group
+/// pickableGroups -query          Names of the hidden groups
+class GroupsCommand : public MPxCommand {
+public:
+  static MString typeName;
+  static void* creator();
+  static MSyntax syntaxCreator();
+
+public:
+  GroupsCommand() = default;
+  bool isUndoable() const override {return true;}
+  MStatus doIt(const MArgList& args) override;
+  MStatus redoIt() override;
+  MStatus undoIt() override;
+
+private:
+  std::string m_hide;                 // Group to hide
+  std::string m_show;                 // Group to show
+  bool m_showAll = false;             // Show every group
+  std::vector<std::string> m_hidden;  // Hidden groups before the command
+};
+
+}
+
+#endif // SCREENSPACE_GROUPSCOMMAND_HH
@@ -0,0 +1,80 @@
+#include "ListCommand.hh"
+
+#include "ss/CameraRegistry.hh"
+#include "ss/Log.hh"
+#include "ss/core/Trace.hh"
+
+#include <maya/MArgParser.h>
+#include <maya/MDagPath.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MGlobal.h>
+#include <maya/MObjectArray.h>
+#include <maya/MSelectionList.h>
+#include <maya/MStringArray.h>
+
+namespace screenspace {
+
+using Flags = std::pair<const char*, const char*>;
+
+static Flags kCameraFlags = {"-c", "-camera"};
+
+MString ListCommand::typeName = "listPickables";
+
+void* ListCommand::creator() {
+  return new ListCommand();
+}
+
+MSyntax ListCommand::syntaxCreator() {
+
+  MSyntax syntax;
+  syntax.addFlag(kCameraFlags.first, kCameraFlags.second, MSyntax::kString);
+  return syntax;
+}
+
+MStatus ListCommand::doIt(const MArgList& args)
+{
+  ScopedTrace trace("listPickables");
+
+  MStatus status;
+  MArgParser parser(syntax(), args);
+
+  MObjectArray pickables;
+  if (parser.isFlagSet(kCameraFlags.second))
+  {
+    MString cameraName;
+    parser.getFlagArgument(kCameraFlags.second, 0, cameraName);
+
+    MSelectionList list;
+    status = list.add(cameraName);
+    if (status != MStatus::kSuccess)
+    {
+      MGlobal::displayError("Error listing pickables! Camera does not exist: " + cameraName);
+      return MS::kFailure;
+    }
+
+    MDagPath cameraPath;
+    CHECK_MSTATUS(list.getDagPath(0, cameraPath));
+    if (cameraPath.apiType() == MFn::Type::kTransform)
+      cameraPath.extendToShape();
+
+    if (!cameraPath.hasFn(MFn::Type::kCamera))
+    {
+      MGlobal::displayError("Error listing pickables! Not a camera: " + cameraName);
+      return MS::kFailure;
+    }
+    pickables = CameraRegistry::instance().pickables(cameraPath.node());
+  }
+  else
+  {
+    pickables = CameraRegistry::instance().pickables();
+  }
+
+  MStringArray names;
+  for (unsigned int i = 0; i < pickables.length(); ++i)
+    names.append(MFnDagNode(pickables[i]).fullPathName());
+
+  setResult(names);
+  return MS::kSuccess;
+}
+
+}
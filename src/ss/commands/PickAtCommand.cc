@@ -0,0 +1,111 @@
+#include "PickAtCommand.hh"
+
+#include "ss/CameraContext.hh"
+#include "ss/PickableIndex.hh"
+#include "ss/core/Trace.hh"
+
+#include <maya/MArgParser.h>
+#include <maya/MDagPath.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MGlobal.h>
+#include <maya/MObjectArray.h>
+#include <maya/MSelectionList.h>
+#include <maya/MStringArray.h>
+
+#include <algorithm>
+
+namespace screenspace {
+
+using Flags = std::pair<const char*, const char*>;
+
+static Flags kCameraFlags = {"-c", "-camera"};
+static Flags kViewFlags = {"-v", "-view"};
+static Flags kAllFlags = {"-a", "-all"};
+
+MString PickAtCommand::typeName = "pickableAt";
+
+void* PickAtCommand::creator() {
+  return new PickAtCommand();
+}
+
+MSyntax PickAtCommand::syntaxCreator() {
+
+  MSyntax syntax;
+  syntax.addFlag(kCameraFlags.first, kCameraFlags.second, MSyntax::kString);
+  syntax.addFlag(kViewFlags.first, kViewFlags.second, MSyntax::kLong);
+  syntax.addFlag(kAllFlags.first, kAllFlags.second);
+  syntax.addArg(MSyntax::kDouble);
+  syntax.addArg(MSyntax::kDouble);
+  return syntax;
+}
+
+MStatus PickAtCommand::doIt(const MArgList& args)
+{
+  ScopedTrace trace("pickableAt");
+
+  MStatus status;
+  MArgParser parser(syntax(), args, &status);
+  if (status != MStatus::kSuccess)
+    return status;
+
+  if (!parser.isFlagSet(kCameraFlags.second))
+  {
+    MGlobal::displayError("Error picking! No camera set.");
+    return MS::kFailure;
+  }
+
+  MString cameraName;
+  parser.getFlagArgument(kCameraFlags.second, 0, cameraName);
+
+  MSelectionList list;
+  status = list.add(cameraName);
+  if (status != MStatus::kSuccess)
+  {
+    MGlobal::displayError("Error picking! Camera does not exist: " + cameraName);
+    return MS::kFailure;
+  }
+
+  MDagPath cameraPath;
+  CHECK_MSTATUS(list.getDagPath(0, cameraPath));
+  if (cameraPath.apiType() == MFn::Type::kTransform)
+    cameraPath.extendToShape();
+
+  if (!cameraPath.hasFn(MFn::Type::kCamera))
+  {
+    MGlobal::displayError("Error picking! Not a camera: " + cameraName);
+    return MS::kFailure;
+  }
+
+  // Pickables sit where the viewport places them, so its size is
+  // taken from where the camera was last drawn
+  int view = 0;
+  if (parser.isFlagSet(kViewFlags.second))
+    CHECK_MSTATUS(parser.getFlagArgument(kViewFlags.second, 0, view));
+  CameraBasis views[kMaxCameraViews];
+  const std::size_t numViews = findCameraViews(cameraPath, views);
+  if (view < 0 || std::size_t(view) >= numViews)
+  {
+    MGlobal::displayError("Error picking! Camera isn't drawn in that many viewports: " + cameraName);
+    return MS::kFailure;
+  }
+
+  double x, y;
+  CHECK_MSTATUS_AND_RETURN_IT(parser.getCommandArgument(0, x));
+  CHECK_MSTATUS_AND_RETURN_IT(parser.getCommandArgument(1, y));
+
+  MObjectArray pickables;
+  PickableIndex::instance().findAt(cameraPath.node(), views[view].width, views[view].height,
+                                   float(x), float(y), pickables);
+
+  // Only the pickable on top unless every one is asked for
+  MStringArray names;
+  const unsigned int count = parser.isFlagSet(kAllFlags.second) ? pickables.length() :
+                             std::min(pickables.length(), 1u);
+  for (unsigned int i = 0; i < count; ++i)
+    names.append(MFnDagNode(pickables[i]).fullPathName());
+
+  setResult(names);
+  return MS::kSuccess;
+}
+
+}
@@ -0,0 +1,108 @@
+#include "PickInRectCommand.hh"
+
+#include "ss/CameraContext.hh"
+#include "ss/PickableIndex.hh"
+#include "ss/core/Trace.hh"
+
+#include <maya/MArgParser.h>
+#include <maya/MDagPath.h>
+#include <maya/MFnDagNode.h>
+#include <maya/MGlobal.h>
+#include <maya/MObjectArray.h>
+#include <maya/MSelectionList.h>
+#include <maya/MStringArray.h>
+
+namespace screenspace {
+
+using Flags = std::pair<const char*, const char*>;
+
+static Flags kCameraFlags = {"-c", "-camera"};
+static Flags kViewFlags = {"-v", "-view"};
+
+MString PickInRectCommand::typeName = "pickablesInRect";
+
+void* PickInRectCommand::creator() {
+  return new PickInRectCommand();
+}
+
+MSyntax PickInRectCommand::syntaxCreator() {
+
+  MSyntax syntax;
+  syntax.addFlag(kCameraFlags.first, kCameraFlags.second, MSyntax::kString);
+  syntax.addFlag(kViewFlags.first, kViewFlags.second, MSyntax::kLong);
+  syntax.addArg(MSyntax::kDouble);
+  syntax.addArg(MSyntax::kDouble);
+  syntax.addArg(MSyntax::kDouble);
+  syntax.addArg(MSyntax::kDouble);
+  return syntax;
+}
+
+MStatus PickInRectCommand::doIt(const MArgList& args)
+{
+  ScopedTrace trace("pickablesInRect");
+
+  MStatus status;
+  MArgParser parser(syntax(), args, &status);
+  if (status != MStatus::kSuccess)
+    return status;
+
+  if (!parser.isFlagSet(kCameraFlags.second))
+  {
+    MGlobal::displayError("Error picking! No camera set.");
+    return MS::kFailure;
+  }
+
+  MString cameraName;
+  parser.getFlagArgument(kCameraFlags.second, 0, cameraName);
+
+  MSelectionList list;
+  status = list.add(cameraName);
+  if (status != MStatus::kSuccess)
+  {
+    MGlobal::displayError("Error picking! Camera does not exist: " + cameraName);
+    return MS::kFailure;
+  }
+
+  MDagPath cameraPath;
+  CHECK_MSTATUS(list.getDagPath(0, cameraPath));
+  if (cameraPath.apiType() == MFn::Type::kTransform)
+    cameraPath.extendToShape();
+
+  if (!cameraPath.hasFn(MFn::Type::kCamera))
+  {
+    MGlobal::displayError("Error picking! Not a camera: " + cameraName);
+    return MS::kFailure;
+  }
+
+  // Pickables sit where the viewport places them, so its size is
+  // taken from where the camera was last drawn
+  int view = 0;
+  if (parser.isFlagSet(kViewFlags.second))
+    CHECK_MSTATUS(parser.getFlagArgument(kViewFlags.second, 0, view));
+  CameraBasis views[kMaxCameraViews];
+  const std::size_t numViews = findCameraViews(cameraPath, views);
+  if (view < 0 || std::size_t(view) >= numViews)
+  {
+    MGlobal::displayError("Error picking! Camera isn't drawn in that many viewports: " + cameraName);
+    return MS::kFailure;
+  }
+
+  // Corners in either order, like a marquee dragged any way
+  double corners[4];
+  for (unsigned int i = 0; i < 4; ++i)
+    CHECK_MSTATUS_AND_RETURN_IT(parser.getCommandArgument(i, corners[i]));
+  const ScreenRect rect = {float(corners[0]), float(corners[1]), float(corners[2]), float(corners[3])};
+
+  MObjectArray pickables;
+  PickableIndex::instance().findInRect(cameraPath.node(), views[view].width, views[view].height,
+                                       rect, pickables);
+
+  MStringArray names;
+  for (unsigned int i = 0; i < pickables.length(); ++i)
+    names.append(MFnDagNode(pickables[i]).fullPathName());
+
+  setResult(names);
+  return MS::kSuccess;
+}
+
+}
@@ -3,6 +3,7 @@
 #include "ss/Log.hh"
 #include "ss/PickableShape.hh"
 #include "ss/Types.hh"
+#include "ss/core/Trace.hh"
 
 #include <maya/MArgParser.h>
 #include <maya/MDagModifier.h>
@@ -41,6 +42,7 @@ MSyntax RemoveCommand::syntaxCreator() {
 }
 
 MStatus RemoveCommand::doIt(const MArgList& args) {
+  ScopedTrace trace("removePickables");
 
   MStatus status;
   MArgParser parser(syntax(), args);
@@ -123,6 +125,8 @@ MStatus RemoveCommand::doIt(const MArgList& args) {
 
 MStatus RemoveCommand::redoIt()
 {
+  ScopedTrace trace("removePickables.redo");
+
   MStatus status;
   for (std::size_t i = 0; i < m_pickables.length(); ++i)
   CHECK_MSTATUS(m_dgm.deleteNode(m_pickables[i]));
@@ -132,6 +136,8 @@ MStatus RemoveCommand::redoIt()
 
 MStatus RemoveCommand::undoIt()
 {
+  ScopedTrace trace("removePickables.undo");
+
   return m_dgm.undoIt();
 }
 
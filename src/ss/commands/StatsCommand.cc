@@ -0,0 +1,116 @@
+#include "StatsCommand.hh"
+
+#include "ss/CameraRegistry.hh"
+#include "ss/core/Stats.hh"
+#include "ss/core/Trace.hh"
+
+#include <maya/MArgParser.h>
+
+#include <iomanip>
+#include <sstream>
+
+namespace screenspace {
+
+using Flags = std::pair<const char*, const char*>;
+
+static Flags kEnableFlags = {"-en", "-enable"};
+static Flags kResetFlags = {"-r", "-reset"};
+
+MString StatsCommand::typeName = "screenspaceStats";
+
+/// Format statistics as JSON.
+/// \param snapshot Statistics to format.
+/// \return The JSON string.
+static MString formatStats(const StatsSnapshot& snapshot)
+{
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(3);
+  stream << "{\"enabled\":" << (snapshot.enabled ? "true" : "false");
+
+  // Stage durations in microseconds
+  stream << ",\"stages\":{";
+  for (std::size_t i = 0; i < kNumStages; ++i)
+  {
+    const Histogram& histogram = snapshot.stages[i];
+    const double mean = histogram.count ? double(histogram.totalNs) / histogram.count : 0.0;
+    if (i > 0)
+      stream << ",";
+    stream << "\"" << stageName(Stage(i)) << "\":{"
+           << "\"count\":" << histogram.count
+           << ",\"totalUs\":" << histogram.totalNs / 1e3
+           << ",\"meanUs\":" << mean / 1e3
+           << ",\"p50Us\":" << histogram.percentileNs(0.5) / 1e3
+           << ",\"p90Us\":" << histogram.percentileNs(0.9) / 1e3
+           << ",\"p99Us\":" << histogram.percentileNs(0.99) / 1e3
+           << ",\"maxUs\":" << histogram.maxNs / 1e3
+           << ",\"buckets\":[";
+    for (std::size_t j = 0; j < Histogram::kNumBuckets; ++j)
+      stream << (j > 0 ? "," : "") << histogram.buckets[j];
+    stream << "]}";
+  }
+  stream << "}";
+
+  // Pickable counts
+  stream << ",\"cameras\":[";
+  for (std::size_t i = 0; i < snapshot.cameras.size(); ++i)
+  {
+    const CameraCounters& counters = snapshot.cameras[i];
+    if (i > 0)
+      stream << ",";
+    stream << "{\"camera\":\"" << cameraName(counters.camera).asChar() << "\""
+           << ",\"drawn\":" << counters.drawn
+           << ",\"culled\":" << counters.culled
+           << ",\"cacheHits\":" << counters.cacheHits
+           << ",\"detached\":" << counters.detached << "}";
+  }
+  stream << "]}";
+
+  return MString(stream.str().c_str());
+}
+
+void* StatsCommand::creator() {
+  return new StatsCommand();
+}
+
+MSyntax StatsCommand::syntaxCreator() {
+
+  MSyntax syntax;
+  syntax.enableQuery(true);
+  syntax.addFlag(kEnableFlags.first, kEnableFlags.second, MSyntax::kBoolean);
+  syntax.addFlag(kResetFlags.first, kResetFlags.second);
+  return syntax;
+}
+
+MStatus StatsCommand::doIt(const MArgList& args)
+{
+  ScopedTrace trace("screenspaceStats");
+
+  MStatus status;
+  MArgParser parser(syntax(), args, &status);
+  if (status != MStatus::kSuccess)
+    return status;
+
+  Stats& stats = Stats::instance();
+  if (parser.isQuery())
+  {
+    if (parser.isFlagSet(kEnableFlags.second))
+      setResult(Stats::enabled());
+    else
+      setResult(formatStats(stats.snapshot()));
+    return MS::kSuccess;
+  }
+
+  if (parser.isFlagSet(kEnableFlags.second))
+  {
+    bool enabled = false;
+    CHECK_MSTATUS(parser.getFlagArgument(kEnableFlags.second, 0, enabled));
+    stats.setEnabled(enabled);
+  }
+
+  if (parser.isFlagSet(kResetFlags.second))
+    stats.reset();
+
+  return MS::kSuccess;
+}
+
+}
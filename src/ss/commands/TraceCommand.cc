@@ -0,0 +1,87 @@
+#include "TraceCommand.hh"
+
+#include "ss/CameraRegistry.hh"
+#include "ss/core/Trace.hh"
+
+#include <maya/MArgParser.h>
+#include <maya/MGlobal.h>
+
+#include <fstream>
+
+namespace screenspace {
+
+using Flags = std::pair<const char*, const char*>;
+
+static Flags kEnableFlags = {"-en", "-enable"};
+static Flags kOutputFlags = {"-o", "-output"};
+static Flags kClearFlags = {"-cl", "-clear"};
+
+MString TraceCommand::typeName = "screenspaceTrace";
+
+void* TraceCommand::creator() {
+  return new TraceCommand();
+}
+
+MSyntax TraceCommand::syntaxCreator() {
+
+  MSyntax syntax;
+  syntax.enableQuery(true);
+  syntax.addFlag(kEnableFlags.first, kEnableFlags.second, MSyntax::kBoolean);
+  syntax.addFlag(kOutputFlags.first, kOutputFlags.second, MSyntax::kString);
+  syntax.addFlag(kClearFlags.first, kClearFlags.second);
+  return syntax;
+}
+
+MStatus TraceCommand::doIt(const MArgList& args)
+{
+  MStatus status;
+  MArgParser parser(syntax(), args, &status);
+  if (status != MStatus::kSuccess)
+    return status;
+
+  Tracer& tracer = Tracer::instance();
+  if (parser.isQuery())
+  {
+    setResult(Tracer::enabled());
+    return MS::kSuccess;
+  }
+
+  if (parser.isFlagSet(kEnableFlags.second))
+  {
+    bool enabled = false;
+    CHECK_MSTATUS(parser.getFlagArgument(kEnableFlags.second, 0, enabled));
+    tracer.setEnabled(enabled);
+  }
+
+  if (parser.isFlagSet(kOutputFlags.second))
+  {
+    MString path;
+    CHECK_MSTATUS(parser.getFlagArgument(kOutputFlags.second, 0, path));
+
+    std::ofstream stream(path.asChar());
+    if (!stream)
+    {
+      MGlobal::displayError("Error writing trace! Could not open: " + path);
+      return MS::kFailure;
+    }
+
+    if (tracer.dropped() > 0)
+    {
+      MString message = "Trace buffers filled up, dropped events: ";
+      message += static_cast<unsigned int>(tracer.dropped());
+      MGlobal::displayWarning(message);
+    }
+
+    const std::size_t count = tracer.write(stream, [](std::uint64_t key) {
+      return std::string(cameraName(key).asChar());
+    });
+    setResult(static_cast<int>(count));
+  }
+
+  if (parser.isFlagSet(kClearFlags.second))
+    tracer.clear();
+
+  return MS::kSuccess;
+}
+
+}
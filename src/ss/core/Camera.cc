@@ -0,0 +1,24 @@
+#include "Camera.hh"
+
+namespace screenspace {
+
+Vec3 viewportToWorld(const CameraBasis& basis, int x, int y, int depth)
+{
+  const float fx = float(x);
+  const float fy = float(y);
+  const Vec3 near = basis.nearOrigin + basis.nearX * fx + basis.nearY * fy;
+  const Vec3 far = basis.farOrigin + basis.farX * fx + basis.farY * fy;
+  const float scalar = basis.nearClipPlane + 0.001f * (depth + 1);
+  return near + normalize(far - near) * scalar;
+}
+
+void setViewportSize(CameraBasis& basis, int width, int height)
+{
+  basis.width = width;
+  basis.height = height;
+  const float theta = std::atan(float(height) / float(width));
+  basis.diagonalCos = std::cos(theta);
+  basis.diagonalSin = std::sin(theta);
+}
+
+}
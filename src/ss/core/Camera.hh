@@ -0,0 +1,61 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_CAMERA_HH
+#define SCREENSPACE_CORE_CAMERA_HH
+
+#include "ss/core/Math.hh"
+
+namespace screenspace {
+
+/// Camera and viewport inputs to layout, free of any Maya types.
+/// Viewport to world is affine across the near and far planes, so an
+/// origin and per-pixel steps on each describe every unprojection.
+struct CameraBasis {
+  int width;            // Width of viewport in pixels
+  int height;           // Height of viewport in pixels
+  float nearClipPlane;  // Near clip plane of camera
+  float diagonalCos;    // Cosine of the viewport diagonal angle
+  float diagonalSin;    // Sine of the viewport diagonal angle
+  Vec3 nearOrigin;      // Near plane point of the bottom left pixel
+  Vec3 nearX;           // Near plane step per horizontal pixel
+  Vec3 nearY;           // Near plane step per vertical pixel
+  Vec3 farOrigin;       // Far plane point of the bottom left pixel
+  Vec3 farX;            // Far plane step per horizontal pixel
+  Vec3 farY;            // Far plane step per vertical pixel
+  Vec3 eye;             // Camera position in worldspace
+  Vec3 normal;          // Camera facing axis
+  Vec3 right;           // Camera rotation x axis
+  Vec3 up;              // Camera rotation y axis
+  Vec3 back;            // Camera rotation z axis
+};
+
+/// Compute a worldspace point for (x, y) coordinates in pixels from
+/// bottom left of viewport.
+/// \param basis The camera.
+/// \param x Viewport position in pixels.
+/// \param y Viewport position in pixels.
+/// \param depth Depth of shape.
+/// \return The point.
+Vec3 viewportToWorld(const CameraBasis& basis, int x, int y, int depth);
+
+/// Set viewport size and the diagonal angle derived from it.
+/// \param basis The camera.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+void setViewportSize(CameraBasis& basis, int width, int height);
+
+}
+
+#endif // SCREENSPACE_CORE_CAMERA_HH
@@ -0,0 +1,104 @@
+#include "Groups.hh"
+
+namespace screenspace {
+
+std::uint64_t groupKey(const char* name)
+{
+  if (!name || !*name)
+    return 0;
+
+  // FNV-1a, with zero kept free for no group
+  std::uint64_t key = 14695981039346656037ull;
+  for (const char* c = name; *c; ++c)
+  {
+    key ^= static_cast<unsigned char>(*c);
+    key *= 1099511628211ull;
+  }
+  return key ? key : 1;
+}
+
+Groups& Groups::instance()
+{
+  static Groups groups;
+  return groups;
+}
+
+Groups::Groups()
+    : m_version(1)
+{
+  for (std::atomic<std::uint64_t>& key : m_keys)
+    key.store(0, std::memory_order_relaxed);
+}
+
+bool Groups::setHidden(const std::string& name, bool hidden)
+{
+  const std::uint64_t key = groupKey(name.c_str());
+  if (key == 0)
+    return !hidden;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::size_t free = kMaxHidden;
+  for (std::size_t i = 0; i < kMaxHidden; ++i)
+  {
+    const std::uint64_t slot = m_keys[i].load(std::memory_order_relaxed);
+    if (slot == key)
+    {
+      if (!hidden)
+      {
+        m_keys[i].store(0, std::memory_order_relaxed);
+        m_names[i].clear();
+        m_version.fetch_add(1, std::memory_order_release);
+      }
+      return true;
+    }
+    if (slot == 0 && free == kMaxHidden)
+      free = i;
+  }
+
+  if (!hidden)
+    return true;
+  if (free == kMaxHidden)
+    return false;
+
+  m_names[free] = name;
+  m_keys[free].store(key, std::memory_order_relaxed);
+  m_version.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+void Groups::showAll()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (std::size_t i = 0; i < kMaxHidden; ++i)
+  {
+    m_keys[i].store(0, std::memory_order_relaxed);
+    m_names[i].clear();
+  }
+  m_version.fetch_add(1, std::memory_order_release);
+}
+
+bool Groups::hidden(std::uint64_t key) const
+{
+  if (key == 0)
+    return false;
+  for (const std::atomic<std::uint64_t>& slot : m_keys)
+  {
+    if (slot.load(std::memory_order_relaxed) == key)
+      return true;
+  }
+  return false;
+}
+
+std::vector<std::string> Groups::hiddenNames() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<std::string> names;
+  for (std::size_t i = 0; i < kMaxHidden; ++i)
+  {
+    if (m_keys[i].load(std::memory_order_relaxed) != 0)
+      names.push_back(m_names[i]);
+  }
+  return names;
+}
+
+}
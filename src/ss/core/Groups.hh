@@ -0,0 +1,78 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_GROUPS_HH
+#define SCREENSPACE_CORE_GROUPS_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace screenspace {
+
+/// Key of a group name, zero for no group.
+/// \param name The group name.
+/// \return The key.
+std::uint64_t groupKey(const char* name);
+
+/// Groups of pickables that are switched off together, such as every
+/// pickable of one character.
+///
+/// Pickables look groups up while deciding visibility, so the lookup
+/// is a lock-free scan of a small fixed table. Hiding and showing are
+/// rare and take a lock. Every change bumps the version so cached
+/// visibility can be decided again.
+class Groups {
+public:
+  static const std::size_t kMaxHidden = 64;
+
+  static Groups& instance();
+
+public:
+  /// Hide or show a group.
+  /// \param name The group name.
+  /// \param hidden Whether to hide the group.
+  /// \return False if too many groups are already hidden.
+  bool setHidden(const std::string& name, bool hidden);
+
+  /// Show every group.
+  void showAll();
+
+  /// Whether a group is hidden.
+  /// \param key Key from groupKey.
+  /// \return True if hidden, always false for no group.
+  bool hidden(std::uint64_t key) const;
+
+  /// Names of the hidden groups.
+  /// \return The names.
+  std::vector<std::string> hiddenNames() const;
+
+  /// Change counter, bumped whenever a group is hidden or shown.
+  unsigned int version() const {return m_version.load(std::memory_order_acquire);}
+
+private:
+  Groups();
+
+  std::atomic<std::uint64_t> m_keys[kMaxHidden];  // Zero while the slot is free
+  std::string m_names[kMaxHidden];                // Guarded by m_mutex
+  std::atomic<unsigned int> m_version;
+  mutable std::mutex m_mutex;
+};
+
+}
+
+#endif // SCREENSPACE_CORE_GROUPS_HH
@@ -0,0 +1,227 @@
+#include "Layout.hh"
+
+#include <algorithm>
+
+namespace screenspace {
+
+static inline void store(const Vec3& a, float out[3])
+{
+  out[0] = a.x;
+  out[1] = a.y;
+  out[2] = a.z;
+}
+
+/// Pixels per unit of size and offset.
+/// \param position Relative or absolute position.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \param unitX Will be set to the horizontal pixels per unit.
+/// \param unitY Will be set to the vertical pixels per unit.
+static inline void viewportUnits(Position position, int width, int height,
+                                 float& unitX, float& unitY)
+{
+  switch (position)
+  {
+    case Position::Relative:
+      unitX = width / 100.0f;
+      unitY = height / 100.0f;
+      break;
+    case Position::Absolute:
+    default:
+      unitX = 1.0f;
+      unitY = 1.0f;
+      break;
+  }
+}
+
+/// Offset of the alignment anchor, in units of size and offset.
+/// \param attributes Layout attributes of the pickable.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \param offsetX Will be set to the horizontal anchor.
+/// \param offsetY Will be set to the vertical anchor.
+static inline void alignOffsets(const LayoutAttributes& attributes,
+                                int width, int height,
+                                float& offsetX, float& offsetY)
+{
+  offsetX = 0.0f;
+  switch (attributes.horizontalAlign)
+  {
+    case HorizontalAlign::Left: offsetX = 0.0f; break;
+    case HorizontalAlign::Middle: offsetX = width / 2.0f; break;
+    case HorizontalAlign::Right: offsetX = width; break;
+  }
+
+  offsetY = 0.0f;
+  switch (attributes.verticalAlign)
+  {
+    case VerticalAlign::Bottom: offsetY = 0.0f; break;
+    case VerticalAlign::Middle: offsetY = height / 2.0f; break;
+    case VerticalAlign::Top: offsetY = height; break;
+  }
+}
+
+bool linePlaneIntersection(const Vec3& ray, const Vec3& origin,
+                           const Vec3& normal, const Vec3& coord,
+                           Vec3& contact)
+{
+  const float facing = dot(normal, ray);
+  if (facing == 0.0f)
+    return false;
+  const float scalar = (dot(normal, coord) - dot(normal, origin)) / facing;
+  contact = origin + ray * scalar;
+  return true;
+}
+
+Placement solvePlacement(const CameraBasis& camera,
+                         const LayoutAttributes& attributes,
+                         Viewport& viewport)
+{
+  const int depth = attributes.depth;
+
+  // Viewport extents on the near plane
+  const Vec3 nearBL = viewportToWorld(camera, 0, 0, depth);
+  const Vec3 nearTR = viewportToWorld(camera, camera.width, camera.height, depth);
+  const float hyp = length(nearTR - nearBL);
+  viewport.width = camera.width;
+  viewport.height = camera.height;
+  viewport.worldspaceWidth = camera.diagonalCos * hyp;
+  viewport.worldspaceHeight = camera.diagonalSin * hyp;
+
+  // Viewport scale factor
+  float worldspaceUnitX, worldspaceUnitY;
+  float viewportUnitX, viewportUnitY;
+  switch (attributes.position)
+  {
+    case Position::Relative:
+      worldspaceUnitX = viewport.worldspaceWidth / 100.0f;
+      worldspaceUnitY = viewport.worldspaceHeight / 100.0f;
+      break;
+    case Position::Absolute:
+    default:
+      worldspaceUnitX = viewport.worldspaceWidth / viewport.width;
+      worldspaceUnitY = viewport.worldspaceHeight / viewport.height;
+      break;
+  }
+  viewportUnits(attributes.position, viewport.width, viewport.height,
+                viewportUnitX, viewportUnitY);
+
+  float alignOffsetX, alignOffsetY;
+  alignOffsets(attributes, viewport.width, viewport.height, alignOffsetX, alignOffsetY);
+
+  // Project the offset onto the plane through the bottom left corner
+  const Vec3 offset = viewportToWorld(camera,
+                                      int((alignOffsetX + attributes.offsetX) * viewportUnitX),
+                                      int((alignOffsetY + attributes.offsetY) * viewportUnitY),
+                                      depth);
+  Vec3 corner = {0.0f, 0.0f, 0.0f};
+  linePlaneIntersection(normalize(offset - camera.eye), camera.eye, camera.normal, nearBL, corner);
+
+  // Rotate and scale in the camera's plane
+  const Vec3& right = camera.right;
+  const Vec3& up = camera.up;
+  const float c = std::cos(attributes.rotate);
+  const float s = std::sin(attributes.rotate);
+  const float scaleX = attributes.size * attributes.width * worldspaceUnitX;
+  const float scaleY = attributes.size * attributes.height * worldspaceUnitY;
+  const Vec3 axisX = (right * c + up * s) * scaleX;
+  const Vec3 axisY = (up * c - right * s) * scaleY;
+
+  // Shapes are pivoted on their bottom left corner
+  Placement placement;
+  store(corner + (axisX + axisY) * 0.5f, placement.origin);
+  store(axisX, placement.axisX);
+  store(axisY, placement.axisY);
+  store(camera.back, placement.axisZ);
+  return placement;
+}
+
+ScreenPlacement screenPlacement(const LayoutAttributes& attributes, int width, int height)
+{
+  float unitX, unitY;
+  viewportUnits(attributes.position, width, height, unitX, unitY);
+  float alignX, alignY;
+  alignOffsets(attributes, width, height, alignX, alignY);
+
+  // Bottom left corner, truncated to a pixel like solvePlacement
+  const float cornerX = float(int((alignX + attributes.offsetX) * unitX));
+  const float cornerY = float(int((alignY + attributes.offsetY) * unitY));
+
+  // Shape axes in pixels, rotated about the corner
+  const float c = std::cos(attributes.rotate);
+  const float s = std::sin(attributes.rotate);
+  const float sizeX = attributes.size * attributes.width * unitX;
+  const float sizeY = attributes.size * attributes.height * unitY;
+  ScreenPlacement placement;
+  placement.axisX[0] = sizeX * c;
+  placement.axisX[1] = sizeX * s;
+  placement.axisY[0] = -sizeY * s;
+  placement.axisY[1] = sizeY * c;
+  placement.center[0] = cornerX + 0.5f * (placement.axisX[0] + placement.axisY[0]);
+  placement.center[1] = cornerY + 0.5f * (placement.axisX[1] + placement.axisY[1]);
+  return placement;
+}
+
+ScreenRect screenRect(const LayoutAttributes& attributes, int width, int height)
+{
+  const ScreenPlacement placement = screenPlacement(attributes, width, height);
+  const float extentX = 0.5f * (std::fabs(placement.axisX[0]) + std::fabs(placement.axisY[0]));
+  const float extentY = 0.5f * (std::fabs(placement.axisX[1]) + std::fabs(placement.axisY[1]));
+  return ScreenRect{placement.center[0] - extentX, placement.center[1] - extentY,
+                    placement.center[0] + extentX, placement.center[1] + extentY};
+}
+
+void pixelSize(const LayoutAttributes& attributes, int width, int height,
+               float& sizeX, float& sizeY)
+{
+  float unitX, unitY;
+  viewportUnits(attributes.position, width, height, unitX, unitY);
+  sizeX = attributes.size * attributes.width * unitX;
+  sizeY = attributes.size * attributes.height * unitY;
+}
+
+float pixelRadius(const LayoutAttributes& attributes, int width, int height)
+{
+  float sizeX, sizeY;
+  pixelSize(attributes, width, height, sizeX, sizeY);
+  return 0.5f * std::max(sizeX, sizeY);
+}
+
+Visibility cullLayout(const LayoutAttributes& attributes, int width, int height)
+{
+  const ScreenRect rect = screenRect(attributes, width, height);
+
+  // A pixel of slack keeps shapes touching the border from popping
+  if (rect.maxX < -1.0f || rect.maxY < -1.0f ||
+      rect.minX > width + 1.0f || rect.minY > height + 1.0f)
+    return Visibility::Offscreen;
+
+  // Shapes this small may still cover a pixel center, so only cull
+  // once they are well under one in both directions
+  if (rect.maxX - rect.minX < 0.5f && rect.maxY - rect.minY < 0.5f)
+    return Visibility::SubPixel;
+
+  return Visibility::Visible;
+}
+
+void placementBounds(const Placement& placement, Vec3& min, Vec3& max)
+{
+  // Unit shapes span -0.5 to 0.5 on both axes
+  float extent[3];
+  for (int i = 0; i < 3; ++i)
+    extent[i] = 0.5f * (std::fabs(placement.axisX[i]) + std::fabs(placement.axisY[i]));
+  min = Vec3{placement.origin[0] - extent[0], placement.origin[1] - extent[1], placement.origin[2] - extent[2]};
+  max = Vec3{placement.origin[0] + extent[0], placement.origin[1] + extent[1], placement.origin[2] + extent[2]};
+}
+
+Mat4 placementMatrix(const Placement& placement)
+{
+  return Mat4{{
+    {placement.axisX[0], placement.axisX[1], placement.axisX[2], 0.0f},
+    {placement.axisY[0], placement.axisY[1], placement.axisY[2], 0.0f},
+    {placement.axisZ[0], placement.axisZ[1], placement.axisZ[2], 0.0f},
+    {placement.origin[0], placement.origin[1], placement.origin[2], 1.0f},
+  }};
+}
+
+}
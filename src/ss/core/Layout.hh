@@ -0,0 +1,152 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_LAYOUT_HH
+#define SCREENSPACE_CORE_LAYOUT_HH
+
+#include "ss/Types.hh"
+#include "ss/core/Camera.hh"
+
+namespace screenspace {
+
+/// Attributes that decide where a pickable sits on screen.
+struct LayoutAttributes {
+  float size;                       // Size multiplier
+  float width;                      // Width of shape
+  float height;                     // Height of shape
+  int depth;                        // Draw order
+  Position position;                // Relative or absolute position
+  HorizontalAlign horizontalAlign;  // Horizontal alignment
+  VerticalAlign verticalAlign;      // Vertical alignment
+  float rotate;                     // Rotation in radians
+  float offsetX;                    // Horizontal offset
+  float offsetY;                    // Vertical offset
+};
+
+/// Viewport helper
+struct Viewport {
+  int width;               // Width of viewport in pixels
+  int height;              // Height of viewport in pixels
+  float worldspaceWidth;   // Distance in worldspace for height of viewport
+  float worldspaceHeight;  // Distance in worldspace for width of viewport
+};
+
+/// Placement of a unit shape on the camera's near plane, as a 2D
+/// affine into worldspace: world = origin + x * axisX + y * axisY.
+struct Placement {
+  float origin[3];  // Worldspace center of the shape
+  float axisX[3];   // Worldspace step per unit of x
+  float axisY[3];   // Worldspace step per unit of y
+  float axisZ[3];   // Camera facing axis, unit shapes have no depth
+};
+
+/// Rectangle a pickable covers, in pixels from the bottom left of the
+/// viewport.
+struct ScreenRect {
+  float minX;
+  float minY;
+  float maxX;
+  float maxY;
+};
+
+/// Placement of a unit shape on screen, in pixels from the bottom left
+/// of the viewport: pixel = center + x * axisX + y * axisY.
+struct ScreenPlacement {
+  float center[2];  // Center of the shape
+  float axisX[2];   // Pixel step per unit of x
+  float axisY[2];   // Pixel step per unit of y
+};
+
+/// Why a pickable does or doesn't produce pixels.
+enum class Visibility : unsigned char {
+  Visible,    // Drawn
+  Hidden,     // Switched off, fully transparent or in a hidden group
+  Offscreen,  // Entirely outside the viewport
+  SubPixel,   // Smaller than a pixel
+};
+
+/// Find intersection point on a plane.
+/// \param ray The normalized ray direction.
+/// \param origin The origin of the ray.
+/// \param normal The normal of the plane.
+/// \param coord Some point on the plane
+/// \param contact The intersection point in worldspace.
+/// \return If an intersection occurred.
+bool linePlaneIntersection(const Vec3& ray, const Vec3& origin,
+                           const Vec3& normal, const Vec3& coord,
+                           Vec3& contact);
+
+/// Compute where a pickable sits for a camera. Solves the rotate,
+/// scale and translate on the near plane directly in float.
+/// \param camera The camera.
+/// \param attributes Layout attributes of the pickable.
+/// \param viewport Will be populated with the viewport extents.
+/// \return The placement.
+Placement solvePlacement(const CameraBasis& camera,
+                         const LayoutAttributes& attributes,
+                         Viewport& viewport);
+
+/// Compute where a pickable sits on screen. Pickables are glued to the
+/// viewport, so only its size matters and not where the camera is.
+/// \param attributes Layout attributes of the pickable.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \return The placement.
+ScreenPlacement screenPlacement(const LayoutAttributes& attributes, int width, int height);
+
+/// Compute the pixel bounds of a pickable without solving its
+/// placement. Rotated shapes are bounded by their rotated rectangle.
+/// \param attributes Layout attributes of the pickable.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \return The bounds.
+ScreenRect screenRect(const LayoutAttributes& attributes, int width, int height);
+
+/// Unrotated size of a pickable on screen.
+/// \param attributes Layout attributes of the pickable.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \param sizeX Will be set to the width in pixels.
+/// \param sizeY Will be set to the height in pixels.
+void pixelSize(const LayoutAttributes& attributes, int width, int height,
+               float& sizeX, float& sizeY);
+
+/// Largest radius of a pickable's unit circle on screen.
+/// \param attributes Layout attributes of the pickable.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \return The radius in pixels.
+float pixelRadius(const LayoutAttributes& attributes, int width, int height);
+
+/// Test the pixel bounds of a pickable against the viewport.
+/// \param attributes Layout attributes of the pickable.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \return Visible, Offscreen or SubPixel.
+Visibility cullLayout(const LayoutAttributes& attributes, int width, int height);
+
+/// Worldspace bounds of a placed unit shape.
+/// \param placement The placement.
+/// \param min Will be set to the lower corner.
+/// \param max Will be set to the upper corner.
+void placementBounds(const Placement& placement, Vec3& min, Vec3& max);
+
+/// Expand a placement into a row-major unit-to-world matrix.
+/// \param placement The placement.
+/// \return The matrix.
+Mat4 placementMatrix(const Placement& placement);
+
+}
+
+#endif // SCREENSPACE_CORE_LAYOUT_HH
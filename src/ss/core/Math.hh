@@ -0,0 +1,57 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_MATH_HH
+#define SCREENSPACE_CORE_MATH_HH
+
+#include <cmath>
+
+namespace screenspace {
+
+/// Small float vector used by the layout core.
+struct Vec3 {
+  float x, y, z;
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return Vec3{a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return Vec3{a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3 operator*(const Vec3& a, float s) { return Vec3{a.x * s, a.y * s, a.z * s}; }
+inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float length(const Vec3& a) { return std::sqrt(dot(a, a)); }
+
+inline Vec3 normalize(const Vec3& a)
+{
+  const float len = length(a);
+  return len > 0.0f ? a * (1.0f / len) : a;
+}
+
+/// Row-major 4x4 float matrix, row vectors multiply on the left.
+struct Mat4 {
+  float m[4][4];
+};
+
+/// Transform a point by a matrix.
+/// \param p The point, w is 1.
+/// \param matrix The matrix.
+/// \return The transformed point.
+inline Vec3 transformPoint(const Vec3& p, const Mat4& matrix)
+{
+  return Vec3{p.x * matrix.m[0][0] + p.y * matrix.m[1][0] + p.z * matrix.m[2][0] + matrix.m[3][0],
+              p.x * matrix.m[0][1] + p.y * matrix.m[1][1] + p.z * matrix.m[2][1] + matrix.m[3][1],
+              p.x * matrix.m[0][2] + p.y * matrix.m[1][2] + p.z * matrix.m[2][2] + matrix.m[3][2]};
+}
+
+}
+
+#endif // SCREENSPACE_CORE_MATH_HH
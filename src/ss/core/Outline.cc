@@ -0,0 +1,680 @@
+#include "Outline.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+namespace screenspace {
+
+static const double kPi = 3.14159265358979323846;
+
+/// Curves stray no further than this from the true curve, as a
+/// fraction of the outline's size. A quarter pixel at 250 pixels.
+static const double kFlattenTolerance = 1e-3;
+
+/// Deepest curve subdivision, 65536 segments.
+static const int kMaxFlattenDepth = 16;
+
+/// Outlines with more points than this aren't triangulated, ear
+/// clipping slows down quadratically.
+static const std::size_t kMaxOutlinePoints = 20000;
+
+std::uint64_t outlineKey(const std::string& path, const std::vector<float>& points)
+{
+  if (path.empty() && points.empty())
+    return 0;
+
+  // FNV-1a over the content, tagged so a path and points never match
+  std::uint64_t key = 14695981039346656037ull;
+  const auto mix = [&key](const unsigned char* bytes, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      key ^= bytes[i];
+      key *= 1099511628211ull;
+    }
+  };
+  const unsigned char tag = path.empty() ? 'v' : 'p';
+  mix(&tag, 1);
+  if (path.empty())
+    mix(reinterpret_cast<const unsigned char*>(points.data()), points.size() * sizeof(float));
+  else
+    mix(reinterpret_cast<const unsigned char*>(path.data()), path.size());
+  return key ? key : 1;
+}
+
+namespace {
+
+/// Reads commands, numbers and flags out of SVG path data.
+class PathReader {
+public:
+  explicit PathReader(const char* path) : m_c(path) {}
+
+  /// Whether only separators are left.
+  bool atEnd()
+  {
+    skipSeparators();
+    return !*m_c;
+  }
+
+  /// Whether the next token is a command, read it if so.
+  /// \param command Will be set to the command.
+  bool command(char& command)
+  {
+    skipSeparators();
+    if (!*m_c || !std::strchr("MmLlHhVvCcSsQqTtAaZz", *m_c))
+      return false;
+    command = *m_c++;
+    return true;
+  }
+
+  /// Read a number. Locale independent, unlike strtod.
+  /// \param value Will be set to the number.
+  /// \return False if there is no number.
+  bool number(double& value)
+  {
+    skipSeparators();
+    const char* c = m_c;
+    double sign = 1.0;
+    if (*c == '+' || *c == '-')
+      sign = *c++ == '-' ? -1.0 : 1.0;
+
+    bool digits = false;
+    double result = 0.0;
+    while (*c >= '0' && *c <= '9')
+    {
+      result = result * 10.0 + (*c++ - '0');
+      digits = true;
+    }
+    if (*c == '.')
+    {
+      ++c;
+      double scale = 0.1;
+      while (*c >= '0' && *c <= '9')
+      {
+        result += (*c++ - '0') * scale;
+        scale *= 0.1;
+        digits = true;
+      }
+    }
+    if (!digits)
+      return false;
+
+    if (*c == 'e' || *c == 'E')
+    {
+      const char* exponentStart = c++;
+      int exponentSign = 1;
+      if (*c == '+' || *c == '-')
+        exponentSign = *c++ == '-' ? -1 : 1;
+      if (*c >= '0' && *c <= '9')
+      {
+        int exponent = 0;
+        while (*c >= '0' && *c <= '9')
+          exponent = std::min(exponent * 10 + (*c++ - '0'), 400);
+        result *= std::pow(10.0, exponentSign * exponent);
+      }
+      else
+        c = exponentStart;
+    }
+
+    value = sign * result;
+    m_c = c;
+    return true;
+  }
+
+  /// Read an arc flag, which may be written without separators.
+  /// \param value Will be set to the flag.
+  /// \return False if there is no flag.
+  bool flag(bool& value)
+  {
+    skipSeparators();
+    if (*m_c != '0' && *m_c != '1')
+      return false;
+    value = *m_c++ == '1';
+    return true;
+  }
+
+private:
+  void skipSeparators()
+  {
+    while (*m_c == ' ' || *m_c == '\t' || *m_c == '\n' || *m_c == '\r' || *m_c == ',')
+      ++m_c;
+  }
+
+  const char* m_c;
+};
+
+/// Extent of every point a path visits, control points included.
+struct BoundsSink {
+  double minX = std::numeric_limits<double>::max();
+  double minY = std::numeric_limits<double>::max();
+  double maxX = std::numeric_limits<double>::lowest();
+  double maxY = std::numeric_limits<double>::lowest();
+
+  void expand(double x, double y)
+  {
+    minX = std::min(minX, x);
+    minY = std::min(minY, y);
+    maxX = std::max(maxX, x);
+    maxY = std::max(maxY, y);
+  }
+  void moveTo(double x, double y) { expand(x, y); }
+  void lineTo(double x, double y) { expand(x, y); }
+  void cubicTo(double x1, double y1, double x2, double y2, double x, double y)
+  {
+    expand(x1, y1);
+    expand(x2, y2);
+    expand(x, y);
+  }
+  void close() {}
+};
+
+/// Flattens a path into contours, splitting curves adaptively.
+struct FlattenSink {
+  FlattenSink(Contours& contours, double tolerance)
+      : contours(contours), tolerance(tolerance), x(0.0), y(0.0) {}
+
+  void moveTo(double toX, double toY)
+  {
+    if (contours.empty() || !contours.back().empty())
+      contours.emplace_back();
+    add(toX, toY);
+  }
+  void lineTo(double toX, double toY) { add(toX, toY); }
+  void cubicTo(double x1, double y1, double x2, double y2, double x3, double y3)
+  {
+    flatten(x, y, x1, y1, x2, y2, x3, y3, 0);
+  }
+  void close() {}
+
+  void add(double toX, double toY)
+  {
+    // SVG's y axis points down
+    contours.back().push_back(float(toX));
+    contours.back().push_back(float(-toY));
+    x = toX;
+    y = toY;
+  }
+
+  /// Split a cubic until its control points are within tolerance of
+  /// its chord.
+  void flatten(double x0, double y0, double x1, double y1,
+               double x2, double y2, double x3, double y3, int depth)
+  {
+    const double dx = x3 - x0;
+    const double dy = y3 - y0;
+    const double chord = dx * dx + dy * dy;
+    bool flat;
+    if (chord < 1e-24)
+      flat = std::max(std::hypot(x1 - x0, y1 - y0), std::hypot(x2 - x0, y2 - y0)) <= tolerance;
+    else
+    {
+      const double d1 = std::fabs((x1 - x3) * dy - (y1 - y3) * dx);
+      const double d2 = std::fabs((x2 - x3) * dy - (y2 - y3) * dx);
+      flat = (d1 + d2) * (d1 + d2) <= tolerance * tolerance * chord;
+    }
+    if (flat || depth >= kMaxFlattenDepth)
+    {
+      add(x3, y3);
+      return;
+    }
+
+    // de Casteljau at the middle
+    const double x01 = 0.5 * (x0 + x1), y01 = 0.5 * (y0 + y1);
+    const double x12 = 0.5 * (x1 + x2), y12 = 0.5 * (y1 + y2);
+    const double x23 = 0.5 * (x2 + x3), y23 = 0.5 * (y2 + y3);
+    const double xa = 0.5 * (x01 + x12), ya = 0.5 * (y01 + y12);
+    const double xb = 0.5 * (x12 + x23), yb = 0.5 * (y12 + y23);
+    const double xm = 0.5 * (xa + xb), ym = 0.5 * (ya + yb);
+    flatten(x0, y0, x01, y01, xa, ya, xm, ym, depth + 1);
+    flatten(xm, ym, xb, yb, x23, y23, x3, y3, depth + 1);
+  }
+
+  Contours& contours;
+  double tolerance;
+  double x;  // Current point
+  double y;
+};
+
+/// Signed angle from one vector to another.
+double angleBetween(double ux, double uy, double vx, double vy)
+{
+  return std::atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+}
+
+/// Split an SVG elliptical arc into cubics of at most a quarter turn.
+template <typename Sink>
+void arcTo(Sink& sink, double x0, double y0, double rx, double ry, double rotation,
+           bool largeArc, bool sweep, double x, double y)
+{
+  if (x0 == x && y0 == y)
+    return;
+  rx = std::fabs(rx);
+  ry = std::fabs(ry);
+  if (rx == 0.0 || ry == 0.0)
+  {
+    sink.lineTo(x, y);
+    return;
+  }
+
+  // Endpoint to center parameterization, SVG implementation notes F.6.5
+  const double phi = rotation * kPi / 180.0;
+  const double c = std::cos(phi);
+  const double s = std::sin(phi);
+  const double hx = 0.5 * (x0 - x);
+  const double hy = 0.5 * (y0 - y);
+  const double x1 = c * hx + s * hy;
+  const double y1 = -s * hx + c * hy;
+
+  const double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+  if (lambda > 1.0)
+  {
+    rx *= std::sqrt(lambda);
+    ry *= std::sqrt(lambda);
+  }
+  const double numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+  const double denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+  const double root = std::sqrt(std::max(0.0, numerator / denominator)) * (largeArc == sweep ? -1.0 : 1.0);
+  const double centerX1 = root * rx * y1 / ry;
+  const double centerY1 = -root * ry * x1 / rx;
+  const double centerX = c * centerX1 - s * centerY1 + 0.5 * (x0 + x);
+  const double centerY = s * centerX1 + c * centerY1 + 0.5 * (y0 + y);
+
+  const double ux = (x1 - centerX1) / rx, uy = (y1 - centerY1) / ry;
+  const double vx = (-x1 - centerX1) / rx, vy = (-y1 - centerY1) / ry;
+  const double start = angleBetween(1.0, 0.0, ux, uy);
+  double delta = angleBetween(ux, uy, vx, vy);
+  if (!sweep && delta > 0.0)
+    delta -= 2.0 * kPi;
+  else if (sweep && delta < 0.0)
+    delta += 2.0 * kPi;
+
+  const int count = std::max(1, int(std::ceil(std::fabs(delta) / (0.5 * kPi) - 1e-9)));
+  const double step = delta / count;
+  const double k = 4.0 / 3.0 * std::tan(step / 4.0);
+  const auto point = [&](double t, double& px, double& py) {
+    px = centerX + rx * std::cos(t) * c - ry * std::sin(t) * s;
+    py = centerY + rx * std::cos(t) * s + ry * std::sin(t) * c;
+  };
+  const auto tangent = [&](double t, double& tx, double& ty) {
+    tx = -rx * std::sin(t) * c - ry * std::cos(t) * s;
+    ty = -rx * std::sin(t) * s + ry * std::cos(t) * c;
+  };
+  for (int i = 0; i < count; ++i)
+  {
+    const double t1 = start + step * i;
+    const double t2 = t1 + step;
+    double p1x, p1y, p2x, p2y, d1x, d1y, d2x, d2y;
+    point(t1, p1x, p1y);
+    point(t2, p2x, p2y);
+    tangent(t1, d1x, d1y);
+    tangent(t2, d2x, d2y);
+    if (i == count - 1)
+    {
+      p2x = x;
+      p2y = y;
+    }
+    sink.cubicTo(p1x + k * d1x, p1y + k * d1y, p2x - k * d2x, p2y - k * d2y, p2x, p2y);
+  }
+}
+
+/// Walk SVG path data, handing absolute moves, lines and cubics to a
+/// sink. Quadratics are raised to cubics and arcs split into them.
+/// \return False if the path doesn't parse.
+template <typename Sink>
+bool readPath(const char* path, Sink& sink)
+{
+  PathReader reader(path);
+  double x = 0.0, y = 0.0;            // Current point
+  double startX = 0.0, startY = 0.0;  // Start of the subpath
+  double controlX = 0.0, controlY = 0.0;  // Last control point for smooth curves
+  char previous = 0;
+  char command = 0;
+  bool started = false;
+  bool closed = false;
+
+  while (!reader.atEnd())
+  {
+    if (!reader.command(command) && (!command || command == 'Z' || command == 'z'))
+      return false;
+
+    const bool relative = command >= 'a' && command <= 'z';
+    const double baseX = relative ? x : 0.0;
+    const double baseY = relative ? y : 0.0;
+    const char upper = relative ? char(command - 'a' + 'A') : command;
+
+    if (upper != 'M' && upper != 'Z')
+    {
+      // Drawing needs a subpath, after a close it starts where the
+      // last one did
+      if (!started)
+        return false;
+      if (closed)
+      {
+        sink.moveTo(x, y);
+        closed = false;
+      }
+    }
+
+    switch (upper)
+    {
+      case 'M':
+      {
+        double toX, toY;
+        if (!reader.number(toX) || !reader.number(toY))
+          return false;
+        x = startX = baseX + toX;
+        y = startY = baseY + toY;
+        sink.moveTo(x, y);
+        started = true;
+        closed = false;
+        // Further pairs are lines
+        command = relative ? 'l' : 'L';
+        break;
+      }
+      case 'L':
+      case 'H':
+      case 'V':
+      {
+        double toX = x, toY = y;
+        if (upper == 'L')
+        {
+          if (!reader.number(toX) || !reader.number(toY))
+            return false;
+          toX += baseX;
+          toY += baseY;
+        }
+        else if (upper == 'H')
+        {
+          if (!reader.number(toX))
+            return false;
+          toX += baseX;
+        }
+        else
+        {
+          if (!reader.number(toY))
+            return false;
+          toY += baseY;
+        }
+        x = toX;
+        y = toY;
+        sink.lineTo(x, y);
+        break;
+      }
+      case 'C':
+      case 'S':
+      {
+        double x1, y1, x2, y2, toX, toY;
+        if (upper == 'C')
+        {
+          if (!reader.number(x1) || !reader.number(y1))
+            return false;
+          x1 += baseX;
+          y1 += baseY;
+        }
+        else
+        {
+          const bool smooth = previous == 'C' || previous == 'S';
+          x1 = smooth ? 2.0 * x - controlX : x;
+          y1 = smooth ? 2.0 * y - controlY : y;
+        }
+        if (!reader.number(x2) || !reader.number(y2) || !reader.number(toX) || !reader.number(toY))
+          return false;
+        x2 += baseX;
+        y2 += baseY;
+        toX += baseX;
+        toY += baseY;
+        sink.cubicTo(x1, y1, x2, y2, toX, toY);
+        controlX = x2;
+        controlY = y2;
+        x = toX;
+        y = toY;
+        break;
+      }
+      case 'Q':
+      case 'T':
+      {
+        double qx, qy, toX, toY;
+        if (upper == 'Q')
+        {
+          if (!reader.number(qx) || !reader.number(qy))
+            return false;
+          qx += baseX;
+          qy += baseY;
+        }
+        else
+        {
+          const bool smooth = previous == 'Q' || previous == 'T';
+          qx = smooth ? 2.0 * x - controlX : x;
+          qy = smooth ? 2.0 * y - controlY : y;
+        }
+        if (!reader.number(toX) || !reader.number(toY))
+          return false;
+        toX += baseX;
+        toY += baseY;
+        sink.cubicTo(x + 2.0 / 3.0 * (qx - x), y + 2.0 / 3.0 * (qy - y),
+                     toX + 2.0 / 3.0 * (qx - toX), toY + 2.0 / 3.0 * (qy - toY),
+                     toX, toY);
+        controlX = qx;
+        controlY = qy;
+        x = toX;
+        y = toY;
+        break;
+      }
+      case 'A':
+      {
+        double rx, ry, rotation, toX, toY;
+        bool largeArc, sweep;
+        if (!reader.number(rx) || !reader.number(ry) || !reader.number(rotation) ||
+            !reader.flag(largeArc) || !reader.flag(sweep) ||
+            !reader.number(toX) || !reader.number(toY))
+          return false;
+        toX += baseX;
+        toY += baseY;
+        arcTo(sink, x, y, rx, ry, rotation, largeArc, sweep, toX, toY);
+        x = toX;
+        y = toY;
+        break;
+      }
+      case 'Z':
+        if (!started)
+          return false;
+        sink.close();
+        x = startX;
+        y = startY;
+        closed = true;
+        break;
+    }
+    previous = upper;
+  }
+  return started;
+}
+
+/// Point of a contour being clipped.
+struct Vertex {
+  double x;
+  double y;
+};
+
+/// Twice the signed area of a triangle, positive when counterclockwise.
+double cross(const Vertex& a, const Vertex& b, const Vertex& c)
+{
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+/// Whether a point is inside or on a counterclockwise triangle.
+bool inTriangle(const Vertex& p, const Vertex& a, const Vertex& b, const Vertex& c)
+{
+  return cross(a, b, p) >= 0.0 && cross(b, c, p) >= 0.0 && cross(c, a, p) >= 0.0;
+}
+
+bool samePoint(const Vertex& a, const Vertex& b)
+{
+  return std::fabs(a.x - b.x) < 1e-9 && std::fabs(a.y - b.y) < 1e-9;
+}
+
+/// Ear clip one contour already fitted to the unit square.
+/// \param contour The contour.
+/// \param mesh Points and triangles are appended to it.
+void clipContour(std::vector<Vertex> contour, ShapeMesh& mesh)
+{
+  // Drop repeated points, including the closing one
+  std::vector<Vertex> points;
+  points.reserve(contour.size());
+  for (const Vertex& vertex : contour)
+    if (points.empty() || !samePoint(points.back(), vertex))
+      points.push_back(vertex);
+  while (points.size() > 1 && samePoint(points.front(), points.back()))
+    points.pop_back();
+  if (points.size() < 3)
+    return;
+
+  // Counterclockwise, like the unit shapes
+  double area = 0.0;
+  for (std::size_t i = 0; i < points.size(); ++i)
+  {
+    const Vertex& a = points[i];
+    const Vertex& b = points[(i + 1) % points.size()];
+    area += a.x * b.y - b.x * a.y;
+  }
+  if (std::fabs(area) < 1e-12)
+    return;
+  if (area < 0.0)
+    std::reverse(points.begin(), points.end());
+
+  const unsigned int base = static_cast<unsigned int>(mesh.points.size() / 2);
+  for (const Vertex& vertex : points)
+  {
+    mesh.points.push_back(float(vertex.x));
+    mesh.points.push_back(float(vertex.y));
+  }
+
+  // Remaining polygon as indices into points
+  std::vector<unsigned int> remaining(points.size());
+  for (std::size_t i = 0; i < remaining.size(); ++i)
+    remaining[i] = static_cast<unsigned int>(i);
+
+  const auto emit = [&](std::size_t i) {
+    const std::size_t n = remaining.size();
+    mesh.indices.push_back(base + remaining[(i + n - 1) % n]);
+    mesh.indices.push_back(base + remaining[i]);
+    mesh.indices.push_back(base + remaining[(i + 1) % n]);
+    remaining.erase(remaining.begin() + std::ptrdiff_t(i));
+  };
+
+  std::size_t i = 0;
+  std::size_t misses = 0;
+  while (remaining.size() > 3)
+  {
+    const std::size_t n = remaining.size();
+    const Vertex& a = points[remaining[(i + n - 1) % n]];
+    const Vertex& b = points[remaining[i]];
+    const Vertex& c = points[remaining[(i + 1) % n]];
+    const double turn = cross(a, b, c);
+
+    bool ear = turn > 0.0;
+    for (std::size_t j = 0; ear && j < n; ++j)
+    {
+      const Vertex& p = points[remaining[j]];
+      if (samePoint(p, a) || samePoint(p, b) || samePoint(p, c))
+        continue;
+      ear = !inTriangle(p, a, b, c);
+    }
+
+    if (ear)
+    {
+      emit(i);
+      misses = 0;
+      i %= remaining.size();
+      continue;
+    }
+
+    // Collinear points are dropped without a triangle
+    if (std::fabs(turn) < 1e-14)
+    {
+      remaining.erase(remaining.begin() + std::ptrdiff_t(i));
+      misses = 0;
+      i %= remaining.size();
+      continue;
+    }
+
+    i = (i + 1) % n;
+    if (++misses < n)
+      continue;
+
+    // No ear in a whole lap means the contour crosses itself. Clip the
+    // first convex corner anyway rather than give up on the rest.
+    std::size_t convex = n;
+    for (std::size_t j = 0; j < n && convex == n; ++j)
+      if (cross(points[remaining[(j + n - 1) % n]], points[remaining[j]], points[remaining[(j + 1) % n]]) > 0.0)
+        convex = j;
+    if (convex == n)
+      return;
+    emit(convex);
+    misses = 0;
+    i = 0;
+  }
+  if (remaining.size() == 3 && cross(points[remaining[0]], points[remaining[1]], points[remaining[2]]) > 0.0)
+    emit(1);
+}
+
+}
+
+bool flattenPath(const char* path, Contours& contours)
+{
+  contours.clear();
+  BoundsSink bounds;
+  if (!path || !readPath(path, bounds))
+    return false;
+
+  const double size = std::max(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
+  FlattenSink sink(contours, std::max(size * kFlattenTolerance, 1e-12));
+  readPath(path, sink);
+  if (!contours.empty() && contours.back().empty())
+    contours.pop_back();
+  return true;
+}
+
+bool triangulateOutline(const Contours& contours, ShapeMesh& mesh)
+{
+  mesh.points.clear();
+  mesh.indices.clear();
+
+  double minX = std::numeric_limits<double>::max();
+  double minY = std::numeric_limits<double>::max();
+  double maxX = std::numeric_limits<double>::lowest();
+  double maxY = std::numeric_limits<double>::lowest();
+  std::size_t numPoints = 0;
+  for (const std::vector<float>& contour : contours)
+  {
+    for (std::size_t i = 0; i + 1 < contour.size(); i += 2)
+    {
+      minX = std::min(minX, double(contour[i]));
+      maxX = std::max(maxX, double(contour[i]));
+      minY = std::min(minY, double(contour[i + 1]));
+      maxY = std::max(maxY, double(contour[i + 1]));
+    }
+    numPoints += contour.size() / 2;
+  }
+  if (numPoints < 3 || numPoints > kMaxOutlinePoints || maxX <= minX || maxY <= minY)
+    return false;
+
+  // Fill the unit square like the other shapes, width and height
+  // attributes size it
+  const double scaleX = 1.0 / (maxX - minX);
+  const double scaleY = 1.0 / (maxY - minY);
+  const double centerX = 0.5 * (minX + maxX);
+  const double centerY = 0.5 * (minY + maxY);
+  for (const std::vector<float>& contour : contours)
+  {
+    std::vector<Vertex> fitted;
+    fitted.reserve(contour.size() / 2);
+    for (std::size_t i = 0; i + 1 < contour.size(); i += 2)
+      fitted.push_back(Vertex{(contour[i] - centerX) * scaleX, (contour[i + 1] - centerY) * scaleY});
+    clipContour(fitted, mesh);
+  }
+  return !mesh.indices.empty();
+}
+
+}
@@ -0,0 +1,54 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_OUTLINE_HH
+#define SCREENSPACE_CORE_OUTLINE_HH
+
+#include "ss/core/Tessellate.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace screenspace {
+
+/// Closed outlines as x, y pairs, one list per contour.
+using Contours = std::vector<std::vector<float>>;
+
+/// Key of custom outline content, zero for none.
+/// \param path SVG path data, used if not empty.
+/// \param points x, y per point of a polygon, used without a path.
+/// \return The key.
+std::uint64_t outlineKey(const std::string& path, const std::vector<float>& points);
+
+/// Flatten SVG path data into contours. Every subpath is a contour,
+/// curves and arcs are split until they stray no further than a
+/// thousandth of the outline's size from the true curve. The y axis is
+/// flipped, so paths drawn in an SVG editor come out upright.
+/// \param path SVG path data.
+/// \param contours Will be populated with the contours.
+/// \return False if the path doesn't parse.
+bool flattenPath(const char* path, Contours& contours);
+
+/// Triangulate contours by ear clipping and fit them to the unit
+/// square. Contours are filled separately, one inside another doesn't
+/// cut a hole.
+/// \param contours The contours.
+/// \param mesh Will be populated with the mesh.
+/// \return False if no contour has any area.
+bool triangulateOutline(const Contours& contours, ShapeMesh& mesh);
+
+}
+
+#endif // SCREENSPACE_CORE_OUTLINE_HH
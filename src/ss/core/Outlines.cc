@@ -0,0 +1,134 @@
+#include "Outlines.hh"
+
+#include "ss/core/Outline.hh"
+#include "ss/core/Trace.hh"
+
+namespace screenspace {
+
+Outlines& Outlines::instance()
+{
+  static Outlines outlines;
+  return outlines;
+}
+
+Outlines::Outlines()
+    : m_mutex(),
+      m_wake(),
+      m_queue(),
+      m_entries(),
+      m_listener(),
+      m_thread(),
+      m_running(false),
+      m_generation(0),
+      m_version(1)
+{}
+
+Outlines::~Outlines()
+{
+  stop();
+}
+
+void Outlines::request(std::uint64_t key, const std::string& path, const std::vector<float>& points)
+{
+  if (key == 0)
+    return;
+
+  // A worker from before the last stop is joined outside the lock,
+  // it exits as soon as it sees the generation moved on
+  std::thread stopped;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.count(key))
+      return;
+    m_entries[key].state = OutlineState::Pending;
+    m_queue.push_back(Job{key, path, points});
+    if (!m_running)
+    {
+      stopped = std::move(m_thread);
+      m_running = true;
+      m_thread = std::thread(&Outlines::work, this, m_generation);
+    }
+  }
+  m_wake.notify_all();
+  if (stopped.joinable())
+    stopped.join();
+}
+
+OutlineState Outlines::find(std::uint64_t key, const ShapeMesh** mesh) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto iter = m_entries.find(key);
+  if (iter == m_entries.end())
+    return OutlineState::Failed;
+  if (iter->second.state == OutlineState::Ready)
+    *mesh = &iter->second.mesh;
+  return iter->second.state;
+}
+
+void Outlines::setListener(std::function<void()> listener)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_listener = std::move(listener);
+}
+
+void Outlines::stop()
+{
+  std::thread worker;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+    ++m_generation;
+    worker = std::move(m_thread);
+
+    // Dropped outlines are queued again when next requested
+    for (const Job& job : m_queue)
+      m_entries.erase(job.key);
+    m_queue.clear();
+  }
+  m_wake.notify_all();
+  if (worker.joinable())
+    worker.join();
+}
+
+void Outlines::work(unsigned int generation)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_wake.wait(lock, [this, generation] { return generation != m_generation || !m_queue.empty(); });
+    if (generation != m_generation)
+      return;
+
+    Job job = std::move(m_queue.front());
+    m_queue.pop_front();
+    lock.unlock();
+
+    ShapeMesh mesh;
+    bool ready;
+    {
+      ScopedTrace trace("triangulateOutline");
+      Contours contours;
+      if (job.path.empty())
+        contours.push_back(job.points);
+      else
+        flattenPath(job.path.c_str(), contours);
+      ready = triangulateOutline(contours, mesh);
+    }
+
+    lock.lock();
+    Entry& entry = m_entries[job.key];
+    entry.state = ready ? OutlineState::Ready : OutlineState::Failed;
+    entry.mesh = std::move(mesh);
+    m_version.fetch_add(1, std::memory_order_release);
+
+    if (m_queue.empty() && m_listener)
+    {
+      const std::function<void()> listener = m_listener;
+      lock.unlock();
+      listener();
+      lock.lock();
+    }
+  }
+}
+
+}
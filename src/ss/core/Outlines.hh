@@ -0,0 +1,110 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_OUTLINES_HH
+#define SCREENSPACE_CORE_OUTLINES_HH
+
+#include "ss/core/Tessellate.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace screenspace {
+
+/// Progress of a custom outline.
+enum class OutlineState : unsigned char {
+  Pending,  // Queued or being triangulated
+  Ready,    // Mesh available
+  Failed,   // Didn't parse or has no area
+};
+
+/// Custom outline meshes by content key, shared by every pickable
+/// drawing the same outline.
+///
+/// Flattening and triangulation run on a worker thread so opening a
+/// scene full of outlines never waits on them. Pickables draw a
+/// placeholder while theirs is pending. Every finished outline bumps
+/// the version so placeholders can be swapped, and the listener is
+/// called once the queue is empty.
+class Outlines {
+public:
+  static Outlines& instance();
+
+public:
+  ~Outlines();
+
+  /// Queue an outline unless its key is already known.
+  /// \param key Key from outlineKey.
+  /// \param path SVG path data, used if not empty.
+  /// \param points x, y per point of a polygon, used without a path.
+  void request(std::uint64_t key, const std::string& path, const std::vector<float>& points);
+
+  /// Look up an outline.
+  /// \param key Key from outlineKey.
+  /// \param mesh Will be set to the mesh once ready. It stays valid
+  /// until the process exits.
+  /// \return The state, failed for keys never requested.
+  OutlineState find(std::uint64_t key, const ShapeMesh** mesh) const;
+
+  /// Change counter, bumped whenever an outline finishes.
+  unsigned int version() const {return m_version.load(std::memory_order_acquire);}
+
+  /// Set what to call from the worker thread when the queue empties.
+  /// \param listener The callback, empty for none.
+  void setListener(std::function<void()> listener);
+
+  /// Drop queued outlines and stop the worker thread. It starts again
+  /// on the next request.
+  void stop();
+
+private:
+  Outlines();
+
+  /// Triangulate queued outlines until stopped.
+  /// \param generation Generation the worker was started in.
+  void work(unsigned int generation);
+
+  struct Job {
+    std::uint64_t key;
+    std::string path;
+    std::vector<float> points;
+  };
+
+  struct Entry {
+    OutlineState state;
+    ShapeMesh mesh;
+  };
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::deque<Job> m_queue;                            // Guarded by m_mutex
+  std::unordered_map<std::uint64_t, Entry> m_entries;  // Guarded by m_mutex
+  std::function<void()> m_listener;                   // Guarded by m_mutex
+  std::thread m_thread;
+  bool m_running;                                     // Guarded by m_mutex
+  unsigned int m_generation;                          // Bumped by stop, guarded by m_mutex
+  std::atomic<unsigned int> m_version;
+};
+
+}
+
+#endif // SCREENSPACE_CORE_OUTLINES_HH
@@ -0,0 +1,188 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_PREPARE_HH
+#define SCREENSPACE_CORE_PREPARE_HH
+
+#include "ss/core/Groups.hh"
+#include "ss/core/Layout.hh"
+#include "ss/core/Outlines.hh"
+#include "ss/core/Shapes.hh"
+#include "ss/core/Stages.hh"
+#include "ss/core/Stats.hh"
+#include "ss/core/Tessellate.hh"
+
+#include <cstddef>
+#include <utility>
+
+namespace screenspace {
+
+/// Stages rerun by prepareStages.
+struct PrepareResult {
+  bool style;     // Shape or color changed
+  bool matrix;    // Placement and geometry were prepared again
+  bool culled;    // Nothing to draw, later stages were skipped
+};
+
+/// Prepare geometry to be drawn. Circles pick the level of detail
+/// that keeps their outline within tolerance at their size on screen,
+/// parametric shapes share the cached mesh of their key and custom
+/// outlines draw a rectangle until theirs is triangulated.
+/// \param source Pickable inputs.
+/// \param data Will reference the unit geometry of its shape.
+template <typename Source, typename Data>
+void prepareGeometry(Source& source, Data& data)
+{
+  ScopedTimer timer(Stage::Geometry);
+  const auto& attributes = data.m_attributes;
+  const CameraBasis& camera = source.camera();
+  data.m_pending = false;
+  if (attributes.shape == Shape::Custom)
+  {
+    typename Source::GeometryRef outline{};
+    if (attributes.outline != 0)
+      data.m_pending = source.outlineGeometry(attributes.outline, &outline) == OutlineState::Pending;
+    data.m_geometry = outline ? std::move(outline) : source.unitGeometry(Shape::Rectangle, kDefaultCircleLod);
+    return;
+  }
+  if (isParametric(attributes.shape))
+  {
+    // Keys mostly survive camera moves, so the cache is only locked
+    // when they don't
+    float sizeX, sizeY;
+    pixelSize(attributes, camera.width, camera.height, sizeX, sizeY);
+    const ShapeKey key = shapeKey(attributes.shape, attributes.parameters,
+                                  sizeX, sizeY, source.circleTolerance());
+    if (!(data.m_geometry->key == key))
+      data.m_geometry = source.parametricGeometry(key);
+    return;
+  }
+
+  std::size_t lod = kDefaultCircleLod;
+  if (attributes.shape == Shape::Circle)
+    lod = circleLod(pixelRadius(attributes, camera.width, camera.height), source.circleTolerance());
+  data.m_geometry = source.unitGeometry(attributes.shape, lod);
+}
+
+/// Prepare placement for drawing.
+/// \param source Pickable inputs.
+/// \param data Will have its placement populated.
+template <typename Source, typename Data>
+void prepareMatrix(Source& source, Data& data)
+{
+  ScopedTimer timer(Stage::Matrix);
+  Viewport viewport;
+  data.m_placement = solvePlacement(source.camera(), data.m_attributes, viewport);
+  source.verifyPlacement(data, viewport);
+}
+
+/// Decide whether a pickable produces any pixels.
+/// \param camera The camera being drawn.
+/// \param attributes Pickable attribute snapshot.
+/// \return The visibility.
+template <typename Attributes>
+Visibility cullPickable(const CameraBasis& camera, const Attributes& attributes)
+{
+  if (!attributes.show || attributes.color.a <= 0.0f ||
+      Groups::instance().hidden(attributes.group))
+    return Visibility::Hidden;
+  return cullLayout(attributes, camera.width, camera.height);
+}
+
+/// Bring cached pickable data up to date for a camera, rerunning only
+/// the stages whose inputs changed since the last call. Pickables that
+/// won't produce pixels are culled before their placement is solved or
+/// their vertices are built.
+///
+/// The source is where inputs come from and outputs go, a pickable node
+/// in the plugin and a stand-in in the harness. It provides
+/// GeometryRef and Vertices types along with:
+///   layoutVersion(), styleVersion()   attribute change counters
+///   cameraKey(), transformKey()       hashes of the camera and transform
+///   camera()                          CameraBasis being drawn
+///   circleTolerance()                 largest circle error in pixels
+///   readAttributes(attributes)        attribute snapshot
+///   unitGeometry(shape, lod)          constant geometry
+///   parametricGeometry(key)           tessellated geometry
+///   outlineGeometry(key, &geometry)   custom outline geometry
+///   verifyPlacement(data, viewport)   optional cross-check
+///   prepareVertices(data, vertices)   unit geometry in pickable space
+///
+/// Data is the cached state, with m_attributes, m_placement,
+/// m_geometry, m_inputs, m_visibility, m_prepared and m_pending.
+/// \param source Pickable inputs.
+/// \param data Cached data to update.
+/// \param vertices If given, kept up to date with the geometry
+/// vertices in pickable space.
+/// \return The stages that were rerun.
+template <typename Source, typename Data>
+PrepareResult prepareStages(Source& source, Data& data, typename Source::Vertices* vertices)
+{
+  PrepareResult result = {false, false, data.m_visibility != Visibility::Visible};
+
+  // Gather inputs
+  const StageInputs inputs = {source.layoutVersion(),
+                               source.styleVersion(),
+                               source.cameraKey(),
+                               source.transformKey(),
+                               Groups::instance().version(),
+                               Outlines::instance().version()};
+
+  // Compare against previous inputs
+  const Stages stages = dirtyStages(data.m_inputs, inputs);
+  if (!anyStage(stages))
+    return result;
+
+  if (stages.read)
+    source.readAttributes(data.m_attributes);
+
+  // Prepare
+  result.style = stages.style;
+  if (stages.style || stages.layout || (stages.outline && data.m_pending))
+    data.m_prepared = false;
+
+  // Cull before anything proportional to the shape is done. A culled
+  // pickable keeps its stale geometry and placement until it is
+  // visible again.
+  if (stages.cull)
+    data.m_visibility = cullPickable(source.camera(), data.m_attributes);
+  result.culled = data.m_visibility != Visibility::Visible;
+  if (result.culled)
+  {
+    data.m_inputs = inputs;
+    return result;
+  }
+
+  // Level of detail follows the size on screen, so geometry is picked
+  // along with the placement
+  if (!data.m_prepared)
+  {
+    prepareGeometry(source, data);
+    prepareMatrix(source, data);
+    data.m_prepared = true;
+    result.matrix = true;
+  }
+  if (vertices)
+  {
+    ScopedTimer timer(Stage::Vertices);
+    source.prepareVertices(data, *vertices);
+  }
+
+  data.m_inputs = inputs;
+  return result;
+}
+
+}
+
+#endif // SCREENSPACE_CORE_PREPARE_HH
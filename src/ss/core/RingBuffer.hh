@@ -0,0 +1,97 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SCREENSPACE_CORE_RINGBUFFER_HH
+#define SCREENSPACE_CORE_RINGBUFFER_HH
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace screenspace {
+
+/// Fixed size queue between one producer thread and one consumer
+/// thread. Neither side locks or allocates, pushes fail when full
+/// rather than overwrite unread values.
+template <typename T>
+class RingBuffer {
+public:
+  /// \param capacity Number of values held, rounded up to a power of two.
+  explicit RingBuffer(std::size_t capacity)
+      : m_slots(roundUp(capacity)),
+        m_mask(m_slots.size() - 1),
+        m_head(0),
+        m_tail(0) {}
+
+  /// Add a value, producer side only.
+  /// \param value Value to copy in.
+  /// \return False if the buffer was full and the value dropped.
+  bool push(const T& value)
+  {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) == m_slots.size())
+      return false;
+    m_slots[head & m_mask] = value;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Take the oldest value, consumer side only.
+  /// \param value Will have the value copied out.
+  /// \return False if the buffer was empty.
+  bool pop(T& value)
+  {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire))
+      return false;
+    value = m_slots[tail & m_mask];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Whether nothing is waiting to be popped, either side.
+  bool empty() const
+  {
+    return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+  }
+
+  std::size_t capacity() const {return m_slots.size();}
+
+private:
+  static std::size_t roundUp(std::size_t capacity)
+  {
+    std::size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    return size;
+  }
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  std::vector<T> m_slots;
+  const std::size_t m_mask;
+
+  // Padded onto separate cache lines so both sides don't contend
+  char m_pad0[64];
+  std::atomic<std::size_t> m_head;  // Next slot to write
+  char m_pad1[64];
+  std::atomic<std::size_t> m_tail;  // Next slot to read
+  char m_pad2[64];
+};
+
+}
+
+#endif // SCREENSPACE_CORE_RINGBUFFER_HH
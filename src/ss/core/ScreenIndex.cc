@@ -0,0 +1,444 @@
+#include "ScreenIndex.hh"
+
+#include "ss/core/Outlines.hh"
+#include "ss/core/Shapes.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace screenspace {
+
+static const float kPi = 3.14159265358979f;
+
+/// Most cells along either side of the grid.
+static const int kMaxCells = 256;
+
+/// Outline error of curved edges tested as segments, in pixels.
+static const float kCurveTolerance = 0.05f;
+
+/// Triangles of a unit shape, borrowed from a constant table or a mesh.
+struct UnitTriangles {
+  const float* points;          // x, y per point
+  const unsigned int* indices;  // Triangle indices
+  std::size_t numIndices;       // Number of indices
+};
+
+/// Length of a 2D vector.
+static inline float length(const float v[2])
+{
+  return std::sqrt(v[0] * v[0] + v[1] * v[1]);
+}
+
+/// Bring a pixel into the unit space of a placement.
+/// \param placement The placement.
+/// \param x Pixels from the left of the viewport.
+/// \param y Pixels from the bottom of the viewport.
+/// \param u Will be set to the unit x.
+/// \param v Will be set to the unit y.
+/// \return False if the placement has no area.
+static bool toUnit(const ScreenPlacement& placement, float x, float y, float& u, float& v)
+{
+  const float det = placement.axisX[0] * placement.axisY[1] - placement.axisY[0] * placement.axisX[1];
+  if (std::fabs(det) < 1e-12f)
+    return false;
+  const float dx = x - placement.center[0];
+  const float dy = y - placement.center[1];
+  u = (dx * placement.axisY[1] - dy * placement.axisY[0]) / det;
+  v = (dy * placement.axisX[0] - dx * placement.axisX[1]) / det;
+  return true;
+}
+
+/// Whether a unit point lies in a counterclockwise triangle.
+static bool inTriangle(const float* a, const float* b, const float* c, float u, float v)
+{
+  const float ab = (b[0] - a[0]) * (v - a[1]) - (b[1] - a[1]) * (u - a[0]);
+  const float bc = (c[0] - b[0]) * (v - b[1]) - (c[1] - b[1]) * (u - b[0]);
+  const float ca = (a[0] - c[0]) * (v - c[1]) - (a[1] - c[1]) * (u - c[0]);
+  return (ab >= 0.0f && bc >= 0.0f && ca >= 0.0f) ||
+         (ab <= 0.0f && bc <= 0.0f && ca <= 0.0f);
+}
+
+/// Whether a unit point lies in any triangle.
+static bool inTriangles(const UnitTriangles& triangles, float u, float v)
+{
+  for (std::size_t i = 0; i + 2 < triangles.numIndices; i += 3)
+    if (inTriangle(triangles.points + triangles.indices[i] * 2,
+                   triangles.points + triangles.indices[i + 1] * 2,
+                   triangles.points + triangles.indices[i + 2] * 2, u, v))
+      return true;
+  return false;
+}
+
+/// Triangles of a shape that is drawn from a constant table.
+static UnitTriangles constantTriangles(Shape shape)
+{
+  const UnitShape& unit = unitShape(shape);
+  return UnitTriangles{&unit.points[0][0], unit.indices, unit.numIndices};
+}
+
+/// Find the mesh of a custom outline.
+/// \param key Key of the outline.
+/// \param triangles Will be set to the mesh triangles, or the
+/// rectangle drawn while the outline is pending or if it failed.
+static void outlineTriangles(std::uint64_t key, UnitTriangles& triangles)
+{
+  const ShapeMesh* mesh = nullptr;
+  if (key != 0 && Outlines::instance().find(key, &mesh) == OutlineState::Ready)
+    triangles = UnitTriangles{mesh->points.data(), mesh->indices.data(), mesh->indices.size()};
+  else
+    triangles = constantTriangles(Shape::Rectangle);
+}
+
+/// Whether a unit point lies in a rounded rectangle whose corners are
+/// round on screen, like the tessellated one.
+static bool inRoundedRectangle(float u, float v, float cornerRadius, float aspect)
+{
+  const float shorter = 0.5f * cornerRadius * std::min(aspect, 1.0f);
+  const float radiusX = shorter / aspect;
+  const float radiusY = shorter;
+  const float dx = std::fabs(u) - (0.5f - radiusX);
+  const float dy = std::fabs(v) - (0.5f - radiusY);
+  if (dx <= 0.0f || dy <= 0.0f)
+    return true;
+  return (dx / radiusX) * (dx / radiusX) + (dy / radiusY) * (dy / radiusY) <= 1.0f;
+}
+
+/// Whether a unit point lies in a ring, arc or pie slice.
+static bool inRing(float u, float v, float innerRadius, float arcAngle)
+{
+  const float distance = u * u + v * v;
+  const float inner = 0.5f * std::min(std::max(innerRadius, 0.0f), 1.0f);
+  if (distance > 0.25f || distance < inner * inner)
+    return false;
+  if (arcAngle >= 360.0f)
+    return true;
+  float angle = std::atan2(v, u);
+  if (angle < 0.0f)
+    angle += 2.0f * kPi;
+  return angle <= arcAngle * kPi / 180.0f;
+}
+
+/// Whether a unit point lies in a regular polygon with a corner at the
+/// top, tested against the edge facing it.
+static bool inPolygon(float u, float v, int sides)
+{
+  const float step = 2.0f * kPi / float(sides);
+  float angle = std::atan2(v, u) - 0.5f * kPi;
+  if (angle < 0.0f)
+    angle += 2.0f * kPi;
+  const float edge = 0.5f * kPi + (std::floor(angle / step) + 0.5f) * step;
+  return u * std::cos(edge) + v * std::sin(edge) <= 0.5f * std::cos(0.5f * step);
+}
+
+/// Whether a unit point lies in a pickable's shape.
+static bool unitContains(const ScreenEntry& entry, float u, float v)
+{
+  if (std::fabs(u) > 0.5f || std::fabs(v) > 0.5f)
+    return false;
+
+  const float aspect = length(entry.placement.axisX) / std::max(length(entry.placement.axisY), 1e-6f);
+  switch (entry.shape)
+  {
+    case Shape::Circle:
+      return u * u + v * v <= 0.25f;
+    case Shape::Rectangle:
+      return true;
+    case Shape::Triangle:
+      return inTriangles(constantTriangles(Shape::Triangle), u, v);
+    case Shape::RoundedRectangle:
+      return inRoundedRectangle(u, v, std::min(std::max(entry.parameters.cornerRadius, 0.0f), 1.0f), aspect);
+    case Shape::Capsule:
+      return inRoundedRectangle(u, v, 1.0f, aspect);
+    case Shape::Ring:
+      return inRing(u, v, entry.parameters.innerRadius, entry.parameters.arcAngle);
+    case Shape::Polygon:
+      return inPolygon(u, v, shapeKey(entry.shape, entry.parameters, 1.0f, 1.0f, 1.0f).sides);
+    case Shape::Custom:
+    {
+      UnitTriangles triangles;
+      outlineTriangles(entry.outline, triangles);
+      return inTriangles(triangles, u, v);
+    }
+  }
+  return false;
+}
+
+bool containsPoint(const ScreenEntry& entry, float x, float y)
+{
+  float u, v;
+  return toUnit(entry.placement, x, y, u, v) && unitContains(entry, u, v);
+}
+
+/// Whether a segment touches a rectangle, clipped Liang-Barsky style.
+static bool segmentTouchesRect(float x0, float y0, float x1, float y1, const ScreenRect& rect)
+{
+  const float dx = x1 - x0;
+  const float dy = y1 - y0;
+  const float p[4] = {-dx, dx, -dy, dy};
+  const float q[4] = {x0 - rect.minX, rect.maxX - x0, y0 - rect.minY, rect.maxY - y0};
+  float enter = 0.0f;
+  float leave = 1.0f;
+  for (int i = 0; i < 4; ++i)
+  {
+    if (p[i] == 0.0f)
+    {
+      if (q[i] < 0.0f)
+        return false;
+      continue;
+    }
+    const float t = q[i] / p[i];
+    if (p[i] < 0.0f)
+      enter = std::max(enter, t);
+    else
+      leave = std::min(leave, t);
+    if (enter > leave)
+      return false;
+  }
+  return true;
+}
+
+/// Squared distance from the unit origin to a unit segment.
+static float originDistance(float u0, float v0, float u1, float v1)
+{
+  const float du = u1 - u0;
+  const float dv = v1 - v0;
+  const float lengthSquared = du * du + dv * dv;
+  float t = lengthSquared > 0.0f ? -(u0 * du + v0 * dv) / lengthSquared : 0.0f;
+  t = std::min(std::max(t, 0.0f), 1.0f);
+  const float u = u0 + du * t;
+  const float v = v0 + dv * t;
+  return u * u + v * v;
+}
+
+bool overlapsRect(const ScreenEntry& entry, const ScreenRect& rect)
+{
+  const ScreenPlacement& placement = entry.placement;
+  const float corners[4][2] = {{rect.minX, rect.minY}, {rect.maxX, rect.minY},
+                               {rect.maxX, rect.maxY}, {rect.minX, rect.maxY}};
+  const bool centerInside = placement.center[0] >= rect.minX && placement.center[0] <= rect.maxX &&
+                            placement.center[1] >= rect.minY && placement.center[1] <= rect.maxY;
+
+  // Circles and ellipses are exact, the rectangle reaches them if its
+  // outline comes within the radius of the center in unit space
+  float unitCorners[4][2];
+  for (int i = 0; i < 4; ++i)
+    if (!toUnit(placement, corners[i][0], corners[i][1], unitCorners[i][0], unitCorners[i][1]))
+      return false;
+  if (entry.shape == Shape::Circle)
+  {
+    if (centerInside)
+      return true;
+    for (int i = 0; i < 4; ++i)
+    {
+      const float* a = unitCorners[i];
+      const float* b = unitCorners[(i + 1) % 4];
+      if (originDistance(a[0], a[1], b[0], b[1]) <= 0.25f)
+        return true;
+    }
+    return false;
+  }
+
+  // The rectangle lies inside the shape
+  for (int i = 0; i < 4; ++i)
+    if (unitContains(entry, unitCorners[i][0], unitCorners[i][1]))
+      return true;
+
+  // Or an edge of the shape reaches into the rectangle, curved edges
+  // are split finely enough to stay within a fraction of a pixel
+  ShapeMesh mesh;
+  UnitTriangles triangles;
+  if (entry.shape == Shape::Custom)
+    outlineTriangles(entry.outline, triangles);
+  else if (isParametric(entry.shape))
+  {
+    const ShapeKey key = shapeKey(entry.shape, entry.parameters, length(placement.axisX),
+                                  length(placement.axisY), kCurveTolerance);
+    tessellate(key, mesh);
+    triangles = UnitTriangles{mesh.points.data(), mesh.indices.data(), mesh.indices.size()};
+  }
+  else
+    triangles = constantTriangles(entry.shape);
+
+  for (std::size_t i = 0; i + 2 < triangles.numIndices; i += 3)
+  {
+    float pixels[3][2];
+    for (std::size_t corner = 0; corner < 3; ++corner)
+    {
+      const float* point = triangles.points + triangles.indices[i + corner] * 2;
+      pixels[corner][0] = placement.center[0] + point[0] * placement.axisX[0] + point[1] * placement.axisY[0];
+      pixels[corner][1] = placement.center[1] + point[0] * placement.axisX[1] + point[1] * placement.axisY[1];
+    }
+    for (std::size_t edge = 0; edge < 3; ++edge)
+    {
+      const float* a = pixels[edge];
+      const float* b = pixels[(edge + 1) % 3];
+      if (segmentTouchesRect(a[0], a[1], b[0], b[1], rect))
+        return true;
+    }
+  }
+  return false;
+}
+
+/// Pixel bounds of a placed unit shape.
+static ScreenRect placementRect(const ScreenPlacement& placement)
+{
+  const float extentX = 0.5f * (std::fabs(placement.axisX[0]) + std::fabs(placement.axisY[0]));
+  const float extentY = 0.5f * (std::fabs(placement.axisX[1]) + std::fabs(placement.axisY[1]));
+  return ScreenRect{placement.center[0] - extentX, placement.center[1] - extentY,
+                    placement.center[0] + extentX, placement.center[1] + extentY};
+}
+
+/// Whether two rectangles touch.
+static inline bool touches(const ScreenRect& a, const ScreenRect& b)
+{
+  return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+}
+
+ScreenIndex::ScreenIndex()
+    : m_width(1),
+      m_height(1),
+      m_columns(1),
+      m_rows(1),
+      m_cellWidth(1.0f),
+      m_cellHeight(1.0f),
+      m_entries(),
+      m_rects(),
+      m_cellStarts(2, 0),
+      m_cellEntries()
+{}
+
+void ScreenIndex::reset(int width, int height)
+{
+  m_width = std::max(width, 1);
+  m_height = std::max(height, 1);
+  m_entries.clear();
+  m_rects.clear();
+  m_cellStarts.assign(2, 0);
+  m_cellEntries.clear();
+  m_columns = 1;
+  m_rows = 1;
+  m_cellWidth = float(m_width);
+  m_cellHeight = float(m_height);
+}
+
+void ScreenIndex::add(const ScreenEntry& entry)
+{
+  const ScreenRect rect = placementRect(entry.placement);
+  const ScreenRect viewport = {0.0f, 0.0f, float(m_width), float(m_height)};
+  if (!touches(rect, viewport))
+    return;
+  m_entries.push_back(entry);
+  m_rects.push_back(rect);
+}
+
+bool ScreenIndex::cellRange(const ScreenRect& rect, int& minColumn, int& minRow,
+                            int& maxColumn, int& maxRow) const
+{
+  const ScreenRect viewport = {0.0f, 0.0f, float(m_width), float(m_height)};
+  if (!touches(rect, viewport))
+    return false;
+  minColumn = std::min(std::max(int(rect.minX / m_cellWidth), 0), m_columns - 1);
+  maxColumn = std::min(std::max(int(rect.maxX / m_cellWidth), 0), m_columns - 1);
+  minRow = std::min(std::max(int(rect.minY / m_cellHeight), 0), m_rows - 1);
+  maxRow = std::min(std::max(int(rect.maxY / m_cellHeight), 0), m_rows - 1);
+  return true;
+}
+
+void ScreenIndex::build()
+{
+  // About one pickable per cell, with square-ish cells
+  const float count = float(std::max<std::size_t>(m_entries.size(), 1));
+  const float aspect = float(m_width) / float(m_height);
+  m_columns = std::min(std::max(int(std::ceil(std::sqrt(count * aspect))), 1), kMaxCells);
+  m_rows = std::min(std::max(int(std::ceil(std::sqrt(count / aspect))), 1), kMaxCells);
+  m_cellWidth = float(m_width) / float(m_columns);
+  m_cellHeight = float(m_height) / float(m_rows);
+
+  // Count the entries of each cell, then fill them in place
+  const std::size_t numCells = std::size_t(m_columns) * std::size_t(m_rows);
+  m_cellStarts.assign(numCells + 1, 0);
+  int minColumn, minRow, maxColumn, maxRow;
+  for (const ScreenRect& rect : m_rects)
+  {
+    if (!cellRange(rect, minColumn, minRow, maxColumn, maxRow))
+      continue;
+    for (int row = minRow; row <= maxRow; ++row)
+      for (int column = minColumn; column <= maxColumn; ++column)
+        ++m_cellStarts[std::size_t(row) * m_columns + column + 1];
+  }
+  for (std::size_t cell = 0; cell < numCells; ++cell)
+    m_cellStarts[cell + 1] += m_cellStarts[cell];
+
+  m_cellEntries.resize(m_cellStarts[numCells]);
+  std::vector<std::uint32_t> cursors(m_cellStarts.begin(), m_cellStarts.end() - 1);
+  for (std::size_t i = 0; i < m_rects.size(); ++i)
+  {
+    if (!cellRange(m_rects[i], minColumn, minRow, maxColumn, maxRow))
+      continue;
+    for (int row = minRow; row <= maxRow; ++row)
+      for (int column = minColumn; column <= maxColumn; ++column)
+        m_cellEntries[cursors[std::size_t(row) * m_columns + column]++] = static_cast<std::uint32_t>(i);
+  }
+}
+
+void ScreenIndex::sortHits(std::vector<std::uint32_t>& hits, std::vector<std::uint64_t>& ids) const
+{
+  // Ties keep the order pickables were added in
+  std::stable_sort(hits.begin(), hits.end(), [this](std::uint32_t a, std::uint32_t b) {
+    return m_entries[a].depth < m_entries[b].depth;
+  });
+  ids.clear();
+  ids.reserve(hits.size());
+  for (std::uint32_t hit : hits)
+    ids.push_back(m_entries[hit].id);
+}
+
+void ScreenIndex::findAt(float x, float y, std::vector<std::uint64_t>& ids) const
+{
+  ids.clear();
+  int minColumn, minRow, maxColumn, maxRow;
+  if (!cellRange(ScreenRect{x, y, x, y}, minColumn, minRow, maxColumn, maxRow))
+    return;
+
+  std::vector<std::uint32_t> hits;
+  const std::size_t cell = std::size_t(minRow) * m_columns + minColumn;
+  for (std::uint32_t slot = m_cellStarts[cell]; slot < m_cellStarts[cell + 1]; ++slot)
+  {
+    const std::uint32_t entry = m_cellEntries[slot];
+    const ScreenRect& rect = m_rects[entry];
+    if (x >= rect.minX && x <= rect.maxX && y >= rect.minY && y <= rect.maxY &&
+        containsPoint(m_entries[entry], x, y))
+      hits.push_back(entry);
+  }
+  sortHits(hits, ids);
+}
+
+void ScreenIndex::findInRect(const ScreenRect& rect, std::vector<std::uint64_t>& ids) const
+{
+  ids.clear();
+  const ScreenRect query = {std::min(rect.minX, rect.maxX), std::min(rect.minY, rect.maxY),
+                            std::max(rect.minX, rect.maxX), std::max(rect.minY, rect.maxY)};
+  int minColumn, minRow, maxColumn, maxRow;
+  if (!cellRange(query, minColumn, minRow, maxColumn, maxRow))
+    return;
+
+  // Pickables spanning several cells are found once per cell
+  std::vector<std::uint32_t> candidates;
+  for (int row = minRow; row <= maxRow; ++row)
+    for (int column = minColumn; column <= maxColumn; ++column)
+    {
+      const std::size_t cell = std::size_t(row) * m_columns + column;
+      candidates.insert(candidates.end(), m_cellEntries.begin() + m_cellStarts[cell],
+                        m_cellEntries.begin() + m_cellStarts[cell + 1]);
+    }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  std::vector<std::uint32_t> hits;
+  for (std::uint32_t entry : candidates)
+    if (touches(m_rects[entry], query) && overlapsRect(m_entries[entry], query))
+      hits.push_back(entry);
+  sortHits(hits, ids);
+}
+
+}
@@ -0,0 +1,118 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_SCREENINDEX_HH
+#define SCREENSPACE_CORE_SCREENINDEX_HH
+
+#include "ss/Types.hh"
+#include "ss/core/Layout.hh"
+#include "ss/core/Tessellate.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace screenspace {
+
+/// A pickable as placed in one viewport, everything its exact hit
+/// tests need.
+struct ScreenEntry {
+  std::uint64_t id;             // Caller's handle for the pickable
+  ScreenPlacement placement;    // Unit shape to pixels
+  Shape shape;                  // Shape to test against
+  ShapeParameters parameters;   // Parametric shape parameters
+  std::uint64_t outline;        // Key of the custom outline, zero for none
+  int depth;                    // Draw order, lower is on top
+};
+
+/// Check if a pixel falls inside a pickable's shape. Circles and
+/// curved edges are tested against the true curve, not the drawn
+/// segments.
+/// \param entry The pickable.
+/// \param x Pixels from the left of the viewport.
+/// \param y Pixels from the bottom of the viewport.
+/// \return True if inside.
+bool containsPoint(const ScreenEntry& entry, float x, float y);
+
+/// Check if a rectangle touches a pickable's shape.
+/// \param entry The pickable.
+/// \param rect The rectangle in pixels.
+/// \return True if they overlap.
+bool overlapsRect(const ScreenEntry& entry, const ScreenRect& rect);
+
+/// Uniform grid over the pickables of one viewport, for resolving
+/// clicks and marquee drags without testing every pickable.
+///
+/// Rebuilt from scratch whenever a pickable changes rather than
+/// updated in place, a single pass over a few thousand rectangles.
+/// Cells are sized so each holds about one pickable, so a click only
+/// tests the few pickables under it whatever their number.
+class ScreenIndex {
+public:
+  ScreenIndex();
+
+  /// Start over for a viewport.
+  /// \param width Width of viewport in pixels.
+  /// \param height Height of viewport in pixels.
+  void reset(int width, int height);
+
+  /// Add a pickable, skipped if it lies entirely outside the viewport.
+  /// \param entry The pickable.
+  void add(const ScreenEntry& entry);
+
+  /// Bin the added pickables into the grid, call before querying.
+  void build();
+
+  /// Find the pickables under a pixel.
+  /// \param x Pixels from the left of the viewport.
+  /// \param y Pixels from the bottom of the viewport.
+  /// \param ids Will be populated with the ids of the pickables, the
+  /// one on top first.
+  void findAt(float x, float y, std::vector<std::uint64_t>& ids) const;
+
+  /// Find the pickables touching a rectangle.
+  /// \param rect The rectangle in pixels.
+  /// \param ids Will be populated with the ids of the pickables, the
+  /// one on top first.
+  void findInRect(const ScreenRect& rect, std::vector<std::uint64_t>& ids) const;
+
+  inline int width() const {return m_width;}
+  inline int height() const {return m_height;}
+  inline std::size_t size() const {return m_entries.size();}
+
+private:
+  /// Cells a rectangle covers, clamped to the grid.
+  /// \return False if the rectangle misses the grid.
+  bool cellRange(const ScreenRect& rect, int& minColumn, int& minRow,
+                 int& maxColumn, int& maxRow) const;
+
+  /// Order hits by draw order and hand out their ids.
+  void sortHits(std::vector<std::uint32_t>& hits, std::vector<std::uint64_t>& ids) const;
+
+private:
+  int m_width;
+  int m_height;
+  int m_columns;
+  int m_rows;
+  float m_cellWidth;
+  float m_cellHeight;
+  std::vector<ScreenEntry> m_entries;
+  std::vector<ScreenRect> m_rects;           // Pixel bounds per entry
+  std::vector<std::uint32_t> m_cellStarts;   // First slot of each cell, one past the end last
+  std::vector<std::uint32_t> m_cellEntries;  // Entry indices, cell after cell
+};
+
+}
+
+#endif // SCREENSPACE_CORE_SCREENINDEX_HH
@@ -0,0 +1,111 @@
+#include "Shapes.hh"
+
+#include <cmath>
+
+namespace screenspace {
+
+static const double kPi = 3.14159265358979323846;
+
+/// Segments per circle level of detail, coarsest first.
+static const std::size_t kCircleSegments[kNumCircleLods] = {8, 12, 16, 24, 32, 48, 64, 96, 128};
+static const std::size_t kMaxCircleSegments = 128;
+
+/// Circle outlines of radius 0.5, each a fan around the center point.
+/// Built once on first use, every pickable shares them.
+struct CircleTables {
+  float points[kNumCircleLods][kMaxCircleSegments + 1][2];
+  unsigned int indices[kNumCircleLods][kMaxCircleSegments * 3];
+  UnitShape shapes[kNumCircleLods];
+
+  CircleTables()
+  {
+    for (std::size_t lod = 0; lod < kNumCircleLods; ++lod)
+    {
+      const std::size_t segments = kCircleSegments[lod];
+      float (*lodPoints)[2] = points[lod];
+      unsigned int* lodIndices = indices[lod];
+
+      lodPoints[0][0] = 0.0f;
+      lodPoints[0][1] = 0.0f;
+      for (std::size_t i = 0; i < segments; ++i)
+      {
+        const double angle = 2.0 * kPi * double(i) / double(segments);
+        lodPoints[i + 1][0] = float(0.5 * std::cos(angle));
+        lodPoints[i + 1][1] = float(0.5 * std::sin(angle));
+
+        lodIndices[i * 3] = 0;
+        lodIndices[i * 3 + 1] = static_cast<unsigned int>(i + 1);
+        lodIndices[i * 3 + 2] = static_cast<unsigned int>((i + 1) % segments + 1);
+      }
+      shapes[lod] = UnitShape{lodPoints, segments + 1, lodIndices, segments * 3};
+    }
+  }
+};
+
+static const CircleTables& circleTables()
+{
+  static const CircleTables tables;
+  return tables;
+}
+
+static const float kRectanglePoints[][2] = {
+  {-0.5f, -0.5f},
+  {0.5f, -0.5f},
+  {0.5f, 0.5f},
+  {-0.5f, 0.5f},
+};
+
+static const unsigned int kRectangleIndices[] = {0, 1, 2, 0, 2, 3};
+
+/// Apex height is sin(0.5).
+static const float kTrianglePoints[][2] = {
+  {-0.5f, -0.5f},
+  {0.5f, -0.5f},
+  {0.0f, 0.479425539f},
+};
+
+static const unsigned int kTriangleIndices[] = {0, 1, 2};
+
+#define SS_UNIT_SHAPE(points, indices) \
+  UnitShape{points, sizeof(points) / sizeof(points[0]), \
+            indices, sizeof(indices) / sizeof(indices[0])}
+
+static const UnitShape kRectangle = SS_UNIT_SHAPE(kRectanglePoints, kRectangleIndices);
+static const UnitShape kTriangle = SS_UNIT_SHAPE(kTrianglePoints, kTriangleIndices);
+
+#undef SS_UNIT_SHAPE
+
+const UnitShape& unitShape(Shape shape, std::size_t lod)
+{
+  switch (shape)
+  {
+    case Shape::Circle:
+      return circleTables().shapes[lod < kNumCircleLods ? lod : kNumCircleLods - 1];
+    case Shape::Rectangle:
+      return kRectangle;
+    case Shape::Triangle:
+      return kTriangle;
+    default:
+      break;
+  }
+  return kRectangle;
+}
+
+std::size_t circleSegments(std::size_t lod)
+{
+  return kCircleSegments[lod < kNumCircleLods ? lod : kNumCircleLods - 1];
+}
+
+std::size_t circleLod(float radius, float tolerance)
+{
+  // A chord strays r * (1 - cos(pi / n)) from the circle at its middle
+  for (std::size_t lod = 0; lod < kNumCircleLods; ++lod)
+  {
+    const double error = radius * (1.0 - std::cos(kPi / double(kCircleSegments[lod])));
+    if (error <= tolerance)
+      return lod;
+  }
+  return kNumCircleLods - 1;
+}
+
+}
@@ -0,0 +1,60 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_SHAPES_HH
+#define SCREENSPACE_CORE_SHAPES_HH
+
+#include "ss/Types.hh"
+
+#include <cstddef>
+
+namespace screenspace {
+
+/// Constant unit sized shape centered on the origin, as triangles.
+struct UnitShape {
+  const float (*points)[2];     // Points in xy
+  std::size_t numPoints;        // Number of points
+  const unsigned int* indices;  // Triangle indices
+  std::size_t numIndices;       // Number of indices
+};
+
+/// Circle levels of detail, from 8 to 128 segments.
+static const std::size_t kNumCircleLods = 9;
+
+/// Level of detail of the 16 segment circle, used when the size on
+/// screen isn't known.
+static const std::size_t kDefaultCircleLod = 2;
+
+/// Unit geometry of a shape.
+/// \param shape The shape.
+/// \param lod Level of detail, only used by circles.
+/// \return Constant tables of the shape, the rectangle for parametric
+/// shapes which are tessellated instead.
+const UnitShape& unitShape(Shape shape, std::size_t lod = kDefaultCircleLod);
+
+/// Number of segments of a circle level of detail.
+/// \param lod Level of detail.
+/// \return The number of segments.
+std::size_t circleSegments(std::size_t lod);
+
+/// Pick the coarsest circle whose outline strays no further than a
+/// tolerance from the true circle.
+/// \param radius Radius on screen in pixels.
+/// \param tolerance Largest allowed error in pixels.
+/// \return The level of detail.
+std::size_t circleLod(float radius, float tolerance);
+
+}
+
+#endif // SCREENSPACE_CORE_SHAPES_HH
@@ -0,0 +1,66 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_STAGES_HH
+#define SCREENSPACE_CORE_STAGES_HH
+
+#include <cstddef>
+
+namespace screenspace {
+
+/// Inputs cached draw data was last prepared from.
+struct StageInputs {
+  unsigned int layoutVersion;    // Placement attribute counter
+  unsigned int styleVersion;     // Shape and color attribute counter
+  std::size_t cameraKey;         // Hash of camera and viewport
+  std::size_t transformKey;      // Hash of the pickable's transform
+  unsigned int groupsVersion;    // Hidden group counter
+  unsigned int outlinesVersion;  // Finished custom outline counter
+};
+
+/// Prepare stages that need to rerun.
+struct Stages {
+  bool read;    // Attributes changed and must be read again
+  bool style;   // Style and unit geometry must be rebuilt
+  bool layout;  // Placement must be solved again
+  bool cull;    // Visibility must be decided again
+  bool outline; // A pending custom outline may have finished
+};
+
+/// Decide which stages to rerun from what changed since the last
+/// prepare.
+/// \param previous Inputs of the last prepare.
+/// \param current Current inputs.
+/// \return The stages to rerun.
+inline Stages dirtyStages(const StageInputs& previous, const StageInputs& current)
+{
+  const bool styleDirty = current.styleVersion != previous.styleVersion;
+  const bool layoutDirty = current.layoutVersion != previous.layoutVersion;
+  const bool cameraDirty = current.cameraKey != previous.cameraKey ||
+                           current.transformKey != previous.transformKey;
+  const bool groupsDirty = current.groupsVersion != previous.groupsVersion;
+  const bool outlinesDirty = current.outlinesVersion != previous.outlinesVersion;
+  return Stages{styleDirty || layoutDirty, styleDirty, layoutDirty || cameraDirty,
+                styleDirty || layoutDirty || cameraDirty || groupsDirty, outlinesDirty};
+}
+
+/// Whether any stage needs to rerun.
+inline bool anyStage(const Stages& stages)
+{
+  return stages.read || stages.style || stages.layout || stages.cull || stages.outline;
+}
+
+}
+
+#endif // SCREENSPACE_CORE_STAGES_HH
@@ -0,0 +1,177 @@
+#include "Stats.hh"
+
+namespace screenspace {
+
+std::atomic<bool> Stats::s_enabled(false);
+
+const char* stageName(Stage stage)
+{
+  switch (stage)
+  {
+    case Stage::Attach:
+      return "attach";
+    case Stage::Matrix:
+      return "matrix";
+    case Stage::Geometry:
+      return "geometry";
+    case Stage::Vertices:
+      return "vertices";
+    case Stage::Draw:
+      return "draw";
+  }
+  return "unknown";
+}
+
+std::uint64_t Histogram::percentileNs(double fraction) const
+{
+  if (count == 0)
+    return 0;
+
+  const double target = fraction * double(count);
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < kNumBuckets; ++i)
+  {
+    seen += buckets[i];
+    if (seen > 0 && double(seen) >= target)
+    {
+      const std::uint64_t upper = std::uint64_t(1) << (i + 1);
+      return upper < maxNs ? upper : maxNs;
+    }
+  }
+  return maxNs;
+}
+
+/// Bucket a duration falls in.
+static std::size_t bucketIndex(std::uint64_t ns)
+{
+  std::size_t index = 0;
+  while (ns > 1 && index + 1 < Histogram::kNumBuckets)
+  {
+    ns >>= 1;
+    ++index;
+  }
+  return index;
+}
+
+Stats& Stats::instance()
+{
+  static Stats stats;
+  return stats;
+}
+
+Stats::Stats()
+{
+  reset();
+}
+
+void Stats::setEnabled(bool enabled)
+{
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Stats::reset()
+{
+  for (Buckets& stage : m_stages)
+  {
+    stage.count.store(0, std::memory_order_relaxed);
+    stage.totalNs.store(0, std::memory_order_relaxed);
+    stage.maxNs.store(0, std::memory_order_relaxed);
+    for (std::atomic<std::uint64_t>& bucket : stage.buckets)
+      bucket.store(0, std::memory_order_relaxed);
+  }
+
+  for (Counters& counters : m_cameras)
+  {
+    counters.camera.store(0, std::memory_order_relaxed);
+    counters.drawn.store(0, std::memory_order_relaxed);
+    counters.culled.store(0, std::memory_order_relaxed);
+    counters.cacheHits.store(0, std::memory_order_relaxed);
+    counters.detached.store(0, std::memory_order_relaxed);
+  }
+}
+
+void Stats::record(Stage stage, std::uint64_t ns)
+{
+  Buckets& buckets = m_stages[static_cast<std::size_t>(stage)];
+  buckets.count.fetch_add(1, std::memory_order_relaxed);
+  buckets.totalNs.fetch_add(ns, std::memory_order_relaxed);
+  buckets.buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+
+  std::uint64_t previous = buckets.maxNs.load(std::memory_order_relaxed);
+  while (ns > previous &&
+         !buckets.maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed))
+  {
+  }
+}
+
+void Stats::count(std::uint64_t camera, Outcome outcome)
+{
+  // Keys are stored plus one so zero marks a free slot
+  const std::uint64_t key = camera + 1;
+
+  Counters* counters = nullptr;
+  for (Counters& slot : m_cameras)
+  {
+    std::uint64_t current = slot.camera.load(std::memory_order_relaxed);
+    if (current == 0 &&
+        !slot.camera.compare_exchange_strong(current, key, std::memory_order_relaxed))
+    {
+      // Lost the race for this slot, current now holds the winner
+    }
+    if (current == 0 || current == key)
+    {
+      counters = &slot;
+      break;
+    }
+  }
+  if (!counters)
+    return;
+
+  switch (outcome)
+  {
+    case Outcome::Drawn:
+      counters->drawn.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case Outcome::Culled:
+      counters->culled.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case Outcome::CacheHit:
+      counters->drawn.fetch_add(1, std::memory_order_relaxed);
+      counters->cacheHits.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case Outcome::Detached:
+      counters->detached.fetch_add(1, std::memory_order_relaxed);
+      break;
+  }
+}
+
+StatsSnapshot Stats::snapshot() const
+{
+  StatsSnapshot snapshot;
+  snapshot.enabled = enabled();
+  for (std::size_t i = 0; i < kNumStages; ++i)
+  {
+    const Buckets& buckets = m_stages[i];
+    Histogram& histogram = snapshot.stages[i];
+    histogram.count = buckets.count.load(std::memory_order_relaxed);
+    histogram.totalNs = buckets.totalNs.load(std::memory_order_relaxed);
+    histogram.maxNs = buckets.maxNs.load(std::memory_order_relaxed);
+    for (std::size_t j = 0; j < Histogram::kNumBuckets; ++j)
+      histogram.buckets[j] = buckets.buckets[j].load(std::memory_order_relaxed);
+  }
+
+  for (const Counters& counters : m_cameras)
+  {
+    const std::uint64_t key = counters.camera.load(std::memory_order_relaxed);
+    if (key == 0)
+      continue;
+    snapshot.cameras.push_back(CameraCounters{key - 1,
+                                              counters.drawn.load(std::memory_order_relaxed),
+                                              counters.culled.load(std::memory_order_relaxed),
+                                              counters.cacheHits.load(std::memory_order_relaxed),
+                                              counters.detached.load(std::memory_order_relaxed)});
+  }
+  return snapshot;
+}
+
+}
@@ -0,0 +1,184 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SCREENSPACE_CORE_STATS_HH
+#define SCREENSPACE_CORE_STATS_HH
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace screenspace {
+
+/// Instrumented draw stages.
+enum class Stage {
+  Attach,    // Checking the attached camera
+  Matrix,    // Solving placement
+  Geometry,  // Picking unit geometry
+  Vertices,  // Transforming unit points
+  Draw,      // Issuing draw calls
+};
+
+static const std::size_t kNumStages = 5;
+
+/// Name of a stage as reported by screenspaceStats.
+/// \param stage The stage.
+/// \return The name.
+const char* stageName(Stage stage);
+
+/// What happened to a pickable in a camera's draw.
+enum class Outcome {
+  Drawn,     // Prepared and drawn
+  Culled,    // Skipped, hidden or producing no pixels in this camera
+  CacheHit,  // Drawn without rerunning any stage
+  Detached,  // Skipped, attached to another camera
+};
+
+/// Durations of a stage, bucketed by powers of two in nanoseconds.
+struct Histogram {
+  static const std::size_t kNumBuckets = 32;
+
+  std::uint64_t count;
+  std::uint64_t totalNs;
+  std::uint64_t maxNs;
+  std::uint64_t buckets[kNumBuckets];  // Bucket i counts [2^i, 2^(i+1)) ns
+
+  /// Estimate a percentile from the buckets.
+  /// \param fraction Percentile in [0, 1].
+  /// \return Upper bound of the bucket it falls in, in nanoseconds.
+  std::uint64_t percentileNs(double fraction) const;
+};
+
+/// Pickable counts for a camera.
+struct CameraCounters {
+  std::uint64_t camera;  // Camera key
+  std::uint64_t drawn;
+  std::uint64_t culled;
+  std::uint64_t cacheHits;
+  std::uint64_t detached;
+};
+
+/// Copy of all statistics at one point in time.
+struct StatsSnapshot {
+  bool enabled;
+  Histogram stages[kNumStages];
+  std::vector<CameraCounters> cameras;
+};
+
+/// Plugin-wide draw statistics.
+///
+/// Collection is off by default. While off, timers and counters only
+/// read a flag. While on, everything is recorded with relaxed atomics
+/// so drawing threads never block. Counters are kept for up to
+/// kMaxCameras cameras, later ones are dropped.
+class Stats {
+public:
+  static const std::size_t kMaxCameras = 32;
+
+  static Stats& instance();
+
+  /// Whether statistics are being collected.
+  static bool enabled() {return s_enabled.load(std::memory_order_relaxed);}
+
+public:
+  /// Start or stop collecting.
+  /// \param enabled Whether to collect.
+  void setEnabled(bool enabled);
+
+  /// Clear all histograms and counters.
+  void reset();
+
+  /// Add a stage duration.
+  /// \param stage The stage.
+  /// \param ns Duration in nanoseconds.
+  void record(Stage stage, std::uint64_t ns);
+
+  /// Count a pickable for a camera.
+  /// \param camera Camera key.
+  /// \param outcome What happened to the pickable.
+  void count(std::uint64_t camera, Outcome outcome);
+
+  /// Copy the current statistics.
+  /// \return The snapshot.
+  StatsSnapshot snapshot() const;
+
+private:
+  struct Buckets {
+    std::atomic<std::uint64_t> count;
+    std::atomic<std::uint64_t> totalNs;
+    std::atomic<std::uint64_t> maxNs;
+    std::atomic<std::uint64_t> buckets[Histogram::kNumBuckets];
+  };
+
+  struct Counters {
+    std::atomic<std::uint64_t> camera;  // Zero while the slot is free
+    std::atomic<std::uint64_t> drawn;
+    std::atomic<std::uint64_t> culled;
+    std::atomic<std::uint64_t> cacheHits;
+    std::atomic<std::uint64_t> detached;
+  };
+
+  static std::atomic<bool> s_enabled;
+
+  Stats();
+
+  Buckets m_stages[kNumStages];
+  Counters m_cameras[kMaxCameras];
+};
+
+/// Time a stage from construction to destruction. Does nothing unless
+/// statistics are enabled.
+class ScopedTimer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit ScopedTimer(Stage stage)
+      : m_stage(stage),
+        m_enabled(Stats::enabled()) {
+    if (m_enabled)
+      m_start = Clock::now();
+  }
+
+  ~ScopedTimer() {
+    if (m_enabled)
+    {
+      const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start);
+      Stats::instance().record(m_stage, std::uint64_t(elapsed.count()));
+    }
+  }
+
+private:
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  Stage m_stage;
+  bool m_enabled;
+  Clock::time_point m_start;
+};
+
+/// Count a pickable for a camera if statistics are enabled.
+/// \param camera Camera key.
+/// \param outcome What happened to the pickable.
+inline void countPickable(std::uint64_t camera, Outcome outcome)
+{
+  if (Stats::enabled())
+    Stats::instance().count(camera, outcome);
+}
+
+}
+
+#endif // SCREENSPACE_CORE_STATS_HH
@@ -0,0 +1,287 @@
+#include "Tessellate.hh"
+
+#include "ss/core/Shapes.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace screenspace {
+
+static const double kPi = 3.14159265358979323846;
+
+/// Steps per doubling of the aspect ratio, and the widest aspect kept
+/// apart, 64:1.
+static const float kAspectSteps = 32.0f;
+static const int kMaxAspect = 6 * 32;
+
+static const int kMinSides = 3;
+static const int kMaxSides = 64;
+
+/// Quantize a value to a step, clamped to a range.
+/// \param value The value.
+/// \param min Smallest value kept.
+/// \param max Largest value kept.
+/// \param steps Steps per unit.
+/// \return The number of steps.
+static std::uint16_t quantize(float value, float min, float max, float steps)
+{
+  const float clamped = std::min(std::max(value, min), max);
+  return static_cast<std::uint16_t>(std::lround(clamped * steps));
+}
+
+/// Segments per full turn for a curve of a radius on screen.
+/// \param radius Radius in pixels.
+/// \param tolerance Largest outline error in pixels.
+/// \return The segments.
+static std::uint16_t curveSegments(float radius, float tolerance)
+{
+  return static_cast<std::uint16_t>(circleSegments(circleLod(radius, tolerance)));
+}
+
+bool ShapeKey::operator==(const ShapeKey& other) const
+{
+  return shape == other.shape &&
+         segments == other.segments &&
+         aspect == other.aspect &&
+         cornerRadius == other.cornerRadius &&
+         innerRadius == other.innerRadius &&
+         arcAngle == other.arcAngle &&
+         sides == other.sides;
+}
+
+std::size_t ShapeKeyHash::operator()(const ShapeKey& key) const
+{
+  const std::uint64_t fields[] = {
+    static_cast<std::uint64_t>(key.shape), key.segments,
+    static_cast<std::uint64_t>(static_cast<std::uint16_t>(key.aspect)),
+    key.cornerRadius, key.innerRadius, key.arcAngle, key.sides,
+  };
+
+  // FNV-1a over the fields
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::uint64_t field : fields)
+  {
+    hash ^= field;
+    hash *= 1099511628211ull;
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+bool isParametric(Shape shape)
+{
+  switch (shape)
+  {
+    case Shape::RoundedRectangle:
+    case Shape::Ring:
+    case Shape::Polygon:
+    case Shape::Capsule:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ShapeKey shapeKey(Shape shape, const ShapeParameters& parameters,
+                  float sizeX, float sizeY, float tolerance)
+{
+  ShapeKey key = {shape, 0, 0, 0, 0, 0, 0};
+  sizeX = std::max(sizeX, 1e-3f);
+  sizeY = std::max(sizeY, 1e-3f);
+  const float shorter = 0.5f * std::min(sizeX, sizeY);
+  const float aspect = std::log2(sizeX / sizeY) * kAspectSteps;
+  const std::int16_t quantizedAspect = static_cast<std::int16_t>(
+      std::min(std::max(int(std::lround(aspect)), -kMaxAspect), kMaxAspect));
+
+  switch (shape)
+  {
+    case Shape::RoundedRectangle:
+      key.cornerRadius = quantize(parameters.cornerRadius, 0.0f, 1.0f, 1000.0f);
+      if (key.cornerRadius == 0)
+        break;
+      key.aspect = quantizedAspect;
+      key.segments = curveSegments(shorter * key.cornerRadius / 1000.0f, tolerance);
+      break;
+    case Shape::Capsule:
+      key.aspect = quantizedAspect;
+      key.segments = curveSegments(shorter, tolerance);
+      break;
+    case Shape::Ring:
+      // Stretched rings are ellipses like circles, so aspect doesn't matter
+      key.innerRadius = quantize(parameters.innerRadius, 0.0f, 1.0f, 1000.0f);
+      key.arcAngle = quantize(parameters.arcAngle, 0.1f, 360.0f, 10.0f);
+      key.segments = curveSegments(0.5f * std::max(sizeX, sizeY), tolerance);
+      break;
+    case Shape::Polygon:
+      key.sides = static_cast<std::uint16_t>(std::min(std::max(parameters.sides, kMinSides), kMaxSides));
+      break;
+    default:
+      break;
+  }
+  return key;
+}
+
+/// Append a point unless it repeats the last one.
+/// \param mesh The mesh.
+/// \param x Unit x.
+/// \param y Unit y.
+static void addPoint(ShapeMesh& mesh, double x, double y)
+{
+  const std::size_t size = mesh.points.size();
+  if (size >= 2 &&
+      std::fabs(mesh.points[size - 2] - x) < 1e-6 &&
+      std::fabs(mesh.points[size - 1] - y) < 1e-6)
+    return;
+  mesh.points.push_back(float(x));
+  mesh.points.push_back(float(y));
+}
+
+/// Fan every outline point around the first point.
+/// \param mesh The mesh, its first point is the fan center.
+static void fanAroundFirst(ShapeMesh& mesh)
+{
+  const unsigned int numOutline = static_cast<unsigned int>(mesh.points.size() / 2) - 1;
+  for (unsigned int i = 1; i <= numOutline; ++i)
+  {
+    mesh.indices.push_back(0);
+    mesh.indices.push_back(i);
+    mesh.indices.push_back(i % numOutline + 1);
+  }
+}
+
+/// Rectangle with elliptical corners that are round on screen.
+/// \param mesh Will be populated with the mesh.
+/// \param cornerRadius Fraction of half the shorter side.
+/// \param aspect Width over height on screen.
+/// \param segments Segments per full turn of the corners.
+static void roundedRectangle(ShapeMesh& mesh, double cornerRadius, double aspect, std::size_t segments)
+{
+  const double shorter = 0.5 * cornerRadius * std::min(aspect, 1.0);
+  const double radiusX = shorter / aspect;
+  const double radiusY = shorter;
+  const std::size_t cornerSegments = cornerRadius > 0.0 ? std::max<std::size_t>(segments / 4, 1) : 0;
+
+  addPoint(mesh, 0.0, 0.0);
+  const double centers[4][2] = {{1.0, 1.0}, {-1.0, 1.0}, {-1.0, -1.0}, {1.0, -1.0}};
+  for (std::size_t corner = 0; corner < 4; ++corner)
+  {
+    const double centerX = centers[corner][0] * (0.5 - radiusX);
+    const double centerY = centers[corner][1] * (0.5 - radiusY);
+    for (std::size_t i = 0; i <= cornerSegments; ++i)
+    {
+      const double step = cornerSegments ? double(i) / double(cornerSegments) : 0.5;
+      const double angle = 0.5 * kPi * (double(corner) + step);
+      addPoint(mesh, centerX + radiusX * std::cos(angle), centerY + radiusY * std::sin(angle));
+    }
+  }
+
+  // Capsule ends meet where the first corner started
+  if (mesh.points.size() > 4 &&
+      std::fabs(mesh.points[2] - mesh.points[mesh.points.size() - 2]) < 1e-6 &&
+      std::fabs(mesh.points[3] - mesh.points.back()) < 1e-6)
+    mesh.points.resize(mesh.points.size() - 2);
+  fanAroundFirst(mesh);
+}
+
+/// Ring, arc or pie slice.
+/// \param mesh Will be populated with the mesh.
+/// \param innerRadius Fraction of the outer radius.
+/// \param arcAngle Sweep in degrees.
+/// \param segments Segments per full turn.
+static void ring(ShapeMesh& mesh, double innerRadius, double arcAngle, std::size_t segments)
+{
+  const double outer = 0.5;
+  const double inner = 0.5 * innerRadius;
+  const double sweep = arcAngle * kPi / 180.0;
+  const bool full = arcAngle >= 360.0 - 1e-6;
+  const std::size_t numSegments = std::max<std::size_t>(
+      std::size_t(std::ceil(double(segments) * arcAngle / 360.0 - 1e-6)), 1);
+  const std::size_t numSpokes = full ? numSegments : numSegments + 1;
+
+  if (inner <= 0.0)
+  {
+    // Pie slice fanned around the center
+    addPoint(mesh, 0.0, 0.0);
+    for (std::size_t i = 0; i < numSpokes; ++i)
+    {
+      const double angle = sweep * double(i) / double(numSegments);
+      addPoint(mesh, outer * std::cos(angle), outer * std::sin(angle));
+    }
+    const unsigned int numOutline = static_cast<unsigned int>(numSpokes);
+    const unsigned int numFan = static_cast<unsigned int>(numSegments);
+    for (unsigned int i = 1; i <= numFan; ++i)
+    {
+      mesh.indices.push_back(0);
+      mesh.indices.push_back(i);
+      mesh.indices.push_back(i % numOutline + 1);
+    }
+    return;
+  }
+
+  // Outer and inner point per spoke, two triangles per segment
+  for (std::size_t i = 0; i < numSpokes; ++i)
+  {
+    const double angle = sweep * double(i) / double(numSegments);
+    const double c = std::cos(angle);
+    const double s = std::sin(angle);
+    mesh.points.push_back(float(outer * c));
+    mesh.points.push_back(float(outer * s));
+    mesh.points.push_back(float(inner * c));
+    mesh.points.push_back(float(inner * s));
+  }
+  for (std::size_t i = 0; i < numSegments; ++i)
+  {
+    const unsigned int outer0 = static_cast<unsigned int>(2 * i);
+    const unsigned int outer1 = static_cast<unsigned int>(2 * ((i + 1) % numSpokes));
+    mesh.indices.push_back(outer0);
+    mesh.indices.push_back(outer1);
+    mesh.indices.push_back(outer0 + 1);
+    mesh.indices.push_back(outer0 + 1);
+    mesh.indices.push_back(outer1);
+    mesh.indices.push_back(outer1 + 1);
+  }
+}
+
+/// Regular polygon with a corner at the top.
+/// \param mesh Will be populated with the mesh.
+/// \param sides Number of sides.
+static void polygon(ShapeMesh& mesh, std::size_t sides)
+{
+  for (std::size_t i = 0; i < sides; ++i)
+  {
+    const double angle = 0.5 * kPi + 2.0 * kPi * double(i) / double(sides);
+    addPoint(mesh, 0.5 * std::cos(angle), 0.5 * std::sin(angle));
+  }
+  for (unsigned int i = 1; i + 1 < static_cast<unsigned int>(sides); ++i)
+  {
+    mesh.indices.push_back(0);
+    mesh.indices.push_back(i);
+    mesh.indices.push_back(i + 1);
+  }
+}
+
+void tessellate(const ShapeKey& key, ShapeMesh& mesh)
+{
+  mesh.points.clear();
+  mesh.indices.clear();
+
+  const double aspect = std::exp2(double(key.aspect) / kAspectSteps);
+  switch (key.shape)
+  {
+    case Shape::RoundedRectangle:
+      roundedRectangle(mesh, key.cornerRadius / 1000.0, aspect, key.segments);
+      break;
+    case Shape::Capsule:
+      roundedRectangle(mesh, 1.0, aspect, key.segments);
+      break;
+    case Shape::Ring:
+      ring(mesh, key.innerRadius / 1000.0, key.arcAngle / 10.0, key.segments);
+      break;
+    case Shape::Polygon:
+      polygon(mesh, key.sides);
+      break;
+    default:
+      break;
+  }
+}
+
+}
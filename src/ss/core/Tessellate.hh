@@ -0,0 +1,86 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_TESSELLATE_HH
+#define SCREENSPACE_CORE_TESSELLATE_HH
+
+#include "ss/Types.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace screenspace {
+
+/// Parameters of the parametric shapes, each shape reads only its own.
+struct ShapeParameters {
+  float cornerRadius;  // Rounded rectangle corners, fraction of half the shorter side
+  float innerRadius;   // Ring hole, fraction of the outer radius
+  float arcAngle;      // Ring sweep in degrees, counterclockwise from the right
+  int sides;           // Regular polygon sides
+};
+
+/// Everything a parametric mesh depends on, quantized so pickables
+/// with near identical parameters share one mesh. Parameters a shape
+/// doesn't use are zero.
+struct ShapeKey {
+  Shape shape;
+  std::uint16_t segments;      // Segments per full turn of curved edges
+  std::int16_t aspect;         // log2 of width over height on screen, in 1/32 steps
+  std::uint16_t cornerRadius;  // Thousandths
+  std::uint16_t innerRadius;   // Thousandths
+  std::uint16_t arcAngle;      // Tenths of a degree
+  std::uint16_t sides;
+
+  bool operator==(const ShapeKey& other) const;
+};
+
+/// Hash of a shape key, for unordered containers.
+struct ShapeKeyHash {
+  std::size_t operator()(const ShapeKey& key) const;
+};
+
+/// Triangulated unit sized mesh centered on the origin.
+struct ShapeMesh {
+  std::vector<float> points;          // x, y per point
+  std::vector<unsigned int> indices;  // Triangle indices
+};
+
+/// Check if a shape is tessellated from parameters rather than taken
+/// from the constant unit shapes.
+/// \param shape The shape.
+/// \return True for rounded rectangles, rings, polygons and capsules.
+bool isParametric(Shape shape);
+
+/// Key of the mesh a parametric shape is drawn with at its size on
+/// screen. Curved edges get the coarsest circle level of detail that
+/// keeps them within tolerance, and shapes whose corners must stay
+/// round are keyed by their aspect ratio.
+/// \param shape The shape.
+/// \param parameters Shape parameters.
+/// \param sizeX Width on screen in pixels.
+/// \param sizeY Height on screen in pixels.
+/// \param tolerance Largest outline error in pixels.
+/// \return The key.
+ShapeKey shapeKey(Shape shape, const ShapeParameters& parameters,
+                  float sizeX, float sizeY, float tolerance);
+
+/// Tessellate the mesh of a key.
+/// \param key The key.
+/// \param mesh Will be populated with the mesh.
+void tessellate(const ShapeKey& key, ShapeMesh& mesh);
+
+}
+
+#endif // SCREENSPACE_CORE_TESSELLATE_HH
@@ -0,0 +1,157 @@
+#include "Trace.hh"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <unordered_map>
+
+namespace screenspace {
+
+std::atomic<bool> Tracer::s_enabled(false);
+
+/// Nanoseconds on the steady clock.
+static std::int64_t nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Write a string as a JSON string literal.
+static void writeString(std::ostream& stream, const char* value)
+{
+  stream << '"';
+  for (const char* c = value; *c; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      stream << '\\' << *c;
+    else if (static_cast<unsigned char>(*c) >= 0x20)
+      stream << *c;
+  }
+  stream << '"';
+}
+
+Tracer& Tracer::instance()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer()
+    : m_dropped(0),
+      m_epoch(nowNs()) {
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Tracer::Thread& Tracer::thread()
+{
+  // Buffers live as long as the tracer so exited threads can still be
+  // written out
+  thread_local Thread* current = nullptr;
+  if (!current)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threads.emplace_back(new Thread(m_threads.size()));
+    current = m_threads.back().get();
+  }
+  return *current;
+}
+
+bool Tracer::record(const TraceEvent& event)
+{
+  if (thread().events.push(event))
+    return true;
+  m_dropped.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+bool Tracer::begin(const char* name, const char* pickable, std::uint64_t camera)
+{
+  if (!enabled())
+    return false;
+
+  TraceEvent event;
+  event.ns = std::uint64_t(nowNs() - m_epoch);
+  event.name = name;
+  event.camera = camera;
+  event.phase = 'B';
+  event.pickable[0] = '\0';
+  if (pickable)
+  {
+    std::strncpy(event.pickable, pickable, sizeof(event.pickable) - 1);
+    event.pickable[sizeof(event.pickable) - 1] = '\0';
+  }
+  return record(event);
+}
+
+void Tracer::end(const char* name)
+{
+  // Recorded even if tracing stopped since begin, so events pair up
+  TraceEvent event;
+  event.ns = std::uint64_t(nowNs() - m_epoch);
+  event.name = name;
+  event.camera = 0;
+  event.phase = 'E';
+  event.pickable[0] = '\0';
+  record(event);
+}
+
+void Tracer::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  TraceEvent event;
+  for (const std::unique_ptr<Thread>& thread : m_threads)
+    while (thread->events.pop(event)) {}
+  m_dropped.store(0, std::memory_order_relaxed);
+}
+
+std::size_t Tracer::write(std::ostream& stream, const CameraNamer& cameraName)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::unordered_map<std::uint64_t, std::string> names;
+  std::size_t count = 0;
+  stream << std::fixed << std::setprecision(3);
+  stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  for (const std::unique_ptr<Thread>& thread : m_threads)
+  {
+    if (count > 0)
+      stream << ",\n";
+    stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->index
+           << ",\"args\":{\"name\":\"screenspace " << thread->index << "\"}}";
+    ++count;
+
+    TraceEvent event;
+    while (thread->events.pop(event))
+    {
+      // Chrome trace timestamps are in microseconds
+      stream << ",\n{\"name\":";
+      writeString(stream, event.name);
+      stream << ",\"cat\":\"screenspace\",\"ph\":\"" << event.phase << "\""
+             << ",\"ts\":" << double(event.ns) / 1000.0
+             << ",\"pid\":1,\"tid\":" << thread->index;
+      if (event.phase == 'B' && (event.pickable[0] || event.camera))
+      {
+        if (event.camera && names.find(event.camera) == names.end())
+          names[event.camera] = cameraName(event.camera);
+
+        stream << ",\"args\":{\"pickable\":";
+        writeString(stream, event.pickable);
+        stream << ",\"camera\":";
+        writeString(stream, event.camera ? names[event.camera].c_str() : "");
+        stream << "}";
+      }
+      stream << "}";
+      ++count;
+    }
+  }
+  stream << "]}\n";
+
+  m_dropped.store(0, std::memory_order_relaxed);
+  return count;
+}
+
+}
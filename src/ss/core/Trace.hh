@@ -0,0 +1,140 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SCREENSPACE_CORE_TRACE_HH
+#define SCREENSPACE_CORE_TRACE_HH
+
+#include "ss/core/RingBuffer.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace screenspace {
+
+/// One begin or end event.
+struct TraceEvent {
+  std::uint64_t ns;      // Time since the tracer started
+  const char* name;      // Static event name
+  std::uint64_t camera;  // Camera key, zero if none
+  char phase;            // 'B'egin or 'E'nd
+  char pickable[55];     // Truncated pickable name, empty if none
+};
+
+/// Opt-in recorder of draw and command activity for Chrome's trace
+/// viewer and Perfetto.
+///
+/// Each thread records into its own ring buffer without locking, the
+/// buffer is created the first time the thread records. Events that
+/// don't fit are dropped until the buffers are written out.
+class Tracer {
+public:
+  static const std::size_t kEventsPerThread = 32768;
+
+  /// Resolves camera keys to names when writing.
+  using CameraNamer = std::function<std::string(std::uint64_t)>;
+
+  static Tracer& instance();
+
+  /// Whether events are being recorded.
+  static bool enabled() {return s_enabled.load(std::memory_order_relaxed);}
+
+public:
+  /// Start or stop recording.
+  /// \param enabled Whether to record.
+  void setEnabled(bool enabled);
+
+  /// Record the start of an event on this thread.
+  /// \param name Static event name.
+  /// \param pickable Pickable name, may be null.
+  /// \param camera Camera key, zero if none.
+  /// \return False if the event was dropped.
+  bool begin(const char* name, const char* pickable, std::uint64_t camera);
+
+  /// Record the end of an event on this thread.
+  /// \param name Static event name, as given to begin.
+  void end(const char* name);
+
+  /// Events dropped because a buffer was full.
+  std::size_t dropped() const {return m_dropped.load(std::memory_order_relaxed);}
+
+  /// Discard recorded events.
+  void clear();
+
+  /// Write recorded events as Chrome trace JSON and discard them.
+  /// \param stream Stream to write to.
+  /// \param cameraName Resolves camera keys to names.
+  /// \return Number of events written.
+  std::size_t write(std::ostream& stream, const CameraNamer& cameraName);
+
+private:
+  struct Thread {
+    explicit Thread(std::size_t index) : index(index), events(kEventsPerThread) {}
+    std::size_t index;
+    RingBuffer<TraceEvent> events;
+  };
+
+  static std::atomic<bool> s_enabled;
+
+  Tracer();
+  Thread& thread();
+  bool record(const TraceEvent& event);
+
+  std::mutex m_mutex;  // Guards m_threads and reading
+  std::vector<std::unique_ptr<Thread>> m_threads;
+  std::atomic<std::size_t> m_dropped;
+  std::int64_t m_epoch;
+};
+
+/// Record an event from begin to destruction. Callers passing a
+/// pickable name check Tracer::enabled first so the name is only built
+/// while tracing.
+class ScopedTrace {
+public:
+  ScopedTrace() : m_name(nullptr) {}
+
+  /// Begin right away, for events without a pickable or camera.
+  /// \param name Static event name.
+  explicit ScopedTrace(const char* name) : m_name(nullptr) {begin(name);}
+
+  ~ScopedTrace() {
+    if (m_name)
+      Tracer::instance().end(m_name);
+  }
+
+  /// \param name Static event name.
+  /// \param pickable Pickable name, may be null.
+  /// \param camera Camera key, zero if none.
+  void begin(const char* name, const char* pickable = nullptr, std::uint64_t camera = 0) {
+    if (Tracer::instance().begin(name, pickable, camera))
+      m_name = name;
+  }
+
+private:
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+  const char* m_name;
+};
+
+}
+
+#endif // SCREENSPACE_CORE_TRACE_HH
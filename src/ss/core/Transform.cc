@@ -0,0 +1,248 @@
+#include "Transform.hh"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SS_TRANSFORM_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SS_TRANSFORM_X86) && defined(__GNUC__)
+#define SS_TARGET_SSE __attribute__((target("sse2")))
+#define SS_TARGET_AVX __attribute__((target("avx")))
+#else
+#define SS_TARGET_SSE
+#define SS_TARGET_AVX
+#endif
+
+namespace screenspace {
+
+using TransformKernel = void (*)(const Placement&, const float*, const float*,
+                                 std::size_t, std::size_t, float*);
+
+/// Transform points [begin, count) one at a time.
+static void transformScalar(const Placement& p,
+                            const float* x,
+                            const float* y,
+                            std::size_t begin,
+                            std::size_t count,
+                            float* positions)
+{
+  for (std::size_t i = begin; i < count; ++i)
+  {
+    float* out = positions + i * 3;
+    out[0] = p.origin[0] + x[i] * p.axisX[0] + y[i] * p.axisY[0];
+    out[1] = p.origin[1] + x[i] * p.axisX[1] + y[i] * p.axisY[1];
+    out[2] = p.origin[2] + x[i] * p.axisX[2] + y[i] * p.axisY[2];
+  }
+}
+
+#ifdef SS_TRANSFORM_X86
+
+/// Lane patterns for writing four points as interleaved xyz. Four
+/// points fill three registers, [x0 y0 z0 x1] [y1 z1 x2 y2]
+/// [z2 x3 y3 z3], so each register takes coordinates in one of three
+/// rotations and points in one of three spreads.
+#define SS_SPREAD_0 _MM_SHUFFLE(1, 0, 0, 0)
+#define SS_SPREAD_1 _MM_SHUFFLE(2, 2, 1, 1)
+#define SS_SPREAD_2 _MM_SHUFFLE(3, 3, 3, 2)
+
+/// Placement coefficients in the three xyz rotations.
+struct Rotations {
+  float origin[3][4];
+  float axisX[3][4];
+  float axisY[3][4];
+};
+
+/// Lay out placement coefficients to match the lane patterns.
+/// \param p The placement.
+/// \return Coefficients per rotation.
+static Rotations rotations(const Placement& p)
+{
+  Rotations r;
+  for (int k = 0; k < 3; ++k)
+  {
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      const int axis = (k + lane) % 3;
+      r.origin[k][lane] = p.origin[axis];
+      r.axisX[k][lane] = p.axisX[axis];
+      r.axisY[k][lane] = p.axisY[axis];
+    }
+  }
+  return r;
+}
+
+/// Transform points four at a time.
+SS_TARGET_SSE
+static void transformSSE(const Placement& p,
+                         const float* x,
+                         const float* y,
+                         std::size_t begin,
+                         std::size_t count,
+                         float* positions)
+{
+  const Rotations r = rotations(p);
+  __m128 origin[3], axisX[3], axisY[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    origin[k] = _mm_loadu_ps(r.origin[k]);
+    axisX[k] = _mm_loadu_ps(r.axisX[k]);
+    axisY[k] = _mm_loadu_ps(r.axisY[k]);
+  }
+
+  std::size_t i = begin;
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128 u = _mm_loadu_ps(x + i);
+    const __m128 v = _mm_loadu_ps(y + i);
+    const __m128 u0 = _mm_shuffle_ps(u, u, SS_SPREAD_0);
+    const __m128 u1 = _mm_shuffle_ps(u, u, SS_SPREAD_1);
+    const __m128 u2 = _mm_shuffle_ps(u, u, SS_SPREAD_2);
+    const __m128 v0 = _mm_shuffle_ps(v, v, SS_SPREAD_0);
+    const __m128 v1 = _mm_shuffle_ps(v, v, SS_SPREAD_1);
+    const __m128 v2 = _mm_shuffle_ps(v, v, SS_SPREAD_2);
+
+    float* out = positions + i * 3;
+    _mm_storeu_ps(out, _mm_add_ps(origin[0], _mm_add_ps(_mm_mul_ps(u0, axisX[0]), _mm_mul_ps(v0, axisY[0]))));
+    _mm_storeu_ps(out + 4, _mm_add_ps(origin[1], _mm_add_ps(_mm_mul_ps(u1, axisX[1]), _mm_mul_ps(v1, axisY[1]))));
+    _mm_storeu_ps(out + 8, _mm_add_ps(origin[2], _mm_add_ps(_mm_mul_ps(u2, axisX[2]), _mm_mul_ps(v2, axisY[2]))));
+  }
+  transformScalar(p, x, y, i, count, positions);
+}
+
+/// Transform points eight at a time. Eight points fill three
+/// registers whose halves reuse the four point spreads.
+SS_TARGET_AVX
+static void transformAVX(const Placement& p,
+                         const float* x,
+                         const float* y,
+                         std::size_t begin,
+                         std::size_t count,
+                         float* positions)
+{
+  // Half h of the output uses rotation h % 3
+  const Rotations r = rotations(p);
+  __m256 origin[3], axisX[3], axisY[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    const int lower = (k * 2) % 3;
+    const int upper = (k * 2 + 1) % 3;
+    origin[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(r.origin[lower])), _mm_loadu_ps(r.origin[upper]), 1);
+    axisX[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(r.axisX[lower])), _mm_loadu_ps(r.axisX[upper]), 1);
+    axisY[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(r.axisY[lower])), _mm_loadu_ps(r.axisY[upper]), 1);
+  }
+
+  std::size_t i = begin;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128 uLo = _mm_loadu_ps(x + i);
+    const __m128 uHi = _mm_loadu_ps(x + i + 4);
+    const __m128 vLo = _mm_loadu_ps(y + i);
+    const __m128 vHi = _mm_loadu_ps(y + i + 4);
+
+    // [p0 p0 p0 p1 p1 p1 p2 p2] [p2 p3 p3 p3 p4 p4 p4 p5] [p5 p5 p6 p6 p6 p7 p7 p7]
+    const __m256 u0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_shuffle_ps(uLo, uLo, SS_SPREAD_0)), _mm_shuffle_ps(uLo, uLo, SS_SPREAD_1), 1);
+    const __m256 u1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_shuffle_ps(uLo, uLo, SS_SPREAD_2)), _mm_shuffle_ps(uHi, uHi, SS_SPREAD_0), 1);
+    const __m256 u2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_shuffle_ps(uHi, uHi, SS_SPREAD_1)), _mm_shuffle_ps(uHi, uHi, SS_SPREAD_2), 1);
+    const __m256 v0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_shuffle_ps(vLo, vLo, SS_SPREAD_0)), _mm_shuffle_ps(vLo, vLo, SS_SPREAD_1), 1);
+    const __m256 v1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_shuffle_ps(vLo, vLo, SS_SPREAD_2)), _mm_shuffle_ps(vHi, vHi, SS_SPREAD_0), 1);
+    const __m256 v2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_shuffle_ps(vHi, vHi, SS_SPREAD_1)), _mm_shuffle_ps(vHi, vHi, SS_SPREAD_2), 1);
+
+    float* out = positions + i * 3;
+    _mm256_storeu_ps(out, _mm256_add_ps(origin[0], _mm256_add_ps(_mm256_mul_ps(u0, axisX[0]), _mm256_mul_ps(v0, axisY[0]))));
+    _mm256_storeu_ps(out + 8, _mm256_add_ps(origin[1], _mm256_add_ps(_mm256_mul_ps(u1, axisX[1]), _mm256_mul_ps(v1, axisY[1]))));
+    _mm256_storeu_ps(out + 16, _mm256_add_ps(origin[2], _mm256_add_ps(_mm256_mul_ps(u2, axisX[2]), _mm256_mul_ps(v2, axisY[2]))));
+  }
+
+  // Leave AVX state clean before running legacy SSE code
+  _mm256_zeroupper();
+  transformSSE(p, x, y, i, count, positions);
+}
+
+/// Check whether the CPU and OS support AVX.
+/// \return True if AVX can be used.
+static bool hasAVX()
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+#elif defined(__GNUC__)
+  return __builtin_cpu_supports("avx");
+#else
+  return false;
+#endif
+}
+
+#endif
+
+/// Widest instruction set the CPU supports, checked once.
+/// \return The path.
+static TransformPath supportedPath()
+{
+#ifdef SS_TRANSFORM_X86
+  static const TransformPath path = hasAVX() ? TransformPath::AVX : TransformPath::SSE;
+  return path;
+#else
+  return TransformPath::Scalar;
+#endif
+}
+
+TransformPath transformPath()
+{
+  // A pickable has at most a few dozen points, too few for AVX to win
+  // back loading its wider registers and the shuffles across halves.
+  // SSE is faster at every scene size in screenspaceBench.
+#ifdef SS_TRANSFORM_X86
+  return TransformPath::SSE;
+#else
+  return TransformPath::Scalar;
+#endif
+}
+
+/// Kernel for a path, limited to what the CPU supports.
+/// \param path Requested path.
+/// \return The kernel.
+static TransformKernel transformKernel(TransformPath path)
+{
+  if (static_cast<int>(path) > static_cast<int>(supportedPath()))
+    path = supportedPath();
+
+  switch (path)
+  {
+#ifdef SS_TRANSFORM_X86
+    case TransformPath::AVX:
+      return &transformAVX;
+    case TransformPath::SSE:
+      return &transformSSE;
+#endif
+    default:
+      return &transformScalar;
+  }
+}
+
+void transformPoints(const Placement& placement,
+                     const float* x,
+                     const float* y,
+                     std::size_t count,
+                     float* positions)
+{
+  static const TransformKernel kernel = transformKernel(transformPath());
+  kernel(placement, x, y, 0, count, positions);
+}
+
+void transformPoints(TransformPath path,
+                     const Placement& placement,
+                     const float* x,
+                     const float* y,
+                     std::size_t count,
+                     float* positions)
+{
+  transformKernel(path)(placement, x, y, 0, count, positions);
+}
+
+}
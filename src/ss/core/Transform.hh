@@ -0,0 +1,68 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_CORE_TRANSFORM_HH
+#define SCREENSPACE_CORE_TRANSFORM_HH
+
+#include "ss/core/Layout.hh"
+
+#include <cstddef>
+
+namespace screenspace {
+
+/// Instruction sets the transform kernel can run with.
+enum class TransformPath {
+  Scalar,
+  SSE,
+  AVX,
+};
+
+/// Transform unit points into worldspace. Points are read as separate
+/// x and y arrays and written as interleaved xyz, ready for a vertex
+/// buffer. Uses the instruction set transformPath picks.
+/// \param placement Unit-to-world placement.
+/// \param x Unit x coordinates.
+/// \param y Unit y coordinates.
+/// \param count Number of points.
+/// \param positions Will have count xyz triples written.
+void transformPoints(const Placement& placement,
+                     const float* x,
+                     const float* y,
+                     std::size_t count,
+                     float* positions);
+
+/// Transform unit points with a specific instruction set, for
+/// comparing paths. Paths the CPU lacks fall back to the widest one
+/// it has.
+/// \param path Instruction set to use.
+/// \param placement Unit-to-world placement.
+/// \param x Unit x coordinates.
+/// \param y Unit y coordinates.
+/// \param count Number of points.
+/// \param positions Will have count xyz triples written.
+void transformPoints(TransformPath path,
+                     const Placement& placement,
+                     const float* x,
+                     const float* y,
+                     std::size_t count,
+                     float* positions);
+
+/// Instruction set picked for this CPU. SSE where available, AVX is
+/// slower at the point counts of a single pickable.
+/// \return The path used by transformPoints.
+TransformPath transformPath();
+
+}
+
+#endif // SCREENSPACE_CORE_TRANSFORM_HH
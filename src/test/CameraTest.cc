@@ -0,0 +1,65 @@
+#include "Test.hh"
+
+#include "ss/core/Camera.hh"
+
+#include <random>
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+SS_TEST(camera, viewportSizeSetsDiagonal)
+{
+  CameraBasis camera;
+  setViewportSize(camera, 1920, 1080);
+  SS_CHECK(camera.width == 1920);
+  SS_CHECK(camera.height == 1080);
+  SS_CHECK_NEAR(camera.diagonalCos, 1920.0 / std::hypot(1920.0, 1080.0), 1e-6);
+  SS_CHECK_NEAR(camera.diagonalSin, 1080.0 / std::hypot(1920.0, 1080.0), 1e-6);
+}
+
+SS_TEST(camera, unprojectsAlongPixelRay)
+{
+  const CameraBasis camera = perspectiveCamera(1920, 1080, Vec3{1.0f, 2.0f, 10.0f});
+  const int pixels[][2] = {{0, 0}, {1920, 1080}, {960, 540}, {17, 1003}};
+  for (const auto& pixel : pixels)
+  {
+    for (int depth : {0, 5, 100})
+    {
+      const Vec3 near = camera.nearOrigin + camera.nearX * float(pixel[0]) + camera.nearY * float(pixel[1]);
+      const Vec3 far = camera.farOrigin + camera.farX * float(pixel[0]) + camera.farY * float(pixel[1]);
+      const Vec3 point = viewportToWorld(camera, pixel[0], pixel[1], depth);
+
+      // Just past the near plane, further the deeper the shape
+      const Vec3 offset = point - near;
+      SS_CHECK_NEAR(length(offset), camera.nearClipPlane + 0.001 * (depth + 1), 1e-5);
+      SS_CHECK_NEAR(dot(normalize(offset), normalize(far - near)), 1.0, 1e-5);
+    }
+  }
+}
+
+SS_TEST(camera, unprojectRoundTrips)
+{
+  const CameraBasis cameras[] = {
+    perspectiveCamera(1920, 1080, Vec3{1.0f, 2.0f, 10.0f}),
+    perspectiveCamera(640, 960, Vec3{-3.0f, 0.5f, 4.0f}),
+    orthographicCamera(1920, 1080, Vec3{1.0f, 2.0f, 10.0f}, 30.0f),
+    orthographicCamera(800, 800, Vec3{0.0f, 0.0f, 100.0f}, 2.0f),
+  };
+
+  std::mt19937 generator(3);
+  for (const CameraBasis& camera : cameras)
+  {
+    std::uniform_int_distribution<int> pixelX(0, camera.width);
+    std::uniform_int_distribution<int> pixelY(0, camera.height);
+    std::uniform_int_distribution<int> depth(0, 50);
+    for (int i = 0; i < 200; ++i)
+    {
+      const int x = pixelX(generator);
+      const int y = pixelY(generator);
+      float projectedX, projectedY;
+      worldToViewport(camera, viewportToWorld(camera, x, y, depth(generator)), projectedX, projectedY);
+      SS_CHECK_NEAR(projectedX, x, 0.05);
+      SS_CHECK_NEAR(projectedY, y, 0.05);
+    }
+  }
+}
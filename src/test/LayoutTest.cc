@@ -0,0 +1,236 @@
+#include "Test.hh"
+
+#include "ss/core/Layout.hh"
+
+#include <random>
+#include <vector>
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+static const float kHalfPi = 1.57079632679f;
+
+/// A shape of a given pixel size, left and bottom aligned in absolute
+/// units.
+static LayoutAttributes absoluteLayout(float offsetX, float offsetY, float width, float height)
+{
+  LayoutAttributes attributes;
+  attributes.size = 1.0f;
+  attributes.width = width;
+  attributes.height = height;
+  attributes.depth = 0;
+  attributes.position = Position::Absolute;
+  attributes.horizontalAlign = HorizontalAlign::Left;
+  attributes.verticalAlign = VerticalAlign::Bottom;
+  attributes.rotate = 0.0f;
+  attributes.offsetX = offsetX;
+  attributes.offsetY = offsetY;
+  return attributes;
+}
+
+/// Random layouts covering every position, alignment and depth,
+/// mostly on screen.
+static std::vector<LayoutAttributes> randomLayouts(std::size_t count, unsigned int seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::uniform_int_distribution<int> depth(0, 20);
+  std::uniform_int_distribution<int> choice(0, 2);
+
+  std::vector<LayoutAttributes> layouts(count);
+  for (LayoutAttributes& attributes : layouts)
+  {
+    attributes.size = 0.5f + unit(generator) * 2.0f;
+    attributes.depth = depth(generator);
+    attributes.horizontalAlign = static_cast<HorizontalAlign>(choice(generator));
+    attributes.verticalAlign = static_cast<VerticalAlign>(choice(generator));
+    attributes.rotate = (unit(generator) - 0.5f) * 6.0f;
+    if (choice(generator) == 0)
+    {
+      // Relative units are a percent of the viewport, and so is the
+      // alignment anchor once scaled, so keep it to the left bottom
+      attributes.position = Position::Relative;
+      attributes.horizontalAlign = HorizontalAlign::Left;
+      attributes.verticalAlign = VerticalAlign::Bottom;
+      attributes.width = 1.0f + unit(generator) * 10.0f;
+      attributes.height = 1.0f + unit(generator) * 10.0f;
+      attributes.offsetX = unit(generator) * 100.0f;
+      attributes.offsetY = unit(generator) * 100.0f;
+    }
+    else
+    {
+      attributes.position = Position::Absolute;
+      attributes.width = 5.0f + unit(generator) * 100.0f;
+      attributes.height = 5.0f + unit(generator) * 100.0f;
+      attributes.offsetX = (unit(generator) - 0.5f) * 400.0f;
+      attributes.offsetY = (unit(generator) - 0.5f) * 400.0f;
+    }
+  }
+  return layouts;
+}
+
+SS_TEST(layout, screenRectAbsolute)
+{
+  const ScreenRect rect = screenRect(absoluteLayout(10.0f, 20.0f, 30.0f, 40.0f), 200, 100);
+  SS_CHECK_NEAR(rect.minX, 10.0, 1e-5);
+  SS_CHECK_NEAR(rect.minY, 20.0, 1e-5);
+  SS_CHECK_NEAR(rect.maxX, 40.0, 1e-5);
+  SS_CHECK_NEAR(rect.maxY, 60.0, 1e-5);
+}
+
+SS_TEST(layout, screenRectAligned)
+{
+  LayoutAttributes attributes = absoluteLayout(-10.0f, -20.0f, 30.0f, 40.0f);
+  attributes.size = 2.0f;
+  attributes.horizontalAlign = HorizontalAlign::Middle;
+  attributes.verticalAlign = VerticalAlign::Top;
+  const ScreenRect rect = screenRect(attributes, 200, 100);
+  SS_CHECK_NEAR(rect.minX, 90.0, 1e-5);
+  SS_CHECK_NEAR(rect.minY, 80.0, 1e-5);
+  SS_CHECK_NEAR(rect.maxX, 150.0, 1e-5);
+  SS_CHECK_NEAR(rect.maxY, 160.0, 1e-5);
+
+  attributes.horizontalAlign = HorizontalAlign::Right;
+  attributes.verticalAlign = VerticalAlign::Bottom;
+  const ScreenRect right = screenRect(attributes, 200, 100);
+  SS_CHECK_NEAR(right.minX, 190.0, 1e-5);
+  SS_CHECK_NEAR(right.minY, -20.0, 1e-5);
+}
+
+SS_TEST(layout, screenRectRelative)
+{
+  LayoutAttributes attributes = absoluteLayout(25.0f, 50.0f, 10.0f, 20.0f);
+  attributes.position = Position::Relative;
+  const ScreenRect rect = screenRect(attributes, 400, 200);
+  SS_CHECK_NEAR(rect.minX, 100.0, 1e-4);
+  SS_CHECK_NEAR(rect.minY, 100.0, 1e-4);
+  SS_CHECK_NEAR(rect.maxX, 140.0, 1e-4);
+  SS_CHECK_NEAR(rect.maxY, 140.0, 1e-4);
+}
+
+SS_TEST(layout, screenRectRotated)
+{
+  // A quarter turn about the corner swaps the extents around the
+  // rotated center
+  LayoutAttributes attributes = absoluteLayout(100.0f, 100.0f, 40.0f, 10.0f);
+  attributes.rotate = kHalfPi;
+  const ScreenPlacement placement = screenPlacement(attributes, 400, 400);
+  SS_CHECK_NEAR(placement.center[0], 95.0, 1e-4);
+  SS_CHECK_NEAR(placement.center[1], 120.0, 1e-4);
+  SS_CHECK_NEAR(placement.axisX[0], 0.0, 1e-4);
+  SS_CHECK_NEAR(placement.axisX[1], 40.0, 1e-4);
+  SS_CHECK_NEAR(placement.axisY[0], -10.0, 1e-4);
+  SS_CHECK_NEAR(placement.axisY[1], 0.0, 1e-4);
+
+  const ScreenRect rect = screenRect(attributes, 400, 400);
+  SS_CHECK_NEAR(rect.maxX - rect.minX, 10.0, 1e-4);
+  SS_CHECK_NEAR(rect.maxY - rect.minY, 40.0, 1e-4);
+}
+
+SS_TEST(layout, solvedPlacementProjectsToScreenPlacement)
+{
+  const CameraBasis cameras[] = {
+    perspectiveCamera(1920, 1080, Vec3{1.0f, 2.0f, 10.0f}),
+    perspectiveCamera(720, 1280, Vec3{0.0f, 0.0f, 3.0f}),
+    orthographicCamera(1920, 1080, Vec3{1.0f, 2.0f, 10.0f}, 30.0f),
+  };
+  const std::vector<LayoutAttributes> layouts = randomLayouts(500, 4);
+
+  for (const CameraBasis& camera : cameras)
+  {
+    for (const LayoutAttributes& attributes : layouts)
+    {
+      Viewport viewport;
+      const Placement placement = solvePlacement(camera, attributes, viewport);
+      SS_CHECK(viewport.width == camera.width && viewport.height == camera.height);
+
+      // Center and both axis ends land on the pixels the screen
+      // placement predicts
+      const ScreenPlacement screen = screenPlacement(attributes, camera.width, camera.height);
+      const Vec3 origin = {placement.origin[0], placement.origin[1], placement.origin[2]};
+      const Vec3 axisX = {placement.axisX[0], placement.axisX[1], placement.axisX[2]};
+      const Vec3 axisY = {placement.axisY[0], placement.axisY[1], placement.axisY[2]};
+      float x, y;
+      worldToViewport(camera, origin, x, y);
+      SS_CHECK_NEAR(x, screen.center[0], 0.05);
+      SS_CHECK_NEAR(y, screen.center[1], 0.05);
+      worldToViewport(camera, origin + axisX, x, y);
+      SS_CHECK_NEAR(x, screen.center[0] + screen.axisX[0], 0.05);
+      SS_CHECK_NEAR(y, screen.center[1] + screen.axisX[1], 0.05);
+      worldToViewport(camera, origin + axisY, x, y);
+      SS_CHECK_NEAR(x, screen.center[0] + screen.axisY[0], 0.05);
+      SS_CHECK_NEAR(y, screen.center[1] + screen.axisY[1], 0.05);
+
+      // Unit shapes face the camera
+      SS_CHECK_NEAR(dot(axisX, camera.back), 0.0, 1e-6);
+      SS_CHECK_NEAR(dot(axisY, camera.back), 0.0, 1e-6);
+    }
+  }
+}
+
+SS_TEST(layout, pixelSizeFollowsUnits)
+{
+  LayoutAttributes attributes = absoluteLayout(0.0f, 0.0f, 30.0f, 40.0f);
+  attributes.size = 2.0f;
+  float sizeX, sizeY;
+  pixelSize(attributes, 400, 200, sizeX, sizeY);
+  SS_CHECK_NEAR(sizeX, 60.0, 1e-5);
+  SS_CHECK_NEAR(sizeY, 80.0, 1e-5);
+  SS_CHECK_NEAR(pixelRadius(attributes, 400, 200), 40.0, 1e-5);
+
+  attributes.position = Position::Relative;
+  pixelSize(attributes, 400, 200, sizeX, sizeY);
+  SS_CHECK_NEAR(sizeX, 240.0, 1e-4);
+  SS_CHECK_NEAR(sizeY, 160.0, 1e-4);
+}
+
+SS_TEST(layout, cullsOffscreenAndSubPixel)
+{
+  SS_CHECK(cullLayout(absoluteLayout(10.0f, 10.0f, 20.0f, 20.0f), 100, 100) == Visibility::Visible);
+
+  // Off every side
+  SS_CHECK(cullLayout(absoluteLayout(-30.0f, 10.0f, 20.0f, 20.0f), 100, 100) == Visibility::Offscreen);
+  SS_CHECK(cullLayout(absoluteLayout(10.0f, -30.0f, 20.0f, 20.0f), 100, 100) == Visibility::Offscreen);
+  SS_CHECK(cullLayout(absoluteLayout(110.0f, 10.0f, 20.0f, 20.0f), 100, 100) == Visibility::Offscreen);
+  SS_CHECK(cullLayout(absoluteLayout(10.0f, 110.0f, 20.0f, 20.0f), 100, 100) == Visibility::Offscreen);
+
+  // Touching the border within a pixel of slack
+  SS_CHECK(cullLayout(absoluteLayout(-20.5f, 10.0f, 20.0f, 20.0f), 100, 100) == Visibility::Visible);
+  SS_CHECK(cullLayout(absoluteLayout(100.5f, 10.0f, 20.0f, 20.0f), 100, 100) == Visibility::Visible);
+
+  // Only culled once small in both directions
+  SS_CHECK(cullLayout(absoluteLayout(50.0f, 50.0f, 0.25f, 0.25f), 100, 100) == Visibility::SubPixel);
+  SS_CHECK(cullLayout(absoluteLayout(50.0f, 50.0f, 2.0f, 0.25f), 100, 100) == Visibility::Visible);
+
+  // A shape rotated back onto the screen isn't culled
+  LayoutAttributes rotated = absoluteLayout(5.0f, 50.0f, 40.0f, 2.0f);
+  rotated.rotate = 2.0f * kHalfPi;
+  SS_CHECK(cullLayout(rotated, 100, 100) == Visibility::Visible);
+}
+
+SS_TEST(layout, placementMatrixMapsUnitSquare)
+{
+  const CameraBasis camera = perspectiveCamera(1920, 1080, Vec3{0.0f, 0.0f, 10.0f});
+  for (const LayoutAttributes& attributes : randomLayouts(50, 5))
+  {
+    Viewport viewport;
+    const Placement placement = solvePlacement(camera, attributes, viewport);
+    const Mat4 matrix = placementMatrix(placement);
+    Vec3 min, max;
+    placementBounds(placement, min, max);
+
+    for (float u : {-0.5f, 0.5f})
+    {
+      for (float v : {-0.5f, 0.5f})
+      {
+        const Vec3 corner = transformPoint(Vec3{u, v, 0.0f}, matrix);
+        SS_CHECK_NEAR(corner.x, placement.origin[0] + u * placement.axisX[0] + v * placement.axisY[0], 1e-5);
+        SS_CHECK_NEAR(corner.y, placement.origin[1] + u * placement.axisX[1] + v * placement.axisY[1], 1e-5);
+        SS_CHECK_NEAR(corner.z, placement.origin[2] + u * placement.axisX[2] + v * placement.axisY[2], 1e-5);
+        SS_CHECK(corner.x >= min.x - 1e-5f && corner.x <= max.x + 1e-5f);
+        SS_CHECK(corner.y >= min.y - 1e-5f && corner.y <= max.y + 1e-5f);
+        SS_CHECK(corner.z >= min.z - 1e-5f && corner.z <= max.z + 1e-5f);
+      }
+    }
+  }
+}
@@ -0,0 +1,282 @@
+#include "Test.hh"
+
+#include "ss/core/Layout.hh"
+
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+namespace {
+
+/// Double precision vector for the legacy chain.
+struct Vec3d {
+  double x, y, z;
+};
+
+inline Vec3d operator+(const Vec3d& a, const Vec3d& b) { return Vec3d{a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline Vec3d operator-(const Vec3d& a, const Vec3d& b) { return Vec3d{a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3d operator*(const Vec3d& a, double s) { return Vec3d{a.x * s, a.y * s, a.z * s}; }
+inline double dot(const Vec3d& a, const Vec3d& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3d toDouble(const Vec3& a) { return Vec3d{a.x, a.y, a.z}; }
+
+inline Vec3d normalized(const Vec3d& a)
+{
+  const double length = std::sqrt(dot(a, a));
+  return length > 0.0 ? a * (1.0 / length) : a;
+}
+
+/// Row major 4x4 matrix applied to row vectors, like MMatrix.
+struct Matrix {
+  double m[4][4];
+};
+
+Matrix identity()
+{
+  Matrix result = {};
+  for (int i = 0; i < 4; ++i)
+    result.m[i][i] = 1.0;
+  return result;
+}
+
+Matrix operator*(const Matrix& a, const Matrix& b)
+{
+  Matrix result = {};
+  for (int row = 0; row < 4; ++row)
+    for (int column = 0; column < 4; ++column)
+      for (int k = 0; k < 4; ++k)
+        result.m[row][column] += a.m[row][k] * b.m[k][column];
+  return result;
+}
+
+Matrix translation(const Vec3d& t)
+{
+  Matrix result = identity();
+  result.m[3][0] = t.x;
+  result.m[3][1] = t.y;
+  result.m[3][2] = t.z;
+  return result;
+}
+
+Matrix scale(double x, double y, double z)
+{
+  Matrix result = identity();
+  result.m[0][0] = x;
+  result.m[1][1] = y;
+  result.m[2][2] = z;
+  return result;
+}
+
+/// Rotation about z, like MTransformationMatrix::setToRotationAxis.
+Matrix rotationZ(double angle)
+{
+  Matrix result = identity();
+  result.m[0][0] = std::cos(angle);
+  result.m[0][1] = std::sin(angle);
+  result.m[1][0] = -std::sin(angle);
+  result.m[1][1] = std::cos(angle);
+  return result;
+}
+
+/// CameraContext::viewportToWorld, in double like the MPoint original.
+Vec3d legacyViewportToWorld(const CameraBasis& camera, int x, int y, int depth)
+{
+  const Vec3d near = toDouble(camera.nearOrigin) + toDouble(camera.nearX) * x + toDouble(camera.nearY) * y;
+  const Vec3d far = toDouble(camera.farOrigin) + toDouble(camera.farX) * x + toDouble(camera.farY) * y;
+  const Vec3d direction = normalized(far - near);
+  const float scalar = camera.nearClipPlane + 0.001f * (depth + 1);
+  return near + direction * scalar;
+}
+
+/// The matrix chain prepareMatrix built before solvePlacement, pivot,
+/// scale, rotate and translate multiplied as double matrices. Kept
+/// step for step, including its float intermediates and the pixel
+/// truncation of the offset.
+Matrix legacyWorldMatrix(const CameraBasis& camera, const LayoutAttributes& attributes)
+{
+  const int depth = attributes.depth;
+  const Vec3d nearBL = legacyViewportToWorld(camera, 0, 0, depth);
+  const Vec3d nearTR = legacyViewportToWorld(camera, camera.width, camera.height, depth);
+  const Vec3d diagonal = nearTR - nearBL;
+  const float hyp = float(std::sqrt(dot(diagonal, diagonal)));
+  const float worldspaceWidth = camera.diagonalCos * hyp;
+  const float worldspaceHeight = camera.diagonalSin * hyp;
+
+  float worldspaceUnitX, worldspaceUnitY, viewportUnitX, viewportUnitY;
+  if (attributes.position == Position::Relative)
+  {
+    worldspaceUnitX = worldspaceWidth / 100.0f;
+    worldspaceUnitY = worldspaceHeight / 100.0f;
+    viewportUnitX = camera.width / 100.0f;
+    viewportUnitY = camera.height / 100.0f;
+  }
+  else
+  {
+    worldspaceUnitX = worldspaceWidth / camera.width;
+    worldspaceUnitY = worldspaceHeight / camera.height;
+    viewportUnitX = 1.0f;
+    viewportUnitY = 1.0f;
+  }
+
+  const float alignOffsetX = attributes.horizontalAlign == HorizontalAlign::Left ? 0.0f :
+                             attributes.horizontalAlign == HorizontalAlign::Middle ? camera.width / 2.0f :
+                             float(camera.width);
+  const float alignOffsetY = attributes.verticalAlign == VerticalAlign::Bottom ? 0.0f :
+                             attributes.verticalAlign == VerticalAlign::Middle ? camera.height / 2.0f :
+                             float(camera.height);
+
+  const Vec3d viewportOffset = legacyViewportToWorld(camera,
+                                                     int((alignOffsetX + attributes.offsetX) * viewportUnitX),
+                                                     int((alignOffsetY + attributes.offsetY) * viewportUnitY),
+                                                     depth);
+
+  // linePlaneIntersection, with its float dot and scalar
+  const Vec3d eye = toDouble(camera.eye);
+  const Vec3d normal = toDouble(camera.normal);
+  const Vec3d ray = normalized(viewportOffset - eye);
+  const float planeDot = float(dot(normal, nearBL));
+  const float scalar = float((planeDot - dot(normal, eye)) / dot(normal, ray));
+  const Vec3d origin = eye + ray * scalar;
+
+  Matrix rotation = identity();
+  const Vec3* axes[] = {&camera.right, &camera.up, &camera.back};
+  for (int row = 0; row < 3; ++row)
+  {
+    rotation.m[row][0] = axes[row]->x;
+    rotation.m[row][1] = axes[row]->y;
+    rotation.m[row][2] = axes[row]->z;
+  }
+
+  const float size = attributes.size;
+  return translation(Vec3d{0.5, 0.5, 0.0}) *
+         scale(size * attributes.width * worldspaceUnitX, size * attributes.height * worldspaceUnitY, 1.0) *
+         (rotationZ(attributes.rotate) * rotation) *
+         translation(origin);
+}
+
+/// Turn a camera about its eye, so its axes aren't the world's.
+/// \param camera The camera.
+/// \param yaw Rotation about y in radians.
+/// \param pitch Rotation about the rotated x in radians.
+/// \return The turned camera.
+CameraBasis turned(const CameraBasis& camera, float yaw, float pitch)
+{
+  const float cy = std::cos(yaw), sy = std::sin(yaw);
+  const float cp = std::cos(pitch), sp = std::sin(pitch);
+  const auto rotate = [&](const Vec3& v) {
+    const Vec3 pitched = {v.x, v.y * cp - v.z * sp, v.y * sp + v.z * cp};
+    return Vec3{pitched.x * cy + pitched.z * sy, pitched.y, -pitched.x * sy + pitched.z * cy};
+  };
+  const auto rotatePoint = [&](const Vec3& p) { return camera.eye + rotate(p - camera.eye); };
+
+  CameraBasis result = camera;
+  result.nearOrigin = rotatePoint(camera.nearOrigin);
+  result.farOrigin = rotatePoint(camera.farOrigin);
+  result.nearX = rotate(camera.nearX);
+  result.nearY = rotate(camera.nearY);
+  result.farX = rotate(camera.farX);
+  result.farY = rotate(camera.farY);
+  result.normal = rotate(camera.normal);
+  result.right = rotate(camera.right);
+  result.up = rotate(camera.up);
+  result.back = rotate(camera.back);
+  return result;
+}
+
+/// Random layouts over every position, alignment and depth, most of
+/// them on screen.
+std::vector<LayoutAttributes> randomLayouts(std::size_t count, unsigned int seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::uniform_int_distribution<int> depth(0, 30);
+  std::uniform_int_distribution<int> choice(0, 2);
+
+  std::vector<LayoutAttributes> layouts(count);
+  for (LayoutAttributes& attributes : layouts)
+  {
+    attributes.horizontalAlign = static_cast<HorizontalAlign>(choice(generator));
+    attributes.verticalAlign = static_cast<VerticalAlign>(choice(generator));
+    attributes.depth = depth(generator);
+    attributes.size = 0.25f + unit(generator) * 4.0f;
+    attributes.rotate = (unit(generator) - 0.5f) * 7.0f;
+    if (choice(generator) == 0)
+    {
+      // Relative units scale the alignment anchor too, so anything
+      // but the bottom left corner lands off screen
+      attributes.position = Position::Relative;
+      attributes.horizontalAlign = HorizontalAlign::Left;
+      attributes.verticalAlign = VerticalAlign::Bottom;
+      attributes.width = 0.5f + unit(generator) * 5.0f;
+      attributes.height = 0.5f + unit(generator) * 5.0f;
+      attributes.offsetX = unit(generator) * 100.0f;
+      attributes.offsetY = unit(generator) * 100.0f;
+    }
+    else
+    {
+      attributes.position = Position::Absolute;
+      attributes.width = 0.5f + unit(generator) * 20.0f;
+      attributes.height = 0.5f + unit(generator) * 20.0f;
+      attributes.offsetX = (unit(generator) - 0.5f) * 800.0f;
+      attributes.offsetY = (unit(generator) - 0.5f) * 800.0f;
+    }
+  }
+  return layouts;
+}
+
+}
+
+SS_TEST(placement, matchesLegacyMatrixChain)
+{
+  // Perspective and orthographic, wide, tall and square, some turned
+  // away from the world axes
+  const std::pair<int, int> sizes[] = {{1920, 1080}, {1080, 1920}, {800, 800}, {3840, 1000}};
+  std::vector<CameraBasis> cameras;
+  for (const auto& size : sizes)
+  {
+    cameras.push_back(perspectiveCamera(size.first, size.second, Vec3{0.5f, -0.25f, 2.0f}));
+    cameras.push_back(perspectiveCamera(size.first, size.second, Vec3{3.0f, 1.0f, 10.0f}));
+    cameras.push_back(orthographicCamera(size.first, size.second, Vec3{0.5f, -0.25f, 2.0f}, 30.0f));
+    cameras.push_back(orthographicCamera(size.first, size.second, Vec3{0.0f, 0.0f, 10.0f}, 2.0f));
+  }
+  const std::size_t unturned = cameras.size();
+  for (std::size_t i = 0; i < unturned; ++i)
+    cameras.push_back(turned(cameras[i], 0.6f, -0.3f));
+
+  const std::vector<LayoutAttributes> layouts = randomLayouts(400, 7);
+  std::size_t compared = 0;
+  for (const CameraBasis& camera : cameras)
+  {
+    // Within a twentieth of a pixel on the near plane, or a few float
+    // steps where pixels are finer than float resolves this far from
+    // the origin
+    const double pixel = length(camera.nearX);
+    for (const LayoutAttributes& attributes : layouts)
+    {
+      // Placement is only solved for pickables that pass the cull
+      if (cullLayout(attributes, camera.width, camera.height) != Visibility::Visible)
+        continue;
+      ++compared;
+
+      Viewport viewport;
+      const Mat4 solved = placementMatrix(solvePlacement(camera, attributes, viewport));
+      const Matrix legacy = legacyWorldMatrix(camera, attributes);
+      for (int row = 0; row < 4; ++row)
+      {
+        for (int column = 0; column < 4; ++column)
+        {
+          const double expected = legacy.m[row][column];
+          const double tolerance = 0.05 * pixel + 4.0 * FLT_EPSILON * std::fabs(expected);
+          SS_CHECK_NEAR(solved.m[row][column], expected, tolerance);
+        }
+      }
+    }
+  }
+
+  // Most random layouts are on screen in every camera
+  SS_CHECK(compared > cameras.size() * layouts.size() / 2);
+}
@@ -0,0 +1,232 @@
+#include "Test.hh"
+
+#include "ss/core/Prepare.hh"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+namespace {
+
+struct Color {
+  float r, g, b, a;
+};
+
+struct Attributes : LayoutAttributes {
+  Shape shape;
+  ShapeParameters parameters;
+  Color color;
+  bool show;
+  std::uint64_t group;
+  std::uint64_t outline;
+};
+
+struct Geometry {
+  ShapeKey key;
+  std::size_t lod;
+};
+
+struct Data {
+  Attributes m_attributes;
+  Placement m_placement;
+  const Geometry* m_geometry;
+  StageInputs m_inputs;
+  Visibility m_visibility;
+  bool m_prepared;
+  bool m_pending;
+};
+
+/// Pickable in the middle of a perspective view, counting the work
+/// each stage asks of it.
+class Source {
+public:
+  using GeometryRef = const Geometry*;
+  using Vertices = std::vector<float>;
+
+  Source()
+      : attributes(),
+        layout(1),
+        style(1),
+        key(1),
+        view(perspectiveCamera(1920, 1080, Vec3{0.0f, 0.0f, 10.0f})),
+        reads(0),
+        tessellations(0),
+        placements(0),
+        vertices(0),
+        m_unit(),
+        m_parametric()
+  {
+    attributes.size = 1.0f;
+    attributes.width = 20.0f;
+    attributes.height = 20.0f;
+    attributes.depth = 10;
+    attributes.position = Position::Absolute;
+    attributes.horizontalAlign = HorizontalAlign::Middle;
+    attributes.verticalAlign = VerticalAlign::Middle;
+    attributes.rotate = 0.0f;
+    attributes.offsetX = 0.0f;
+    attributes.offsetY = 0.0f;
+    attributes.shape = Shape::Circle;
+    attributes.parameters = {0.25f, 0.5f, 360.0f, 6};
+    attributes.color = {1.0f, 1.0f, 0.0f, 1.0f};
+    attributes.show = true;
+    attributes.group = 0;
+    attributes.outline = 0;
+    for (std::size_t lod = 0; lod < kNumCircleLods + 2; ++lod)
+      m_unit.push_back(Geometry{ShapeKey{Shape::Circle, 0, 0, 0, 0, 0, 0}, lod});
+  }
+
+  Data data()
+  {
+    return Data{Attributes(), Placement(), &m_unit[kDefaultCircleLod], {0, 0, 0, 0, 0, 0},
+                Visibility::Visible, false, false};
+  }
+
+  unsigned int layoutVersion() const { return layout; }
+  unsigned int styleVersion() const { return style; }
+  std::size_t cameraKey() const { return key; }
+  std::size_t transformKey() const { return 0; }
+  const CameraBasis& camera() const { return view; }
+  float circleTolerance() const { return 0.25f; }
+
+  void readAttributes(Attributes& read)
+  {
+    read = attributes;
+    ++reads;
+  }
+
+  const Geometry* unitGeometry(Shape shape, std::size_t lod) const
+  {
+    return &m_unit[shape == Shape::Circle ? lod : kNumCircleLods];
+  }
+
+  const Geometry* parametricGeometry(const ShapeKey& shapeKey)
+  {
+    ++tessellations;
+    m_parametric.emplace_back(new Geometry{shapeKey, 0});
+    return m_parametric.back().get();
+  }
+
+  OutlineState outlineGeometry(std::uint64_t, const Geometry**) const
+  {
+    return OutlineState::Failed;
+  }
+
+  void verifyPlacement(const Data&, const Viewport&) { ++placements; }
+  void prepareVertices(const Data&, std::vector<float>&) { ++vertices; }
+
+  Attributes attributes;
+  unsigned int layout;
+  unsigned int style;
+  std::size_t key;
+  CameraBasis view;
+  int reads;
+  int tessellations;
+  int placements;
+  int vertices;
+
+private:
+  std::vector<Geometry> m_unit;
+  std::vector<std::unique_ptr<Geometry>> m_parametric;
+};
+
+}
+
+SS_TEST(prepare, unchangedInputsSkipEveryStage)
+{
+  Source source;
+  Data data = source.data();
+  std::vector<float> vertices;
+
+  const PrepareResult first = prepareStages(source, data, &vertices);
+  SS_CHECK(first.style && first.matrix && !first.culled);
+  SS_CHECK(source.reads == 1 && source.placements == 1 && source.vertices == 1);
+
+  const PrepareResult second = prepareStages(source, data, &vertices);
+  SS_CHECK(!second.style && !second.matrix && !second.culled);
+  SS_CHECK(source.reads == 1 && source.placements == 1 && source.vertices == 1);
+}
+
+SS_TEST(prepare, cameraMovesPlaceWithoutReading)
+{
+  Source source;
+  Data data = source.data();
+  prepareStages(source, data, nullptr);
+
+  source.key = 2;
+  const PrepareResult result = prepareStages(source, data, nullptr);
+  SS_CHECK(!result.style && result.matrix);
+  SS_CHECK(source.reads == 1 && source.placements == 2 && source.vertices == 0);
+}
+
+SS_TEST(prepare, culledPickablesAreNotPlaced)
+{
+  Source source;
+  source.attributes.color.a = 0.0f;
+  Data data = source.data();
+  std::vector<float> vertices;
+
+  const PrepareResult result = prepareStages(source, data, &vertices);
+  SS_CHECK(result.culled && !result.matrix);
+  SS_CHECK(source.placements == 0 && source.vertices == 0);
+
+  // Shown again, the placement is solved once it is visible
+  source.attributes.color.a = 1.0f;
+  ++source.style;
+  const PrepareResult shown = prepareStages(source, data, &vertices);
+  SS_CHECK(!shown.culled && shown.matrix);
+  SS_CHECK(source.placements == 1 && source.vertices == 1);
+
+  // Off screen
+  source.attributes.offsetX = 5000.0f;
+  ++source.layout;
+  SS_CHECK(prepareStages(source, data, &vertices).culled);
+  SS_CHECK(source.placements == 1);
+}
+
+SS_TEST(prepare, circlesFollowTheirSizeOnScreen)
+{
+  Source source;
+  Data data = source.data();
+  prepareStages(source, data, nullptr);
+  const std::size_t small = data.m_geometry->lod;
+
+  source.attributes.size = 20.0f;
+  ++source.layout;
+  prepareStages(source, data, nullptr);
+  SS_CHECK(data.m_geometry->lod > small);
+}
+
+SS_TEST(prepare, parametricKeysAreOnlyLookedUpWhenTheyChange)
+{
+  Source source;
+  source.attributes.shape = Shape::RoundedRectangle;
+  Data data = source.data();
+  prepareStages(source, data, nullptr);
+  SS_CHECK(source.tessellations == 1);
+  SS_CHECK(data.m_geometry->key.shape == Shape::RoundedRectangle);
+
+  // Same size on screen from another camera position
+  source.key = 2;
+  prepareStages(source, data, nullptr);
+  SS_CHECK(source.tessellations == 1 && source.placements == 2);
+
+  source.attributes.width = 400.0f;
+  ++source.layout;
+  prepareStages(source, data, nullptr);
+  SS_CHECK(source.tessellations == 2);
+}
+
+SS_TEST(prepare, customShapesFallBackToRectangles)
+{
+  Source source;
+  source.attributes.shape = Shape::Custom;
+  source.attributes.outline = 42;
+  Data data = source.data();
+  const PrepareResult result = prepareStages(source, data, nullptr);
+  SS_CHECK(!result.culled && !data.m_pending);
+  SS_CHECK(data.m_geometry->lod == kNumCircleLods);
+}
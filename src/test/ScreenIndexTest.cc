@@ -0,0 +1,253 @@
+#include "Test.hh"
+
+#include "ss/core/Outline.hh"
+#include "ss/core/Outlines.hh"
+#include "ss/core/ScreenIndex.hh"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+namespace {
+
+const float kPi = 3.14159265358979f;
+
+/// A pickable centered at (200, 150), width by height pixels.
+ScreenEntry makeEntry(Shape shape, float width, float height)
+{
+  ScreenEntry entry = {};
+  entry.id = 1;
+  entry.placement = ScreenPlacement{{200.0f, 150.0f}, {width, 0.0f}, {0.0f, height}};
+  entry.shape = shape;
+  entry.parameters = ShapeParameters{0.25f, 0.5f, 360.0f, 6};
+  return entry;
+}
+
+/// Pixel of a point in the entry's unit space.
+void toPixel(const ScreenEntry& entry, float u, float v, float& x, float& y)
+{
+  const ScreenPlacement& placement = entry.placement;
+  x = placement.center[0] + u * placement.axisX[0] + v * placement.axisY[0];
+  y = placement.center[1] + u * placement.axisX[1] + v * placement.axisY[1];
+}
+
+/// Check a point given in the entry's unit space.
+bool containsUnit(const ScreenEntry& entry, float u, float v)
+{
+  float x, y;
+  toPixel(entry, u, v, x, y);
+  return containsPoint(entry, x, y);
+}
+
+/// Check a rectangle given by unit space corners.
+bool overlapsUnit(const ScreenEntry& entry, float minU, float minV, float maxU, float maxV)
+{
+  ScreenRect rect;
+  toPixel(entry, minU, minV, rect.minX, rect.minY);
+  toPixel(entry, maxU, maxV, rect.maxX, rect.maxY);
+  return overlapsRect(entry, rect);
+}
+
+}
+
+SS_TEST(screenindex, circlesAreExact)
+{
+  // An ellipse, 200 by 100 pixels
+  const ScreenEntry entry = makeEntry(Shape::Circle, 200.0f, 100.0f);
+  SS_CHECK(containsUnit(entry, 0.0f, 0.0f));
+  SS_CHECK(containsUnit(entry, 0.49f, 0.0f));
+  SS_CHECK(containsUnit(entry, 0.0f, -0.49f));
+  SS_CHECK(containsUnit(entry, 0.34f, 0.34f));
+  SS_CHECK(!containsUnit(entry, 0.36f, 0.36f));
+  SS_CHECK(!containsUnit(entry, 0.51f, 0.0f));
+
+  // Inside the bounds but outside the curve, then across it
+  SS_CHECK(!overlapsUnit(entry, 0.37f, 0.37f, 0.6f, 0.6f));
+  SS_CHECK(overlapsUnit(entry, 0.34f, 0.34f, 0.6f, 0.6f));
+
+  // Enclosing the ellipse, and a strip through the center with every
+  // corner outside
+  SS_CHECK(overlapsUnit(entry, -1.0f, -1.0f, 1.0f, 1.0f));
+  SS_CHECK(overlapsUnit(entry, -1.0f, -0.01f, 1.0f, 0.01f));
+  SS_CHECK(!overlapsUnit(entry, -1.0f, 0.51f, 1.0f, 0.6f));
+}
+
+SS_TEST(screenindex, trianglesAndRectangles)
+{
+  const ScreenEntry triangle = makeEntry(Shape::Triangle, 100.0f, 100.0f);
+  SS_CHECK(containsUnit(triangle, 0.0f, 0.4f));
+  SS_CHECK(containsUnit(triangle, -0.45f, -0.45f));
+  SS_CHECK(!containsUnit(triangle, -0.4f, 0.4f));
+  SS_CHECK(!containsUnit(triangle, 0.4f, 0.4f));
+  SS_CHECK(!overlapsUnit(triangle, 0.3f, 0.3f, 0.6f, 0.6f));
+  SS_CHECK(overlapsUnit(triangle, 0.1f, 0.1f, 0.6f, 0.6f));
+
+  // Rotated a quarter turn, the tip points left
+  ScreenEntry turned = triangle;
+  turned.placement.axisX[0] = 0.0f;
+  turned.placement.axisX[1] = 100.0f;
+  turned.placement.axisY[0] = -100.0f;
+  turned.placement.axisY[1] = 0.0f;
+  SS_CHECK(containsPoint(turned, 200.0f - 40.0f, 150.0f));
+  SS_CHECK(!containsPoint(turned, 200.0f - 40.0f, 150.0f + 40.0f));
+
+  const ScreenEntry rectangle = makeEntry(Shape::Rectangle, 100.0f, 40.0f);
+  SS_CHECK(containsPoint(rectangle, 249.0f, 169.0f));
+  SS_CHECK(!containsPoint(rectangle, 251.0f, 150.0f));
+  SS_CHECK(!containsPoint(rectangle, 200.0f, 171.0f));
+  SS_CHECK(overlapsRect(rectangle, ScreenRect{249.0f, 169.0f, 300.0f, 300.0f}));
+  SS_CHECK(!overlapsRect(rectangle, ScreenRect{251.0f, 0.0f, 300.0f, 300.0f}));
+}
+
+SS_TEST(screenindex, roundedCornersAreRound)
+{
+  // Corner radius of a quarter of the side, centered 25 pixels in
+  ScreenEntry rounded = makeEntry(Shape::RoundedRectangle, 100.0f, 100.0f);
+  rounded.parameters.cornerRadius = 0.5f;
+  SS_CHECK(containsUnit(rounded, 0.49f, 0.0f));
+  SS_CHECK(containsUnit(rounded, 0.4f, 0.4f));
+  SS_CHECK(!containsUnit(rounded, 0.47f, 0.47f));
+  SS_CHECK(!containsUnit(rounded, -0.47f, -0.47f));
+
+  // A marquee in the cut off corner misses, one reaching past the
+  // curve hits, and so does a strip with every corner outside
+  SS_CHECK(!overlapsUnit(rounded, 0.46f, 0.46f, 0.6f, 0.6f));
+  SS_CHECK(overlapsUnit(rounded, 0.42f, 0.42f, 0.6f, 0.6f));
+  SS_CHECK(overlapsUnit(rounded, 0.44f, -0.6f, 0.46f, 0.6f));
+
+  // Square corners fill the bounds
+  rounded.parameters.cornerRadius = 0.0f;
+  SS_CHECK(containsUnit(rounded, 0.49f, 0.49f));
+
+  // The corners of a capsule are round on screen, half its height
+  const ScreenEntry capsule = makeEntry(Shape::Capsule, 200.0f, 50.0f);
+  SS_CHECK(containsUnit(capsule, 0.45f, 0.0f));
+  SS_CHECK(containsUnit(capsule, 0.37f, 0.49f));
+  SS_CHECK(!containsUnit(capsule, 0.45f, 0.45f));
+  SS_CHECK(!overlapsUnit(capsule, 0.47f, 0.4f, 0.6f, 0.6f));
+  SS_CHECK(overlapsUnit(capsule, -0.6f, 0.4f, -0.3f, 0.6f));
+}
+
+SS_TEST(screenindex, ringArcs)
+{
+  ScreenEntry ring = makeEntry(Shape::Ring, 100.0f, 100.0f);
+  SS_CHECK(containsUnit(ring, 0.375f, 0.0f));
+  SS_CHECK(containsUnit(ring, 0.0f, -0.375f));
+  SS_CHECK(!containsUnit(ring, 0.0f, 0.0f));
+  SS_CHECK(!containsUnit(ring, 0.2f, 0.0f));
+  SS_CHECK(!containsUnit(ring, 0.4f, 0.4f));
+
+  // A marquee in the hole misses, a strip across the band hits with
+  // every corner outside the ring
+  SS_CHECK(!overlapsUnit(ring, -0.1f, -0.1f, 0.1f, 0.1f));
+  SS_CHECK(overlapsUnit(ring, -0.6f, -0.01f, -0.1f, 0.01f));
+  SS_CHECK(overlapsUnit(ring, -0.6f, -0.6f, 0.6f, 0.6f));
+
+  // A quarter arc, counterclockwise from the right
+  ring.parameters.arcAngle = 90.0f;
+  const float radius = 0.375f;
+  const float inside[] = {1.0f, 45.0f, 89.0f};
+  const float outside[] = {91.0f, 135.0f, 225.0f, 359.0f};
+  for (float degrees : inside)
+    SS_CHECK(containsUnit(ring, radius * std::cos(degrees * kPi / 180.0f),
+                          radius * std::sin(degrees * kPi / 180.0f)));
+  for (float degrees : outside)
+    SS_CHECK(!containsUnit(ring, radius * std::cos(degrees * kPi / 180.0f),
+                           radius * std::sin(degrees * kPi / 180.0f)));
+  SS_CHECK(!overlapsUnit(ring, -0.6f, -0.6f, -0.1f, -0.1f));
+  SS_CHECK(overlapsUnit(ring, 0.1f, 0.1f, 0.2f, 0.6f));
+
+  // A pie slice has no hole
+  ring.parameters.innerRadius = 0.0f;
+  SS_CHECK(containsUnit(ring, 0.05f, 0.05f));
+}
+
+SS_TEST(screenindex, polygonsHaveFlatEdges)
+{
+  // A hexagon with a corner on top has flat sides left and right
+  const ScreenEntry hexagon = makeEntry(Shape::Polygon, 100.0f, 100.0f);
+  SS_CHECK(containsUnit(hexagon, 0.0f, 0.49f));
+  SS_CHECK(containsUnit(hexagon, 0.42f, 0.0f));
+  SS_CHECK(!containsUnit(hexagon, 0.45f, 0.0f));
+  SS_CHECK(!containsUnit(hexagon, -0.45f, 0.0f));
+  SS_CHECK(!containsUnit(hexagon, 0.3f, 0.45f));
+  SS_CHECK(!overlapsUnit(hexagon, 0.44f, -0.1f, 0.6f, 0.1f));
+  SS_CHECK(overlapsUnit(hexagon, 0.42f, -0.1f, 0.6f, 0.1f));
+}
+
+SS_TEST(screenindex, customOutlines)
+{
+  // An L with the top right quarter cut out
+  const std::vector<float> points = {0.0f, 0.0f, 2.0f, 0.0f, 2.0f, 1.0f,
+                                     1.0f, 1.0f, 1.0f, 2.0f, 0.0f, 2.0f};
+  const std::uint64_t key = outlineKey("", points);
+  ScreenEntry entry = makeEntry(Shape::Custom, 100.0f, 100.0f);
+  entry.outline = key;
+
+  // The rectangle stands in until the outline is ready
+  SS_CHECK(containsUnit(entry, 0.25f, 0.25f));
+
+  Outlines::instance().request(key, "", points);
+  const ShapeMesh* mesh = nullptr;
+  for (int i = 0; i < 500 && Outlines::instance().find(key, &mesh) == OutlineState::Pending; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  SS_CHECK(Outlines::instance().find(key, &mesh) == OutlineState::Ready);
+
+  SS_CHECK(containsUnit(entry, -0.25f, 0.25f));
+  SS_CHECK(containsUnit(entry, 0.25f, -0.25f));
+  SS_CHECK(!containsUnit(entry, 0.25f, 0.25f));
+  SS_CHECK(!overlapsUnit(entry, 0.1f, 0.1f, 0.4f, 0.4f));
+  SS_CHECK(overlapsUnit(entry, -0.1f, 0.1f, 0.4f, 0.4f));
+}
+
+SS_TEST(screenindex, queriesFindTopmostFirst)
+{
+  ScreenIndex index;
+  index.reset(800, 600);
+
+  // Overlapping circles, a lower depth is drawn on top
+  ScreenEntry bottom = makeEntry(Shape::Circle, 100.0f, 100.0f);
+  bottom.id = 10;
+  bottom.depth = 5;
+  ScreenEntry top = bottom;
+  top.id = 11;
+  top.depth = 1;
+  top.placement.center[0] += 60.0f;
+  ScreenEntry apart = bottom;
+  apart.id = 12;
+  apart.placement.center[0] = 600.0f;
+  apart.placement.center[1] = 450.0f;
+  ScreenEntry offscreen = bottom;
+  offscreen.id = 13;
+  offscreen.placement.center[0] = -200.0f;
+  index.add(bottom);
+  index.add(top);
+  index.add(apart);
+  index.add(offscreen);
+  index.build();
+  SS_CHECK(index.size() == 3);
+
+  std::vector<std::uint64_t> ids;
+  index.findAt(230.0f, 150.0f, ids);
+  SS_CHECK(ids == std::vector<std::uint64_t>({11, 10}));
+  index.findAt(170.0f, 150.0f, ids);
+  SS_CHECK(ids == std::vector<std::uint64_t>({10}));
+  index.findAt(600.0f, 450.0f, ids);
+  SS_CHECK(ids == std::vector<std::uint64_t>({12}));
+
+  // The corner of a circle's bounds is empty
+  index.findAt(153.0f, 197.0f, ids);
+  SS_CHECK(ids.empty());
+
+  index.findInRect(ScreenRect{0.0f, 0.0f, 800.0f, 600.0f}, ids);
+  SS_CHECK(ids == std::vector<std::uint64_t>({11, 10, 12}));
+  index.findInRect(ScreenRect{400.0f, 0.0f, 540.0f, 600.0f}, ids);
+  SS_CHECK(ids.empty());
+  index.findInRect(ScreenRect{255.0f, 100.0f, 400.0f, 200.0f}, ids);
+  SS_CHECK(ids == std::vector<std::uint64_t>({11}));
+}
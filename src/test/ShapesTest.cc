@@ -0,0 +1,97 @@
+#include "Test.hh"
+
+#include "ss/core/Shapes.hh"
+
+#include <algorithm>
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+static const double kPi = 3.14159265358979323846;
+
+/// Largest distance between a circle of radius 0.5 and the outline of
+/// a level of detail, at the middle of a chord.
+static double chordError(std::size_t lod)
+{
+  return 0.5 * (1.0 - std::cos(kPi / double(circleSegments(lod))));
+}
+
+SS_TEST(shapes, circleTablesAreFans)
+{
+  std::size_t previous = 0;
+  for (std::size_t lod = 0; lod < kNumCircleLods; ++lod)
+  {
+    const std::size_t segments = circleSegments(lod);
+    SS_CHECK(segments > previous);
+    previous = segments;
+
+    const UnitShape& circle = unitShape(Shape::Circle, lod);
+    SS_CHECK(circle.numPoints == segments + 1);
+    SS_CHECK(circle.numIndices == segments * 3);
+    SS_CHECK_NEAR(circle.points[0][0], 0.0, 0.0);
+    SS_CHECK_NEAR(circle.points[0][1], 0.0, 0.0);
+    for (std::size_t i = 1; i < circle.numPoints; ++i)
+      SS_CHECK_NEAR(std::hypot(circle.points[i][0], circle.points[i][1]), 0.5, 1e-6);
+
+    // Counterclockwise triangles around the center
+    for (std::size_t i = 0; i < circle.numIndices; i += 3)
+    {
+      SS_CHECK(circle.indices[i] == 0);
+      const float* a = circle.points[circle.indices[i + 1]];
+      const float* b = circle.points[circle.indices[i + 2]];
+      SS_CHECK(a[0] * b[1] - a[1] * b[0] > 0.0f);
+    }
+  }
+  SS_CHECK(circleSegments(0) == 8);
+  SS_CHECK(circleSegments(kNumCircleLods - 1) == 128);
+  SS_CHECK(circleSegments(kNumCircleLods + 3) == 128);
+  SS_CHECK(unitShape(Shape::Circle).numPoints == circleSegments(kDefaultCircleLod) + 1);
+}
+
+SS_TEST(shapes, circleLodIsCoarsestWithinTolerance)
+{
+  for (float tolerance : {0.1f, 0.25f, 1.0f})
+  {
+    std::size_t previous = 0;
+    for (float radius = 0.5f; radius < 5000.0f; radius *= 1.1f)
+    {
+      const std::size_t lod = circleLod(radius, tolerance);
+      SS_CHECK(lod >= previous);
+      previous = lod;
+
+      // Chord error scales with the diameter in pixels
+      const double scale = 2.0 * radius;
+      if (lod < kNumCircleLods - 1)
+        SS_CHECK(chordError(lod) * scale <= tolerance);
+      if (lod > 0)
+        SS_CHECK(chordError(lod - 1) * scale > tolerance);
+    }
+  }
+  SS_CHECK(circleLod(1.0f, 0.25f) == 0);
+  SS_CHECK(circleLod(1.0e6f, 0.25f) == kNumCircleLods - 1);
+}
+
+SS_TEST(shapes, constantShapesFillUnitSquare)
+{
+  for (Shape shape : {Shape::Rectangle, Shape::Triangle})
+  {
+    const UnitShape& unit = unitShape(shape);
+    float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+    for (std::size_t i = 0; i < unit.numPoints; ++i)
+    {
+      minX = std::min(minX, unit.points[i][0]);
+      minY = std::min(minY, unit.points[i][1]);
+      maxX = std::max(maxX, unit.points[i][0]);
+      maxY = std::max(maxY, unit.points[i][1]);
+    }
+    SS_CHECK_NEAR(minX, -0.5, 0.0);
+    SS_CHECK_NEAR(maxX, 0.5, 0.0);
+    SS_CHECK_NEAR(minY, -0.5, 0.0);
+    SS_CHECK(maxY <= 0.5f);
+    for (std::size_t i = 0; i < unit.numIndices; ++i)
+      SS_CHECK(unit.indices[i] < unit.numPoints);
+  }
+
+  // Parametric shapes aren't tabled
+  SS_CHECK(&unitShape(Shape::Ring) == &unitShape(Shape::Rectangle));
+}
@@ -0,0 +1,92 @@
+#include "Test.hh"
+
+#include "ss/core/Shapes.hh"
+#include "ss/core/Tessellate.hh"
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+/// Default attribute values of the parametric shapes.
+static const ShapeParameters kParameters = {0.25f, 0.5f, 360.0f, 6};
+
+SS_TEST(tessellate, nearbyParametersShareKeys)
+{
+  ShapeParameters nearby = kParameters;
+  nearby.cornerRadius += 0.0003f;
+  nearby.innerRadius -= 0.0003f;
+  nearby.arcAngle -= 0.04f;
+
+  const ShapeKeyHash hash;
+  for (Shape shape : {Shape::RoundedRectangle, Shape::Ring, Shape::Polygon, Shape::Capsule})
+  {
+    const ShapeKey key = shapeKey(shape, kParameters, 100.0f, 50.0f, 0.25f);
+    const ShapeKey same = shapeKey(shape, nearby, 100.4f, 50.1f, 0.25f);
+    SS_CHECK(key == same);
+    SS_CHECK(hash(key) == hash(same));
+  }
+}
+
+SS_TEST(tessellate, keysQuantizeParameters)
+{
+  const ShapeKey rounded = shapeKey(Shape::RoundedRectangle, kParameters, 100.0f, 50.0f, 0.25f);
+  SS_CHECK(rounded.cornerRadius == 250);
+  SS_CHECK(rounded.aspect == 32);
+  SS_CHECK(rounded.innerRadius == 0 && rounded.arcAngle == 0 && rounded.sides == 0);
+
+  ShapeParameters other = kParameters;
+  other.cornerRadius = 0.26f;
+  SS_CHECK(!(shapeKey(Shape::RoundedRectangle, other, 100.0f, 50.0f, 0.25f) == rounded));
+
+  // Square corners don't depend on the aspect
+  other.cornerRadius = 0.0f;
+  const ShapeKey square = shapeKey(Shape::RoundedRectangle, other, 100.0f, 50.0f, 0.25f);
+  SS_CHECK(square == shapeKey(Shape::RoundedRectangle, other, 10.0f, 500.0f, 0.25f));
+  SS_CHECK(square.segments == 0 && square.aspect == 0);
+
+  const ShapeKey ring = shapeKey(Shape::Ring, kParameters, 100.0f, 50.0f, 0.25f);
+  SS_CHECK(ring.innerRadius == 500);
+  SS_CHECK(ring.arcAngle == 3600);
+  SS_CHECK(ring.aspect == 0 && ring.cornerRadius == 0 && ring.sides == 0);
+  SS_CHECK(ring.segments == circleSegments(circleLod(50.0f, 0.25f)));
+
+  // Aspect in 1/32 steps of log2, clamped at 64:1
+  SS_CHECK(shapeKey(Shape::Capsule, kParameters, 50.0f, 100.0f, 0.25f).aspect == -32);
+  SS_CHECK(shapeKey(Shape::Capsule, kParameters, 1.0e4f, 1.0f, 0.25f).aspect == 6 * 32);
+  SS_CHECK(shapeKey(Shape::Capsule, kParameters, 1.0f, 1.0e4f, 0.25f).aspect == -6 * 32);
+
+  // Values outside the attribute ranges are clamped
+  ShapeParameters extreme = {2.0f, -1.0f, 1000.0f, 1000};
+  SS_CHECK(shapeKey(Shape::RoundedRectangle, extreme, 100.0f, 100.0f, 0.25f).cornerRadius == 1000);
+  SS_CHECK(shapeKey(Shape::Ring, extreme, 100.0f, 100.0f, 0.25f).innerRadius == 0);
+  SS_CHECK(shapeKey(Shape::Ring, extreme, 100.0f, 100.0f, 0.25f).arcAngle == 3600);
+  SS_CHECK(shapeKey(Shape::Polygon, extreme, 100.0f, 100.0f, 0.25f).sides == 64);
+  extreme.sides = 1;
+  SS_CHECK(shapeKey(Shape::Polygon, extreme, 100.0f, 100.0f, 0.25f).sides == 3);
+}
+
+SS_TEST(tessellate, segmentsFollowSizeOnScreen)
+{
+  std::uint16_t previous = 0;
+  for (float size = 2.0f; size < 4000.0f; size *= 2.0f)
+  {
+    const ShapeKey key = shapeKey(Shape::Capsule, kParameters, size * 2.0f, size, 0.25f);
+    SS_CHECK(key.segments >= previous);
+    SS_CHECK(key.segments == circleSegments(circleLod(0.5f * size, 0.25f)));
+    previous = key.segments;
+  }
+}
+
+SS_TEST(tessellate, meshesAreUnitSized)
+{
+  for (Shape shape : {Shape::RoundedRectangle, Shape::Ring, Shape::Polygon, Shape::Capsule})
+  {
+    ShapeMesh mesh;
+    tessellate(shapeKey(shape, kParameters, 100.0f, 50.0f, 0.25f), mesh);
+    SS_CHECK(!mesh.indices.empty());
+    SS_CHECK(mesh.indices.size() % 3 == 0);
+    for (unsigned int index : mesh.indices)
+      SS_CHECK(index < mesh.points.size() / 2);
+    for (float coordinate : mesh.points)
+      SS_CHECK(coordinate >= -0.5f - 1e-6f && coordinate <= 0.5f + 1e-6f);
+  }
+}
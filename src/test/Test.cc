@@ -0,0 +1,139 @@
+// Runs the core's tests headless. With an argument, only the tests
+// whose name starts with it are run, so ctest can run one suite at a
+// time.
+//
+//   screenspaceTests [suite]
+
+#include "Test.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace screenspace {
+namespace test {
+
+/// Horizontal field of view of a 35mm lens on Maya's default film back.
+static const float kHorizontalFov = 0.9500215f;
+static const float kNearClipPlane = 0.1f;
+static const float kFarClipPlane = 10000.0f;
+
+/// A registered test.
+struct TestCase {
+  const char* name;
+  void (*run)();
+};
+
+/// Every test, in registration order.
+/// \return The registry.
+static std::vector<TestCase>& registry()
+{
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+/// Failed checks of the running test.
+static std::size_t s_failures = 0;
+
+bool registerTest(const char* name, void (*run)())
+{
+  registry().push_back(TestCase{name, run});
+  return true;
+}
+
+void fail(const char* file, int line, const char* message)
+{
+  std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, message);
+  ++s_failures;
+}
+
+void failNear(const char* file, int line, const char* expression,
+              double actual, double expected)
+{
+  std::fprintf(stderr, "%s:%d: check failed: %s is %.9g, expected %.9g\n",
+               file, line, expression, actual, expected);
+  ++s_failures;
+}
+
+/// Camera looking down -z with the given half extents on each clip
+/// plane.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \param eye Camera position.
+/// \param nearHalfWidth Half the width of the view on the near plane.
+/// \param farHalfWidth Half the width of the view on the far plane.
+/// \return The camera.
+static CameraBasis camera(int width, int height, const Vec3& eye,
+                          float nearHalfWidth, float farHalfWidth)
+{
+  CameraBasis camera;
+  setViewportSize(camera, width, height);
+  camera.nearClipPlane = kNearClipPlane;
+  camera.eye = eye;
+  camera.right = Vec3{1.0f, 0.0f, 0.0f};
+  camera.up = Vec3{0.0f, 1.0f, 0.0f};
+  camera.back = Vec3{0.0f, 0.0f, 1.0f};
+  camera.normal = camera.back;
+
+  const float aspect = float(height) / float(width);
+  camera.nearOrigin = eye + Vec3{-nearHalfWidth, -nearHalfWidth * aspect, -kNearClipPlane};
+  camera.nearX = Vec3{2.0f * nearHalfWidth / width, 0.0f, 0.0f};
+  camera.nearY = Vec3{0.0f, 2.0f * nearHalfWidth * aspect / height, 0.0f};
+  camera.farOrigin = eye + Vec3{-farHalfWidth, -farHalfWidth * aspect, -kFarClipPlane};
+  camera.farX = Vec3{2.0f * farHalfWidth / width, 0.0f, 0.0f};
+  camera.farY = Vec3{0.0f, 2.0f * farHalfWidth * aspect / height, 0.0f};
+  return camera;
+}
+
+CameraBasis perspectiveCamera(int width, int height, const Vec3& eye)
+{
+  const float slope = std::tan(kHorizontalFov / 2.0f);
+  return camera(width, height, eye, kNearClipPlane * slope, kFarClipPlane * slope);
+}
+
+CameraBasis orthographicCamera(int width, int height, const Vec3& eye, float orthoWidth)
+{
+  return camera(width, height, eye, 0.5f * orthoWidth, 0.5f * orthoWidth);
+}
+
+void worldToViewport(const CameraBasis& camera, const Vec3& point, float& x, float& y)
+{
+  // Slide the point onto the near plane along its ray, which is
+  // parallel to the view axis for orthographic cameras and through
+  // the eye for perspective ones.
+  const bool orthographic = length(camera.farX - camera.nearX) < 1e-6f * length(camera.nearX);
+  const Vec3 direction = orthographic ? camera.normal : point - camera.eye;
+  const float scalar = dot(camera.normal, camera.nearOrigin - point) / dot(camera.normal, direction);
+  const Vec3 onNear = point + direction * scalar;
+
+  const Vec3 local = onNear - camera.nearOrigin;
+  x = dot(local, camera.nearX) / dot(camera.nearX, camera.nearX);
+  y = dot(local, camera.nearY) / dot(camera.nearY, camera.nearY);
+}
+
+}
+}
+
+int main(int argc, char** argv)
+{
+  using namespace screenspace::test;
+
+  const char* prefix = argc > 1 ? argv[1] : "";
+  std::size_t run = 0;
+  std::size_t failed = 0;
+  for (const TestCase& test : registry())
+  {
+    if (std::strncmp(test.name, prefix, std::strlen(prefix)) != 0)
+      continue;
+
+    s_failures = 0;
+    test.run();
+    ++run;
+    if (s_failures > 0)
+      ++failed;
+    std::printf("%s %s\n", s_failures > 0 ? "FAIL" : "ok  ", test.name);
+  }
+
+  std::printf("%zu of %zu tests passed\n", run - failed, run);
+  return run > 0 && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+// Copyright 2019 Edward Hoyle
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SCREENSPACE_TEST_TEST_HH
+#define SCREENSPACE_TEST_TEST_HH
+
+#include "ss/core/Camera.hh"
+
+#include <cmath>
+
+namespace screenspace {
+namespace test {
+
+/// Add a test to the registry, done by SS_TEST before main runs.
+/// \param name Suite and test name, "suite.test".
+/// \param run The test body.
+/// \return Always true.
+bool registerTest(const char* name, void (*run)());
+
+/// Report a failed check and fail the running test.
+/// \param file Source file of the check.
+/// \param line Source line of the check.
+/// \param message What was checked.
+void fail(const char* file, int line, const char* message);
+
+/// Report two values further apart than a tolerance.
+/// \param file Source file of the check.
+/// \param line Source line of the check.
+/// \param expression What was checked.
+/// \param actual Value found.
+/// \param expected Value wanted.
+void failNear(const char* file, int line, const char* expression,
+              double actual, double expected);
+
+/// Perspective camera looking down -z, like Maya's default persp
+/// with a 35mm lens.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \param eye Camera position.
+/// \return The camera.
+CameraBasis perspectiveCamera(int width, int height, const Vec3& eye);
+
+/// Orthographic camera looking down -z.
+/// \param width Width of viewport in pixels.
+/// \param height Height of viewport in pixels.
+/// \param eye Camera position.
+/// \param orthoWidth Worldspace width of the view.
+/// \return The camera.
+CameraBasis orthographicCamera(int width, int height, const Vec3& eye, float orthoWidth);
+
+/// Project a worldspace point into a camera's viewport, the inverse
+/// of viewportToWorld for points in front of the camera.
+/// \param camera The camera.
+/// \param point Worldspace point.
+/// \param x Will be set to the horizontal pixel.
+/// \param y Will be set to the vertical pixel.
+void worldToViewport(const CameraBasis& camera, const Vec3& point, float& x, float& y);
+
+}
+}
+
+/// Define and register a test.
+#define SS_TEST(suite, name) \
+  static void suite##_##name(); \
+  static const bool suite##_##name##_registered = \
+      ::screenspace::test::registerTest(#suite "." #name, &suite##_##name); \
+  static void suite##_##name()
+
+/// Fail the running test unless a condition holds. Later checks still
+/// run so every failure is reported.
+#define SS_CHECK(condition) \
+  do { \
+    if (!(condition)) \
+      ::screenspace::test::fail(__FILE__, __LINE__, #condition); \
+  } while (false)
+
+/// Fail the running test unless two values are within a tolerance.
+#define SS_CHECK_NEAR(actual, expected, tolerance) \
+  do { \
+    const double ssActual = double(actual); \
+    const double ssExpected = double(expected); \
+    if (!(std::fabs(ssActual - ssExpected) <= double(tolerance))) \
+      ::screenspace::test::failNear(__FILE__, __LINE__, #actual, ssActual, ssExpected); \
+  } while (false)
+
+#endif // SCREENSPACE_TEST_TEST_HH
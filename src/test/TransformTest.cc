@@ -0,0 +1,58 @@
+#include "Test.hh"
+
+#include "ss/core/Transform.hh"
+
+#include <random>
+#include <vector>
+
+using namespace screenspace;
+using namespace screenspace::test;
+
+SS_TEST(transform, pathsMatchScalar)
+{
+  std::mt19937 generator(6);
+  std::uniform_real_distribution<float> coefficient(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> unit(-0.5f, 0.5f);
+
+  // Every remainder of the four and eight wide loops
+  for (std::size_t count = 0; count < 70; ++count)
+  {
+    Placement placement;
+    for (int i = 0; i < 3; ++i)
+    {
+      placement.origin[i] = coefficient(generator);
+      placement.axisX[i] = coefficient(generator);
+      placement.axisY[i] = coefficient(generator);
+      placement.axisZ[i] = 0.0f;
+    }
+    std::vector<float> x(count), y(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      x[i] = unit(generator);
+      y[i] = unit(generator);
+    }
+
+    // Guard values past the end catch overruns
+    const float kGuard = 12345.0f;
+    std::vector<float> expected(count * 3 + 8, kGuard);
+    transformPoints(TransformPath::Scalar, placement, x.data(), y.data(), count, expected.data());
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      SS_CHECK_NEAR(expected[i * 3], placement.origin[0] + x[i] * placement.axisX[0] + y[i] * placement.axisY[0], 1e-4);
+      SS_CHECK_NEAR(expected[i * 3 + 2], placement.origin[2] + x[i] * placement.axisX[2] + y[i] * placement.axisY[2], 1e-4);
+    }
+
+    for (TransformPath path : {TransformPath::SSE, TransformPath::AVX})
+    {
+      std::vector<float> positions(count * 3 + 8, kGuard);
+      transformPoints(path, placement, x.data(), y.data(), count, positions.data());
+      for (std::size_t i = 0; i < positions.size(); ++i)
+        SS_CHECK_NEAR(positions[i], expected[i], 1e-4);
+    }
+
+    std::vector<float> dispatched(count * 3 + 8, kGuard);
+    transformPoints(placement, x.data(), y.data(), count, dispatched.data());
+    for (std::size_t i = 0; i < dispatched.size(); ++i)
+      SS_CHECK_NEAR(dispatched[i], expected[i], 1e-4);
+  }
+}
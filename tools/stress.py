@@ -0,0 +1,211 @@
+"""Stress scene generator and frame-time recorder for screenspace.
+
+Builds a scene of rigs full of pickables with addPickable, then replays
+camera tumbles and timeline scrubs through Viewport 2.0 with ogsRender,
+recording how long every frame took to a CSV. Per-stage prepare and
+draw times and pickable counts come from screenspaceStats.
+
+Runs under mayapy without a GPU or UI. On Linux, Mesa's software
+renderer can stand in for a GPU:
+
+    LIBGL_ALWAYS_SOFTWARE=1 mayapy tools/stress.py \\
+        --plugin build/plugin/screenspace.so --rigs 20 --pickables 100 \\
+        --output stress.csv
+"""
+
+from __future__ import print_function
+
+import argparse
+import csv
+import json
+import math
+import os
+import random
+import tempfile
+import time
+
+_timer = getattr(time, "perf_counter", time.time)
+
+SHAPES = ("circle", "rectangle", "triangle")
+VERTICAL = ("bottom", "middle", "top")
+PREPARE_STAGES = ("attach", "matrix", "geometry", "vertices")
+HORIZONTAL = ("left", "middle", "right")
+
+
+def parse_args(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--plugin", default="screenspace",
+                        help="Plugin name or path to load")
+    parser.add_argument("--draw-mode", default=None,
+                        choices=("override", "batched", "persistent", "instanced"),
+                        help="screenspaceDrawMode to load the plugin with")
+    parser.add_argument("--rigs", type=int, default=10,
+                        help="Number of rigs")
+    parser.add_argument("--pickables", type=int, default=100,
+                        help="Pickables per rig")
+    parser.add_argument("--cameras", type=int, default=1,
+                        help="Cameras to spread pickables across")
+    parser.add_argument("--frames", type=int, default=120,
+                        help="Frames per scenario")
+    parser.add_argument("--width", type=int, default=1920)
+    parser.add_argument("--height", type=int, default=1080)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--output", default="screenspace_stress.csv",
+                        help="CSV file to write")
+    parser.add_argument("--no-stats", dest="stats", action="store_false",
+                        help="Leave screenspaceStats collection off")
+    return parser.parse_args(argv)
+
+
+def initialize(args):
+    """Start Maya and load the plugin."""
+    import maya.standalone
+    maya.standalone.initialize(name="python")
+
+    from maya import cmds
+    if args.draw_mode:
+        cmds.optionVar(stringValue=("screenspaceDrawMode", args.draw_mode))
+    cmds.loadPlugin(args.plugin, quiet=True)
+    cmds.screenspaceStats(enable=args.stats)
+    if args.draw_mode == "batched" or args.draw_mode == "instanced":
+        cmds.createNode("pickableBatch")
+
+    # Keep rendered images out of the way
+    images = tempfile.mkdtemp(prefix="screenspace_stress_")
+    cmds.workspace(fileRule=("images", images))
+
+
+def build_cameras(count):
+    """Create cameras looking at the origin from around the scene."""
+    from maya import cmds
+    cameras = ["persp"]
+    for index in range(1, count):
+        transform, _ = cmds.camera(name="stressCamera{0}".format(index))
+        angle = 2.0 * math.pi * index / count
+        cmds.xform(transform, worldSpace=True,
+                   translation=(30.0 * math.sin(angle), 15.0, 30.0 * math.cos(angle)))
+        cmds.viewLookAt(transform, position=(0.0, 0.0, 0.0))
+        cameras.append(transform)
+    return cameras
+
+
+def camera_shape(camera):
+    from maya import cmds
+    return cmds.listRelatives(camera, shapes=True, type="camera")[0]
+
+
+def build_rigs(args, cameras, rng):
+    """Create rigs of controls, each with a pickable."""
+    from maya import cmds
+    rigs = []
+    count = 0
+    for rig_index in range(args.rigs):
+        rig = cmds.createNode("transform", name="stressRig{0}".format(rig_index))
+        camera = camera_shape(cameras[rig_index % len(cameras)])
+        for control_index in range(args.pickables):
+            control = cmds.createNode("transform", parent=rig,
+                                      name="stressControl{0}_{1}".format(rig_index, control_index))
+            cmds.addPickable(parent=control,
+                             camera=camera,
+                             shape=rng.choice(SHAPES),
+                             verticalAlign=rng.choice(VERTICAL),
+                             horizontalAlign=rng.choice(HORIZONTAL),
+                             depth=rng.randint(0, 10),
+                             size=rng.uniform(0.5, 2.0),
+                             offset=(rng.uniform(-40.0, 40.0), rng.uniform(-40.0, 40.0)),
+                             color=(rng.random(), rng.random(), rng.random()))
+            count += 1
+
+        # Keys so scrubbing moves every control
+        for frame, value in ((1, 0.0), (args.frames, 10.0)):
+            cmds.setKeyframe(rig, attribute="translateX", time=frame, value=value)
+        rigs.append(rig)
+    return rigs, count
+
+
+def render(camera, args):
+    """Draw one frame through Viewport 2.0 and return the time it took."""
+    from maya import cmds
+    start = _timer()
+    cmds.ogsRender(camera=camera, width=args.width, height=args.height, currentFrame=True)
+    return (_timer() - start) * 1000.0
+
+
+def frame_stats():
+    """Collect and clear screenspaceStats for the frame just drawn.
+
+    Returns prepare and draw time in milliseconds and the drawn, culled,
+    cache-hit and detached pickable counts summed over cameras. Pickables
+    attached to another camera are detached, not culled.
+    """
+    from maya import cmds
+    stats = json.loads(cmds.screenspaceStats(query=True))
+    cmds.screenspaceStats(reset=True)
+
+    stages = stats["stages"]
+    prepare = sum(stages[name]["totalUs"] for name in PREPARE_STAGES) / 1000.0
+    draw = stages["draw"]["totalUs"] / 1000.0
+    counts = [sum(camera[key] for camera in stats["cameras"])
+              for key in ("drawn", "culled", "cacheHits", "detached")]
+    return [prepare, draw] + counts
+
+
+def tumble(args, cameras):
+    """Orbit every camera around the origin, one step per frame."""
+    from maya import cmds
+    cmds.currentTime(1)
+    for frame in range(args.frames):
+        for camera in cameras:
+            cmds.rotate(0.0, 360.0 / args.frames, 0.0, camera,
+                        relative=True, pivot=(0.0, 0.0, 0.0), worldSpace=True)
+            yield frame, camera
+
+
+def scrub(args, cameras):
+    """Step the timeline so every rig moves, drawing each camera."""
+    from maya import cmds
+    for frame in range(args.frames):
+        cmds.currentTime(frame + 1)
+        for camera in cameras:
+            yield frame, camera
+
+
+SCENARIOS = (("tumble", tumble), ("scrub", scrub))
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    initialize(args)
+
+    from maya import cmds
+
+    rng = random.Random(args.seed)
+    cameras = build_cameras(args.cameras)
+    _, count = build_rigs(args, cameras, rng)
+
+    with open(args.output, "w") as stream:
+        writer = csv.writer(stream)
+        header = ["scenario", "frame", "camera", "pickables", "frame_ms"]
+        if args.stats:
+            header += ["prepare_ms", "draw_ms", "drawn", "culled", "cache_hits", "detached"]
+        writer.writerow(header)
+        for name, scenario in SCENARIOS:
+            # Draw once so first-time allocation isn't counted
+            for camera in cameras:
+                render(camera, args)
+            if args.stats:
+                cmds.screenspaceStats(reset=True)
+            for frame, camera in scenario(args, cameras):
+                elapsed = render(camera, args)
+                row = [name, frame, camera, count, "{0:.4f}".format(elapsed)]
+                if args.stats:
+                    prepare, draw, drawn, culled, hits, detached = frame_stats()
+                    row += ["{0:.4f}".format(prepare), "{0:.4f}".format(draw),
+                            drawn, culled, hits, detached]
+                writer.writerow(row)
+
+    print("Wrote {0} ({1} pickables, {2} cameras)".format(args.output, count, len(cameras)))
+
+
+if __name__ == "__main__":
+    main()